@@ -67,6 +67,21 @@ const SoFCInteractiveElement * SoFCInteractiveElement::getInstance(SoState * sta
   return (const SoFCInteractiveElement *) SoElement::getConstElement(state, classStackIndex);
 }
 
+SbBool SoFCInteractiveElement::matches(const SoElement * element) const
+{
+  // the mode is set on the same node at the start and end of an interaction,
+  // so the node id alone doesn't tell whether it has changed
+  return inherited::matches(element) &&
+    ((const SoFCInteractiveElement *) element)->interactiveMode == this->interactiveMode;
+}
+
+SoElement * SoFCInteractiveElement::copyMatchInfo(void) const
+{
+  SoFCInteractiveElement * element = (SoFCInteractiveElement *) inherited::copyMatchInfo();
+  element->interactiveMode = this->interactiveMode;
+  return element;
+}
+
 // ---------------------------------
 
 SO_ELEMENT_SOURCE(SoGLWidgetElement)
@@ -47,6 +47,10 @@ public:
   static SbBool get(SoState * const state);
   static const SoFCInteractiveElement * getInstance(SoState * state);
 
+  // render caches depending on the mode are only invalidated when it changes
+  virtual SbBool matches(const SoElement * element) const;
+  virtual SoElement * copyMatchInfo(void) const;
+
 protected:
   virtual ~SoFCInteractiveElement();
   virtual void setElt(SbBool mode);
@@ -49,6 +49,7 @@
 #endif
 
 #include <XCAFDoc_ShapeMapTool.hxx>
+#include <QtConcurrentMap>
 
 #include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
@@ -158,6 +159,7 @@ ImportOCAF2::ImportOCAF2(Handle(TDocStd_Document) h, App::Document* d, const std
     reduceObjects = hGrp->GetBool("ReduceObjects",true);
     showProgress = hGrp->GetBool("ShowProgress",true);
     expandCompound = hGrp->GetBool("ExpandCompound",true);
+    parallel = hGrp->GetBool("ParallelImport",true);
 
     if(d->isSaved()) {
         Base::FileInfo fi(d->FileName.getValue());
@@ -323,70 +325,81 @@ App::DocumentObject *ImportOCAF2::expandShape(
     return info.obj;
 }
 
-bool ImportOCAF2::createObject(App::Document *doc, TDF_Label label, 
-        const TopoDS_Shape &shape, Info &info, bool newDoc)
+void ImportOCAF2::readShapeData(TDF_Label label, const TopoDS_Shape &shape, ShapeData &data)
 {
-    if(shape.IsNull() || !TopExp_Explorer(shape,TopAbs_VERTEX).More()) {
-        FC_WARN(labelName(label) << " has empty shape");
-        return false;
+    data.label = label;
+    data.shape = shape;
+    getColor(shape,data.info);
+
+    TDF_LabelSequence seq;
+    if(label.IsNull() || !aShapeTool->GetSubShapes(label,seq))
+        return;
+
+    data.hasSubShapes = true;
+    for(int i=1;i<=seq.Length();++i) {
+        TDF_Label l = seq.Value(i);
+        ShapeData::SubShape sub;
+        sub.shape = aShapeTool->GetShape(l);
+        if(sub.shape.IsNull())
+            continue;
+        Quantity_Color aColor;
+        if(aColorTool->GetColor(l, XCAFDoc_ColorSurf, aColor) ||
+           aColorTool->GetColor(l, XCAFDoc_ColorGen, aColor))
+        {
+            sub.faceColor = App::Color(aColor.Red(),aColor.Green(),aColor.Blue());
+            sub.hasFaceColor = true;
+        }
+        if(aColorTool->GetColor(l, XCAFDoc_ColorCurv, aColor)) {
+            sub.edgeColor = App::Color(aColor.Red(),aColor.Green(),aColor.Blue());
+            sub.hasEdgeColor = true;
+        }
+        data.subShapes.push_back(sub);
     }
+}
 
-    getColor(shape,info);
-    bool hasFaceColors = false;
-    bool hasEdgeColors = false;
+void ImportOCAF2::prepareShape(ShapeData &data, bool expandCompound)
+{
+    const TopoDS_Shape &shape = data.shape;
+    if(shape.IsNull() || !TopExp_Explorer(shape,TopAbs_VERTEX).More())
+        return;
+    data.valid = true;
 
     Part::TopoShape tshape(shape);
-    std::vector<App::Color> faceColors;
-    std::vector<App::Color> edgeColors;
-
-    TDF_LabelSequence seq;
-    if(!label.IsNull() && aShapeTool->GetSubShapes(label,seq)) {
+    Info &info = data.info;
 
+    if(data.hasSubShapes) {
         TopTools_IndexedMapOfShape faceMap,edgeMap;
         TopExp::MapShapes(tshape.getShape(), TopAbs_FACE, faceMap);
         TopExp::MapShapes(tshape.getShape(), TopAbs_EDGE, edgeMap);
 
-        faceColors.assign(faceMap.Extent(),info.faceColor);
-        edgeColors.assign(edgeMap.Extent(),info.edgeColor);
+        data.faceColors.assign(faceMap.Extent(),info.faceColor);
+        data.edgeColors.assign(edgeMap.Extent(),info.edgeColor);
         // Two passes to get sub shape colors. First pass, look for solid, and
         // second pass look for face and edges. This allows lower level
         // subshape to override color of higher level ones.
         for(int j=0;j<2;++j) {
-            for(int i=1;i<=seq.Length();++i) {
-                TDF_Label l = seq.Value(i);
-                TopoDS_Shape subShape = aShapeTool->GetShape(l);
-                if(subShape.IsNull())
-                    continue;
+            for(auto &sub : data.subShapes) {
+                const TopoDS_Shape &subShape = sub.shape;
                 if(subShape.ShapeType()==TopAbs_FACE || subShape.ShapeType()==TopAbs_EDGE) {
                     if(j==0)
                         continue;
                 }else if(j!=0)
                     continue;
 
-                bool foundFaceColor=false,foundEdgeColor=false;
-                App::Color faceColor,edgeColor;
-                Quantity_Color aColor;
-                if(aColorTool->GetColor(l, XCAFDoc_ColorSurf, aColor) ||
-                   aColorTool->GetColor(l, XCAFDoc_ColorGen, aColor))
-                {
-                    faceColor = App::Color(aColor.Red(),aColor.Green(),aColor.Blue());
-                    foundFaceColor = true;
-                }
-                if(aColorTool->GetColor(l, XCAFDoc_ColorCurv, aColor)) {
-                    edgeColor = App::Color(aColor.Red(),aColor.Green(),aColor.Blue());
-                    foundEdgeColor = true;
-                    if(j==0 && foundFaceColor && faceColors.size() && edgeColor==faceColor) {
-                        // Do not set edge the same color as face
-                        foundEdgeColor = false;
-                    }
+                bool foundFaceColor = sub.hasFaceColor;
+                bool foundEdgeColor = sub.hasEdgeColor;
+                if(j==0 && foundFaceColor && foundEdgeColor
+                        && data.faceColors.size() && sub.edgeColor==sub.faceColor) {
+                    // Do not set edge the same color as face
+                    foundEdgeColor = false;
                 }
 
                 if(foundFaceColor) {
                     for(TopExp_Explorer exp(subShape,TopAbs_FACE);exp.More();exp.Next()) {
                         int idx = faceMap.FindIndex(exp.Current())-1;
-                        if(idx>=0 && idx<(int)faceColors.size()) {
-                            faceColors[idx] = faceColor;
-                            hasFaceColors = true;
+                        if(idx>=0 && idx<(int)data.faceColors.size()) {
+                            data.faceColors[idx] = sub.faceColor;
+                            data.hasFaceColors = true;
                             info.hasFaceColor = true;
                         }else
                             assert(0);
@@ -395,9 +408,9 @@ bool ImportOCAF2::createObject(App::Document *doc, TDF_Label label,
                 if(foundEdgeColor) {
                     for(TopExp_Explorer exp(subShape,TopAbs_EDGE);exp.More();exp.Next()) {
                         int idx = edgeMap.FindIndex(exp.Current())-1;
-                        if(idx>=0 && idx<(int)edgeColors.size()) {
-                            edgeColors[idx] = edgeColor;
-                            hasEdgeColors = true;
+                        if(idx>=0 && idx<(int)data.edgeColors.size()) {
+                            data.edgeColors[idx] = sub.edgeColor;
+                            data.hasEdgeColors = true;
                             info.hasEdgeColor = true;
                         }
                     }
@@ -406,28 +419,156 @@ bool ImportOCAF2::createObject(App::Document *doc, TDF_Label label,
         }
     }
 
+    data.expand = expandCompound && 
+       (tshape.countSubShapes(TopAbs_SOLID)>1 || 
+        (!tshape.countSubShapes(TopAbs_SOLID) && tshape.countSubShapes(TopAbs_SHELL)>1));
+    if(!data.expand)
+        data.typeName = tshape.shapeName();
+}
+
+void ImportOCAF2::addShapeData(TDF_Label label, const TopoDS_Shape &shape,
+                               std::vector<ShapeData*> &pending)
+{
+    auto res = myShapeData.emplace(shape, ShapeData());
+    if(!res.second)
+        return;
+    readShapeData(label, shape, res.first->second);
+    pending.push_back(&res.first->second);
+}
+
+void ImportOCAF2::collectShape(const TopoDS_Shape &shape, std::vector<ShapeData*> &pending,
+                               std::unordered_map<TopoDS_Shape, bool, ShapeHasher> &visited)
+{
+    // Follows the traversal of loadShape() and createAssembly()
+    if(shape.IsNull())
+        return;
+    auto baseShape = shape.Located(TopLoc_Location());
+    if(!visited.emplace(baseShape,true).second)
+        return;
+    auto baseLabel = aShapeTool->FindShape(baseShape);
+    if(baseLabel.IsNull() || !aShapeTool->IsAssembly(baseLabel)) {
+        addShapeData(baseLabel, baseShape, pending);
+        return;
+    }
+    for(TopoDS_Iterator it(baseShape,0,0);it.More();it.Next()) {
+        TopoDS_Shape childShape = it.Value();
+        if(childShape.IsNull())
+            continue;
+        TDF_Label childLabel;
+        aShapeTool->Search(childShape,childLabel,Standard_True,Standard_True,Standard_False);
+        if(!childLabel.IsNull() && !importHidden && !aColorTool->IsVisible(childLabel))
+            continue;
+        collectShape(childShape, pending, visited);
+    }
+}
+
+void ImportOCAF2::collectSubShapes(TDF_Label label, const TopoDS_Shape &shape,
+                                   std::vector<ShapeData*> &pending)
+{
+    // Follows the traversal of expandShape()
+    for(TopoDS_Iterator it(shape,0,0);it.More();it.Next()) {
+        TDF_Label childLabel;
+        if(!label.IsNull())
+            aShapeTool->FindSubShape(label,it.Value(),childLabel);
+        if(it.Value().ShapeType() == TopAbs_COMPOUND)
+            collectSubShapes(childLabel, it.Value(), pending);
+        else
+            addShapeData(childLabel, it.Value(), pending);
+    }
+}
+
+void ImportOCAF2::prepareShapes(const TDF_LabelSequence &labels)
+{
+    myShapeData.clear();
+    if(!parallel)
+        return;
+
+    FC_TIME_INIT(t);
+    FC_DURATION_DECL_INIT2(d1,d2);
+
+    std::vector<ShapeData*> pending;
+    std::unordered_map<TopoDS_Shape, bool, ShapeHasher> visited;
+    for (Standard_Integer i=1; i <= labels.Length(); i++ ) {
+        auto label = labels.Value(i);
+        if(!importHidden && !aColorTool->IsVisible(label))
+            continue;
+        collectShape(aShapeTool->GetShape(label), pending, visited);
+    }
+    FC_DURATION_PLUS(d1,t);
+
+    while(pending.size()) {
+        _FC_TIME_INIT(t);
+        bool expand = expandCompound;
+        QtConcurrent::blockingMap(pending, [expand](ShapeData *data) {
+            try {
+                prepareShape(*data, expand);
+            }
+            catch (Standard_Failure &) {
+                // createObject() will do it again and report the error
+                data->failed = true;
+            }
+        });
+        FC_DURATION_PLUS(d2,t);
+
+        // compounds that get expanded create an object per child
+        _FC_TIME_INIT(t);
+        std::vector<ShapeData*> expanded;
+        for(auto data : pending) {
+            if(!data->failed && data->valid && data->expand)
+                collectSubShapes(data->label, data->shape, expanded);
+        }
+        pending.swap(expanded);
+        FC_DURATION_PLUS(d1,t);
+    }
+
+    FC_MSG("prepared shape count " << myShapeData.size());
+    FC_DURATION_LOG(d1,"collect shapes");
+    FC_DURATION_LOG(d2,"prepare shapes");
+}
+
+bool ImportOCAF2::createObject(App::Document *doc, TDF_Label label, 
+        const TopoDS_Shape &shape, Info &info, bool newDoc)
+{
+    // use the data prepared by prepareShapes() if available
+    ShapeData localData;
+    ShapeData *data = &localData;
+    auto it = myShapeData.find(shape);
+    if(it!=myShapeData.end() && it->second.label==label && !it->second.failed)
+        data = &it->second;
+    else {
+        readShapeData(label,shape,localData);
+        prepareShape(localData,expandCompound);
+    }
+
+    if(!data->valid) {
+        FC_WARN(labelName(label) << " has empty shape");
+        return false;
+    }
+
+    info.faceColor = data->info.faceColor;
+    info.edgeColor = data->info.edgeColor;
+    info.hasFaceColor = data->info.hasFaceColor;
+    info.hasEdgeColor = data->info.hasEdgeColor;
+
     Part::Feature *feature;
 
     if(newDoc && (mode==ObjectPerDoc || mode==ObjectPerDir))
         doc = getDocument(doc,label);
 
-    if(expandCompound && 
-       (tshape.countSubShapes(TopAbs_SOLID)>1 || 
-        (!tshape.countSubShapes(TopAbs_SOLID) && tshape.countSubShapes(TopAbs_SHELL)>1)))
-    {
+    if(data->expand) {
         feature = dynamic_cast<Part::Feature*>(expandShape(doc,label,shape));
         assert(feature);
     } else {
-        feature = static_cast<Part::Feature*>(doc->addObject("Part::Feature",tshape.shapeName().c_str()));
+        feature = static_cast<Part::Feature*>(doc->addObject("Part::Feature",data->typeName.c_str()));
         feature->Shape.setValue(shape);
         // feature->Visibility.setValue(false);
     }
     applyFaceColors(feature,{info.faceColor});
     applyEdgeColors(feature,{info.edgeColor});
-    if(hasFaceColors)
-        applyFaceColors(feature,faceColors);
-    if(hasEdgeColors)
-        applyEdgeColors(feature,edgeColors);
+    if(data->hasFaceColors)
+        applyFaceColors(feature,data->faceColors);
+    if(data->hasEdgeColors)
+        applyEdgeColors(feature,data->edgeColors);
 
     info.propPlacement = &feature->Placement;
     info.obj = feature;
@@ -548,6 +689,12 @@ App::DocumentObject* ImportOCAF2::loadShapes()
 
     std::vector<App::DocumentObject*> objs;
     aShapeTool->GetFreeShapes (labels);
+
+    // Do the per shape work in parallel first, the objects are then created
+    // in a serial pass below.
+    prepareShapes(labels);
+
+    FC_TIME_INIT(t);
     boost::dynamic_bitset<> vis;
     int count = 0;
     for (Standard_Integer i=1; i <= labels.Length(); i++ ) {
@@ -575,6 +722,10 @@ App::DocumentObject* ImportOCAF2::loadShapes()
         if(createGroup(pDocument,info,TopoDS_Shape(),objs,vis))
             ret = info.obj;
     }
+    myShapeData.clear();
+    FC_TIME_LOG(t,"create objects");
+
+    _FC_TIME_INIT(t);
     if(ret) {
         // ret->Visibility.setValue(true);
         ret->recomputeFeature(true);
@@ -596,6 +747,7 @@ App::DocumentObject* ImportOCAF2::loadShapes()
         ret = feature;
         ret->recomputeFeature(true);
     }
+    FC_TIME_LOG(t,"recompute");
     sequencer = 0;
     return ret;
 }
@@ -28,6 +28,7 @@
 #include <XCAFDoc_ShapeTool.hxx>
 #include <TopoDS_Shape.hxx>
 #include <TDF_LabelMapHasher.hxx>
+#include <TDF_LabelSequence.hxx>
 #include <climits>
 #include <string>
 #include <set>
@@ -120,6 +121,43 @@ private:
     std::string getLabelName(TDF_Label label);
     App::DocumentObject *expandShape(App::Document *doc, TDF_Label label, const TopoDS_Shape &shape);
 
+    /** Per shape data of a part, collected before creating any object.
+     * The XCAF data (colors of the shape and its sub shape labels) is read
+     * in the main thread, the topology based work is done by prepareShape()
+     * and can run in parallel.
+     */
+    struct ShapeData {
+        TDF_Label label;
+        TopoDS_Shape shape;
+        Info info;
+        struct SubShape {
+            TopoDS_Shape shape;
+            App::Color faceColor;
+            App::Color edgeColor;
+            bool hasFaceColor = false;
+            bool hasEdgeColor = false;
+        };
+        std::vector<SubShape> subShapes;
+        bool hasSubShapes = false;
+        bool failed = false;
+
+        // results of prepareShape()
+        bool valid = false;
+        bool expand = false;
+        std::string typeName;
+        std::vector<App::Color> faceColors;
+        std::vector<App::Color> edgeColors;
+        bool hasFaceColors = false;
+        bool hasEdgeColors = false;
+    };
+    void readShapeData(TDF_Label label, const TopoDS_Shape &shape, ShapeData &data);
+    static void prepareShape(ShapeData &data, bool expandCompound);
+    void prepareShapes(const TDF_LabelSequence &labels);
+    void collectShape(const TopoDS_Shape &shape, std::vector<ShapeData*> &pending,
+            std::unordered_map<TopoDS_Shape, bool, ShapeHasher> &visited);
+    void collectSubShapes(TDF_Label label, const TopoDS_Shape &shape, std::vector<ShapeData*> &pending);
+    void addShapeData(TDF_Label label, const TopoDS_Shape &shape, std::vector<ShapeData*> &pending);
+
     virtual void applyEdgeColors(Part::Feature*, const std::vector<App::Color>&) {}
     virtual void applyFaceColors(Part::Feature*, const std::vector<App::Color>&) {}
     virtual void applyElementColors(App::DocumentObject*, const std::map<std::string,App::Color>&) {}
@@ -153,6 +191,7 @@ private:
     bool reduceObjects;
     bool showProgress;
     bool expandCompound;
+    bool parallel;
 
     int mode;
     std::string filePath;
@@ -160,6 +199,7 @@ private:
     std::unordered_map<TopoDS_Shape, Info, ShapeHasher> myShapes;
     std::unordered_map<TDF_Label, std::string, LabelHasher> myNames;
     std::unordered_map<App::DocumentObject*, App::PropertyPlacement*> myCollapsedObjects;
+    std::unordered_map<TopoDS_Shape, ShapeData, ShapeHasher> myShapeData;
 
     App::Color defaultFaceColor;
     App::Color defaultEdgeColor;
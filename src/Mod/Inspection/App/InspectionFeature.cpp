@@ -22,14 +22,24 @@
 
 
 #include "PreCompiled.h"
+#include <memory>
 #include <numeric>
 #include <gp_Pnt.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <BRepClass3d_SolidClassifier.hxx>
 #include <BRepGProp_Face.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTools.hxx>
+#include <BRepTopAdaptor_FClass2d.hxx>
+#include <BRep_Tool.hxx>
+#include <GeomAPI_ProjectPointOnSurf.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
 #include <TopoDS_Vertex.hxx>
+#include <gp_Pnt2d.hxx>
 
 #include <QEventLoop>
 #include <QFuture>
@@ -52,7 +62,7 @@
 #include <Mod/Mesh/App/Core/Iterator.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Points/App/PointsFeature.h>
-#include <Mod/Points/App/PointsGrid.h>
+#include <Mod/Points/App/PointsKDTree.h>
 #include <Mod/Part/App/PartFeature.h>
 
 #include "InspectionFeature.h"
@@ -406,66 +416,289 @@ float InspectNominalFastMesh::getDistance(const Base::Vector3f& point) const
 InspectNominalPoints::InspectNominalPoints(const Points::PointKernel& Kernel, float /*offset*/)
   : _rKernel(Kernel)
 {
-    int uGridPerAxis = 50; // totally 125.000 grid elements 
-    this->_pGrid = new Points::PointsGrid (Kernel, uGridPerAxis);
+    // the tree adapts to the point density, unlike a grid it always finds the
+    // nearest point even if the grid element of the point is empty
+    this->_pTree = new Points::PointsKDTree(Kernel);
 }
 
 InspectNominalPoints::~InspectNominalPoints()
 {
-    delete this->_pGrid;
+    delete this->_pTree;
 }
 
 float InspectNominalPoints::getDistance(const Base::Vector3f& point) const
 {
-    //TODO: Make faster
-    std::set<unsigned long> indices;
-    unsigned long x,y,z;
-    Base::Vector3d pointd(point.x,point.y,point.z);
-    _pGrid->Position(pointd, x, y, z);
-    _pGrid->GetElements(x,y,z,indices);
+    float fMinDist = FLT_MAX;
+    _pTree->FindNearest(point, fMinDist);
+    return fMinDist;
+}
 
-    double fMinDist=DBL_MAX;
-    for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        Base::Vector3d pt = _rKernel.getPoint(*it);
-        double fDist = Base::Distance(pointd, pt);
-        if (fDist < fMinDist) {
-            fMinDist = fDist;
+// ----------------------------------------------------------------
+
+namespace Inspection {
+    /*
+     * Projects points onto a face and checks whether the result lies inside the face.
+     */
+    struct FaceProjector
+    {
+        FaceProjector(const TopoDS_Face& face)
+            : classifier(face, BRep_Tool::Tolerance(face))
+            , props(face)
+        {
+            Standard_Real u1, u2, v1, v2;
+            BRepTools::UVBounds(face, u1, u2, v1, v2);
+            projector.Init(BRep_Tool::Surface(face), u1, u2, v1, v2);
         }
-    }
 
-    return (float)fMinDist;
+        BRepTopAdaptor_FClass2d classifier;
+        BRepGProp_Face props;
+        GeomAPI_ProjectPointOnSurf projector;
+    };
 }
 
-// ----------------------------------------------------------------
+struct InspectNominalShape::FaceData
+{
+    FaceData(const TopoDS_Face& f) : face(f) {}
+    TopoDS_Face face;
+};
+
+/*
+ * The algorithms used by one thread at a time. They all cache data of the
+ * geometry while computing and thus cannot be shared between threads.
+ */
+struct InspectNominalShape::Context
+{
+    ~Context()
+    {
+        for (std::vector<FaceProjector*>::iterator it = faces.begin(); it != faces.end(); ++it)
+            delete *it;
+    }
 
-InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float /*radius*/)
+    BRepExtrema_DistShapeShape distss;
+    std::vector<FaceProjector*> faces;
+};
+
+InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float offset)
     : _rShape(shape)
     , isSolid(false)
+    , _pMesh(0)
+    , _pGrid(0)
+    , _deflection(0.0f)
 {
-    distss = new BRepExtrema_DistShapeShape();
-    distss->LoadS1(_rShape);
-
     // When having a solid then use its shell because otherwise the distance
     // for inner points will always be zero
     if (!_rShape.IsNull() && _rShape.ShapeType() == TopAbs_SOLID) {
         TopExp_Explorer xp;
         xp.Init(_rShape, TopAbs_SHELL);
         if (xp.More()) {
-           distss->LoadS1(xp.Current());
            isSolid = true;
         }
-
     }
-    //distss->SetDeflection(radius);
+
+    if (!_rShape.IsNull())
+        initTessellation(offset);
+
+    // prepare the algorithms for the current thread
+    releaseContext(acquireContext());
 }
 
 InspectNominalShape::~InspectNominalShape()
 {
-    delete distss;
+    delete _pGrid;
+    delete _pMesh;
+    for (std::vector<FaceData*>::iterator it = _faces.begin(); it != _faces.end(); ++it)
+        delete *it;
+    for (std::vector<Context*>::iterator it = _freeContexts.begin(); it != _freeContexts.end(); ++it)
+        delete *it;
+}
+
+/**
+ * Returns a context that is not in use by another thread. A new one is created
+ * from the shape if all existing ones are in use.
+ */
+InspectNominalShape::Context* InspectNominalShape::acquireContext() const
+{
+    {
+        QMutexLocker locker(&_mutex);
+        if (!_freeContexts.empty()) {
+            Context* context = _freeContexts.back();
+            _freeContexts.pop_back();
+            return context;
+        }
+    }
+
+    std::unique_ptr<Context> context(new Context());
+    if (isSolid) {
+        TopExp_Explorer xp;
+        xp.Init(_rShape, TopAbs_SHELL);
+        context->distss.LoadS1(xp.Current());
+    }
+    else {
+        context->distss.LoadS1(_rShape);
+    }
+    //context->distss.SetDeflection(radius);
+
+    context->faces.reserve(_faces.size());
+    for (std::vector<FaceData*>::const_iterator it = _faces.begin(); it != _faces.end(); ++it)
+        context->faces.push_back(new FaceProjector((*it)->face));
+    return context.release();
+}
+
+void InspectNominalShape::releaseContext(Context* context) const
+{
+    QMutexLocker locker(&_mutex);
+    _freeContexts.push_back(context);
+}
+
+void InspectNominalShape::initTessellation(float offset)
+{
+    // use the same deflection as for the actual shape
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part");
+    float deviation = hGrp->GetFloat("MeshDeviation",0.2);
+
+    Base::BoundBox3d bbox = Part::TopoShape(_rShape).getBoundBox();
+    Standard_Real deflection = (bbox.LengthX() + bbox.LengthY() + bbox.LengthZ())/300.0 * deviation;
+    if (deflection <= 0.0)
+        return;
+
+    BRepMesh_IncrementalMesh(_rShape, deflection);
+
+    // collect the triangles of all faces and remember to which face they belong
+    MeshCore::MeshPointArray points;
+    MeshCore::MeshFacetArray facets;
+    for (TopExp_Explorer xp(_rShape, TopAbs_FACE); xp.More(); xp.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(xp.Current());
+        TopLoc_Location loc;
+        Handle(Poly_Triangulation) poly = BRep_Tool::Triangulation(face, loc);
+        if (poly.IsNull())
+            continue;
+
+        unsigned long faceIndex = _faces.size();
+        _faces.push_back(new FaceData(face));
+
+        gp_Trsf transf = loc.Transformation();
+        unsigned long numPoints = points.size();
+        const TColgp_Array1OfPnt& nodes = poly->Nodes();
+        for (Standard_Integer i = nodes.Lower(); i <= nodes.Upper(); i++) {
+            gp_Pnt p = nodes(i).Transformed(transf);
+            points.push_back(MeshCore::MeshPoint(Base::Vector3f((float)p.X(), (float)p.Y(), (float)p.Z())));
+        }
+
+        const Poly_Array1OfTriangle& triangles = poly->Triangles();
+        for (Standard_Integer i = triangles.Lower(); i <= triangles.Upper(); i++) {
+            Standard_Integer n1, n2, n3;
+            triangles(i).Get(n1, n2, n3);
+            facets.push_back(MeshCore::MeshFacet(numPoints + n1 - nodes.Lower(),
+                                                 numPoints + n2 - nodes.Lower(),
+                                                 numPoints + n3 - nodes.Lower()));
+            _facetToFace.push_back(faceIndex);
+        }
+    }
+
+    if (facets.empty())
+        return;
+
+    _pMesh = new MeshCore::MeshKernel();
+    _pMesh->Adopt(points, facets);
+    _deflection = (float)deflection;
+
+    // Max. limit of grid elements
+    float fMaxGridElements=8000000.0f;
+    Base::BoundBox3f box = _pMesh->GetBoundBox();
+
+    // estimate the minimum allowed grid length
+    float fMinGridLen = (float)pow((box.LengthX()*box.LengthY()*box.LengthZ()/fMaxGridElements), 0.3333f);
+    float fGridLen = 5.0f * MeshCore::MeshAlgorithm(*_pMesh).GetAverageEdgeLength();
+    fGridLen = std::max<float>(fMinGridLen, fGridLen);
+
+    _pGrid = new MeshInspectGrid(*_pMesh, fGridLen, Base::Matrix4D());
+    _box = box;
+    _box.Enlarge(offset);
 }
 
 float InspectNominalShape::getDistance(const Base::Vector3f& point) const
 {
+    Context* context = acquireContext();
+    float fDist;
+    try {
+        // the grid only covers the enlarged bbox, outside of it the exact distance is computed
+        if (!_pGrid || !_box.IsInBox(point) || !getDistanceToFaces(*context, point, fDist))
+            fDist = getExactDistance(*context, point);
+    }
+    catch (...) {
+        releaseContext(context);
+        throw;
+    }
+
+    releaseContext(context);
+    return fDist;
+}
+
+/**
+ * Uses the tessellation to get the faces that may contain the nearest point and
+ * projects the point onto them. Returns false if the exact distance cannot be
+ * determined this way.
+ */
+bool InspectNominalShape::getDistanceToFaces(Context& context, const Base::Vector3f& point, float& distance) const
+{
+    std::set<unsigned long> indices;
+    _pGrid->MeshGrid::SearchNearestFromPoint(point, indices);
+    if (indices.empty())
+        return false;
+
+    std::vector<std::pair<float, unsigned long> > triangles;
+    triangles.reserve(indices.size());
+    float fMinDist = FLT_MAX;
+    for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
+        float fDist = _pMesh->GetFacet(*it).DistanceToPoint(point);
+        triangles.push_back(std::make_pair(fDist, *it));
+        fMinDist = std::min<float>(fMinDist, fDist);
+    }
+
+    // The tessellation deviates from the faces by at most the deflection, so
+    // only faces with a triangle near to the nearest one are of interest
+    std::set<unsigned long> faces;
+    for (std::vector<std::pair<float, unsigned long> >::iterator it = triangles.begin(); it != triangles.end(); ++it) {
+        if (it->first <= fMinDist + 2.0f * _deflection)
+            faces.insert(_facetToFace[it->second]);
+    }
+
+    gp_Pnt pnt3d(point.x,point.y,point.z);
+    Standard_Real minDist = DBL_MAX;
+    bool positive = true;
+    for (std::set<unsigned long>::iterator it = faces.begin(); it != faces.end(); ++it) {
+        FaceProjector* data = context.faces[*it];
+        data->projector.Perform(pnt3d);
+        for (Standard_Integer i = 1; i <= data->projector.NbPoints(); i++) {
+            Standard_Real dist = data->projector.Distance(i);
+            if (dist >= minDist)
+                continue;
+
+            Standard_Real u, v;
+            data->projector.Parameters(i, u, v);
+            if (data->classifier.Perform(gp_Pnt2d(u, v)) == TopAbs_OUT)
+                continue;
+
+            gp_Vec normal;
+            gp_Pnt center;
+            data->props.Normal(u, v, center, normal);
+            minDist = dist;
+            positive = normal.Dot(gp_Vec(center, pnt3d)) >= 0;
+        }
+    }
+
+    // no projection found or the nearest point lies on an edge
+    if (minDist > fMinDist + _deflection)
+        return false;
+
+    distance = positive ? (float)minDist : -(float)minDist;
+    return true;
+}
+
+float InspectNominalShape::getExactDistance(Context& context, const Base::Vector3f& point) const
+{
+    BRepExtrema_DistShapeShape* distss = &context.distss;
     gp_Pnt pnt3d(point.x,point.y,point.z);
     BRepBuilderAPI_MakeVertex mkVert(pnt3d);
     distss->LoadS2(mkVert.Vertex());
@@ -754,7 +987,6 @@ App::DocumentObjectExecReturn* Feature::execute(void)
         actual = new InspectActualPoints(pts->Points.getValue());
     }
     else if (pcActual->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId())) {
-        useMultithreading = false;
         Part::Feature* part = static_cast<Part::Feature*>(pcActual);
         actual = new InspectActualShape(part->Shape.getShape());
     }
@@ -776,7 +1008,6 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             nominal = new InspectNominalPoints(pts->Points.getValue(), this->SearchRadius.getValue());
         }
         else if ((*it)->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId())) {
-            useMultithreading = false;
             Part::Feature* part = static_cast<Part::Feature*>(*it);
             nominal = new InspectNominalShape(part->Shape.getValue(), this->SearchRadius.getValue());
         }
@@ -872,14 +1103,25 @@ App::DocumentObjectExecReturn* Feature::execute(void)
     DistanceInspectionRMS res;
 
     if (useMultithreading) {
-        // Build vector of increasing indices
-        std::vector<unsigned long> index(count);
-        std::iota(index.begin(), index.end(), 0);
-        // Perform map-reduce operation : compute distances and update sum of squares for RMS computation
+        // Distribute the points in chunks to keep the overhead per task low
+        const unsigned long chunkSize = 1024;
+        std::vector<unsigned long> chunks;
+        for (unsigned long first = 0; first < count; first += chunkSize)
+            chunks.push_back(first);
+        std::function<DistanceInspectionRMS(unsigned long)> fMapChunk = [&](unsigned long first)
+        {
+            DistanceInspectionRMS res;
+            unsigned long last = std::min<unsigned long>(first + chunkSize, count);
+            for (unsigned long index = first; index < last; index++)
+                res += fMap(index);
+            return res;
+        };
+        // Perform map-reduce operation : compute distances and update sum of squares for RMS computation.
+        // The chunks are reduced in order so that the result doesn't depend on the scheduling
         QFuture<DistanceInspectionRMS> future = QtConcurrent::mappedReduced(
-            index, fMap, &DistanceInspectionRMS::operator+=);
+            chunks, fMapChunk, &DistanceInspectionRMS::operator+=, QtConcurrent::OrderedReduce);
         // Setup progress bar
-        Base::FutureWatcherProgress progress("Inspecting...", actual->countPoints());
+        Base::FutureWatcherProgress progress("Inspecting...", chunks.size());
         QFutureWatcher<DistanceInspectionRMS> watcher;
         QObject::connect(&watcher, SIGNAL(progressValueChanged(int)),
             &progress, SLOT(progressValueChanged(int)));
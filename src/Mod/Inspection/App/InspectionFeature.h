@@ -24,6 +24,8 @@
 #ifndef INSPECTION_FEATURE_H
 #define INSPECTION_FEATURE_H
 
+#include <QMutex>
+
 #include <App/DocumentObject.h>
 #include <App/PropertyLinks.h>
 #include <App/DocumentObjectGroup.h>
@@ -40,7 +42,7 @@ class MeshGrid;
 }
 
 namespace Mesh   { class MeshObject; }
-namespace Points { class PointsGrid; }
+namespace Points { class PointsKDTree; }
 namespace Part   { class TopoShape;  }
 
 namespace Inspection
@@ -143,9 +145,15 @@ public:
 
 private:
     const Points::PointKernel& _rKernel;
-    Points::PointsGrid* _pGrid;
+    Points::PointsKDTree* _pTree;
 };
 
+/** The shape is tessellated once to find the faces near to a point quickly. Only
+ * these faces are then used to compute the exact distance. If this fails, e.g.
+ * because the nearest point is on an edge, the distance to the whole shape is computed.
+ * The OCC algorithms keep state while computing, so each thread that calls
+ * getDistance() gets its own copy of them.
+ */
 class InspectionExport InspectNominalShape : public InspectNominalGeometry
 {
 public:
@@ -154,9 +162,28 @@ public:
     virtual float getDistance(const Base::Vector3f&) const;
 
 private:
-    BRepExtrema_DistShapeShape* distss;
+    struct FaceData;
+    struct Context;
+
+    void initTessellation(float offset);
+    Context* acquireContext() const;
+    void releaseContext(Context*) const;
+    bool getDistanceToFaces(Context&, const Base::Vector3f&, float&) const;
+    float getExactDistance(Context&, const Base::Vector3f&) const;
+
+private:
     const TopoDS_Shape& _rShape;
     bool isSolid;
+
+    MeshCore::MeshKernel* _pMesh;
+    MeshCore::MeshGrid* _pGrid;
+    Base::BoundBox3f _box;
+    float _deflection;
+    std::vector<unsigned long> _facetToFace;
+    std::vector<FaceData*> _faces;
+
+    mutable QMutex _mutex;
+    mutable std::vector<Context*> _freeContexts;
 };
 
 class InspectionExport PropertyDistanceList: public App::PropertyLists
@@ -23,6 +23,10 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
+# include <exception>
+# include <iterator>
+# include <BRep_Builder.hxx>
 # include <BRepAdaptor_Surface.hxx>
 # include <BRepAlgoAPI_Common.hxx>
 # include <BRepAlgoAPI_Cut.hxx>
@@ -40,11 +44,18 @@
 # include <TopTools_IndexedMapOfShape.hxx>
 # include <TopTools_HSequenceOfShape.hxx>
 # include <TopoDS.hxx>
+# include <TopoDS_Compound.hxx>
 # include <TopoDS_Edge.hxx>
 # include <TopoDS_Wire.hxx>
+# include <TopTools_ListOfShape.hxx>
 #endif
 
+#include <QtConcurrentMap>
+
 #include "CrossSection.h"
+#include "TopoShape.h"
+#include "TopoShapeCache.h"
+#include "Tools.h"
 
 using namespace Part;
 
@@ -54,28 +65,145 @@ CrossSection::CrossSection(double a, double b, double c, const TopoDS_Shape& s)
 {
 }
 
+CrossSection::CrossSection(double a, double b, double c, const TopoShape& s)
+  : a(a), b(b), c(c), s(s.getShape()), cache(s.getCache())
+{
+}
+
 std::list<TopoDS_Wire> CrossSection::slice(double d) const
 {
-    std::list<TopoDS_Wire> wires;
+    return slice(std::vector<double>(1, d)).front();
+}
+
+std::vector< std::list<TopoDS_Wire> > CrossSection::slice(const std::vector<double>& d) const
+{
+    std::vector< std::list<TopoDS_Wire> > result(d.size());
+    if (d.empty() || s.IsNull())
+        return result;
+
+    std::shared_ptr<TopoShapeCache> shapeCache = cache;
+    if (!shapeCache || !shapeCache->isValidFor(s))
+        shapeCache = std::make_shared<TopoShapeCache>(s);
+
+    std::vector<SliceItem> items;
+    getSliceItems(*shapeCache, items);
+
+#if OCC_VERSION_HEX >= 0x070000
+    // The boolean operations below run non-destructive, so the planes can be
+    // sliced concurrently on the same input shape. QtConcurrent only passes
+    // on QException, so the first failure is kept and re-thrown here.
+    std::vector<std::size_t> planes(d.size());
+    for (std::size_t i=0; i<planes.size(); ++i)
+        planes[i] = i;
+    std::vector<std::exception_ptr> errors(d.size());
+    QtConcurrent::blockingMap(planes, [&](std::size_t i) {
+        try {
+            sliceItems(d[i], *shapeCache, items, result[i]);
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    });
+    for (const std::exception_ptr& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+#else
+    for (std::size_t i=0; i<d.size(); ++i)
+        sliceItems(d[i], *shapeCache, items, result[i]);
+#endif
+    return result;
+}
+
+void CrossSection::getSliceItems(const TopoShapeCache& shapeCache, std::vector<SliceItem>& items) const
+{
+    const TopTools_IndexedMapOfShape& faceMap = shapeCache.getSubShapeMap(TopAbs_FACE);
+    auto addItem = [&](const TopoDS_Shape& shape, TopAbs_ShapeEnum type) {
+        SliceItem item;
+        item.shape = shape;
+        item.solid = (type == TopAbs_SOLID);
+        int index = shapeCache.getSubShapeMap(type).FindIndex(shape);
+        if (index > 0)
+            item.box = shapeCache.getSubShapeBoundBox(type, index);
+
+        // faces without a box are never found by a query, so don't prune then
+        TopTools_IndexedMapOfShape faces;
+        TopExp::MapShapes(shape, TopAbs_FACE, faces);
+        for (int i=1; i<=faces.Extent(); i++) {
+            int face = faceMap.FindIndex(faces(i));
+            if (face <= 0 || shapeCache.getSubShapeBoundBox(TopAbs_FACE, face).IsVoid()) {
+                item.faces.clear();
+                break;
+            }
+            item.faces.push_back(face);
+        }
+        std::sort(item.faces.begin(), item.faces.end());
+        items.push_back(item);
+    };
+
     // Fixes: 0001228: Cross section of Torus in Part Workbench fails or give wrong results
     // Fixes: 0001137: Incomplete slices when using Part.slice on a torus
     TopExp_Explorer xp;
     for (xp.Init(s, TopAbs_SOLID); xp.More(); xp.Next()) {
-        sliceSolid(d, xp.Current(), wires);
+        addItem(xp.Current(), TopAbs_SOLID);
     }
     for (xp.Init(s, TopAbs_SHELL, TopAbs_SOLID); xp.More(); xp.Next()) {
-        sliceNonSolid(d, xp.Current(), wires);
+        addItem(xp.Current(), TopAbs_SHELL);
     }
     for (xp.Init(s, TopAbs_FACE, TopAbs_SHELL); xp.More(); xp.Next()) {
-        sliceNonSolid(d, xp.Current(), wires);
+        addItem(xp.Current(), TopAbs_FACE);
     }
+}
+
+void CrossSection::sliceItems(double d, const TopoShapeCache& shapeCache, const std::vector<SliceItem>& items,
+                              std::list<TopoDS_Wire>& wires) const
+{
+    gp_Pln slicePlane(a,b,c,-d);
+    std::vector<int> crossing = shapeCache.findSubShapes(TopAbs_FACE, slicePlane);
+    std::vector<int> candidates;
+    for (const SliceItem& item : items) {
+        // A void box means it could not be computed, e.g. for infinite shapes.
+        // The boxes include the tolerance, so touching shapes aren't skipped.
+        if (!item.box.IsVoid() && item.box.IsOut(slicePlane))
+            continue;
 
-    return wires;
+        if (!item.faces.empty()) {
+            candidates.clear();
+            std::set_intersection(item.faces.begin(), item.faces.end(),
+                                  crossing.begin(), crossing.end(),
+                                  std::back_inserter(candidates));
+            // the plane can't cut the shape without crossing one of its faces
+            if (candidates.empty())
+                continue;
+            // Only section the crossed faces. For a solid this gives the same
+            // wires as the cut below, which is kept if all faces are involved.
+            if (candidates.size() < item.faces.size()) {
+                BRep_Builder builder;
+                TopoDS_Compound comp;
+                builder.MakeCompound(comp);
+                for (int face : candidates)
+                    builder.Add(comp, shapeCache.getSubShape(TopAbs_FACE, face));
+                sliceNonSolid(d, comp, wires);
+                continue;
+            }
+        }
+
+        if (item.solid)
+            sliceSolid(d, item.shape, wires);
+        else
+            sliceNonSolid(d, item.shape, wires);
+    }
 }
 
 void CrossSection::sliceNonSolid(double d, const TopoDS_Shape& shape, std::list<TopoDS_Wire>& wires) const
 {
+#if OCC_VERSION_HEX >= 0x070000
+    BRepAlgoAPI_Section cs(shape, gp_Pln(a,b,c,-d), Standard_False);
+    cs.SetNonDestructive(Standard_True);
+    cs.Build();
+#else
     BRepAlgoAPI_Section cs(shape, gp_Pln(a,b,c,-d));
+#endif
     if (cs.IsDone()) {
         std::list<TopoDS_Edge> edges;
         TopExp_Explorer xp;
@@ -113,7 +241,18 @@ void CrossSection::sliceSolid(double d, const TopoDS_Shape& shape, std::list<Top
 
     BRepPrimAPI_MakeHalfSpace mkSolid(face, refPoint);
     TopoDS_Solid solid = mkSolid.Solid();
+#if OCC_VERSION_HEX >= 0x070000
+    BRepAlgoAPI_Cut mkCut;
+    TopTools_ListOfShape args, tools;
+    args.Append(shape);
+    tools.Append(solid);
+    mkCut.SetArguments(args);
+    mkCut.SetTools(tools);
+    mkCut.SetNonDestructive(Standard_True);
+    mkCut.Build();
+#else
     BRepAlgoAPI_Cut mkCut(shape, solid);
+#endif
 
     if (mkCut.IsDone()) {
         TopTools_IndexedMapOfShape mapOfFaces;
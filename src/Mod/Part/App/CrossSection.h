@@ -25,20 +25,50 @@
 #define PART_CROSSSECTION_H
 
 #include <list>
+#include <memory>
+#include <vector>
+#include <Bnd_Box.hxx>
+#include <TopoDS_Shape.hxx>
 #include <TopTools_IndexedMapOfShape.hxx>
 
-class TopoDS_Shape;
 class TopoDS_Wire;
 
 namespace Part {
 
+class TopoShape;
+class TopoShapeCache;
+
 class PartExport CrossSection
 {
 public:
     CrossSection(double a, double b, double c, const TopoDS_Shape& s);
+    /// Uses the cached sub-shape boxes of the given shape, see TopoShape::getCache()
+    CrossSection(double a, double b, double c, const TopoShape& s);
     std::list<TopoDS_Wire> slice(double d) const;
+    /** Slices the shape with several parallel planes
+     *
+     * Solids, free shells and free faces whose bounding box does not cross
+     * a plane are skipped for that plane. Of the others only the faces whose
+     * bounding box crosses the plane are sliced, unless all faces of a solid
+     * do. The planes are sliced concurrently.
+     *
+     * @param d: list of plane offsets along the plane normal
+     * @return One list of wires per entry of d, in the same order
+     */
+    std::vector< std::list<TopoDS_Wire> > slice(const std::vector<double>& d) const;
 
 private:
+    struct SliceItem {
+        TopoDS_Shape shape;
+        Bnd_Box box;
+        bool solid;
+        // sorted indices of the faces of the shape in the cache, empty if
+        // they can't be pruned, e.g. because of an infinite face
+        std::vector<int> faces;
+    };
+    void getSliceItems(const TopoShapeCache& shapeCache, std::vector<SliceItem>& items) const;
+    void sliceItems(double d, const TopoShapeCache& shapeCache, const std::vector<SliceItem>& items,
+                    std::list<TopoDS_Wire>& wires) const;
     void sliceNonSolid(double d, const TopoDS_Shape&, std::list<TopoDS_Wire>& wires) const;
     void sliceSolid(double d, const TopoDS_Shape&, std::list<TopoDS_Wire>& wires) const;
     void connectEdges (const std::list<TopoDS_Edge>& edges, std::list<TopoDS_Wire>& wires) const;
@@ -47,6 +77,7 @@ private:
 private:
     double a,b,c;
     const TopoDS_Shape& s;
+    std::shared_ptr<TopoShapeCache> cache;
 };
 
 }
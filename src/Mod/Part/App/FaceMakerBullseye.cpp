@@ -54,6 +54,7 @@
 #include "FaceMakerCheese.h"
 
 #include "TopoShape.h"
+#include "TopoShapeCache.h"
 
 
 
@@ -106,15 +107,28 @@ void FaceMakerBullseye::Build_Essence()
         plane = GeomAdaptor_Surface(planeFinder.Surface()).Plane();
     }
 
-    //sort wires by length of diagonal of bounding box.
-    std::vector<TopoDS_Wire> wires = this->myWires;
-    std::stable_sort(wires.begin(), wires.end(), FaceMakerCheese::Wire_Compare());
+    //sort wires by length of diagonal of bounding box. The boxes are taken
+    //from the shape cache, so that each one is computed only once and can
+    //be reused for the hit test below.
+    std::vector<TopoShape> wires(this->myWires.begin(), this->myWires.end());
+    std::vector<std::pair<double, int> > order;
+    order.reserve(wires.size());
+    for(std::size_t i=0; i<wires.size(); ++i) {
+        auto cache = wires[i].getCache();
+        const Bnd_Box &box = cache->getBoundBox();
+        order.emplace_back(box.IsVoid() ? 0.0 : box.SquareExtent(), static_cast<int>(i));
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [](const std::pair<double, int> &a, const std::pair<double, int> &b) {
+            return a.first < b.first;
+        });
 
     //add wires one by one to current set of faces.
     //We go from last to first, to make it so that outer wires come before inner wires.
     std::vector< std::unique_ptr<FaceDriller> > faces;
-    for (int i = static_cast<int>(wires.size())-1; i >= 0; --i) {
-        TopoDS_Wire &w = wires[i];
+    for (int i = static_cast<int>(order.size())-1; i >= 0; --i) {
+        const TopoShape &shape = wires[order[i].second];
+        TopoDS_Wire w = TopoDS::Wire(shape.getShape());
 
         //test if this wire is on any of existing faces (if yes, it's a hole;
         // if no, it's a beginning of a new face).
@@ -134,7 +148,7 @@ void FaceMakerBullseye::Build_Essence()
         } else {
             //wire is not on a face. Start a new face.
             faces.push_back(std::unique_ptr<FaceDriller>(
-                                new FaceDriller(plane, w)
+                                new FaceDriller(plane, w, shape.getCache()->getBoundBox())
                            ));
         }
     }
@@ -146,10 +160,13 @@ void FaceMakerBullseye::Build_Essence()
 }
 
 
-FaceMakerBullseye::FaceDriller::FaceDriller(const gp_Pln& plane, TopoDS_Wire outerWire)
+FaceMakerBullseye::FaceDriller::FaceDriller(const gp_Pln& plane, TopoDS_Wire outerWire, const Bnd_Box &outerBox)
 {
     this->myPlane = plane;
     this->myFace = TopoDS_Face();
+    this->myBox = outerBox;
+    if (!myBox.IsVoid())
+        myBox.Enlarge(Precision::Confusion());
 
     //Ensure correct orientation of the wire.
     if (getWireDirection(myPlane, outerWire) < 0)
@@ -163,6 +180,10 @@ FaceMakerBullseye::FaceDriller::FaceDriller(const gp_Pln& plane, TopoDS_Wire out
 
 bool FaceMakerBullseye::FaceDriller::hitTest(const gp_Pnt& point) const
 {
+    //a point outside of the outer wire's box can't be on the face
+    if (!myBox.IsVoid() && myBox.IsOut(point))
+        return false;
+
     double u,v;
     GeomAPI_ProjectPointOnSurf(point, myHPlane).LowerDistanceParameters(u,v);
     BRepClass_FaceClassifier cl(myFace, gp_Pnt2d(u,v), Precision::Confusion());
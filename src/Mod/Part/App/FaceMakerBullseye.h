@@ -26,6 +26,7 @@
 #include "FaceMaker.h"
 #include <list>
 
+#include <Bnd_Box.hxx>
 #include <Geom_Surface.hxx>
 #include <gp_Pln.hxx>
 
@@ -74,7 +75,13 @@ protected:
     class FaceDriller
     {
     public:
-        FaceDriller(const gp_Pln& plane, TopoDS_Wire outerWire);
+        /**
+         * @param plane
+         * @param outerWire
+         * @param outerBox: bounding box of outerWire. Optional, it is used
+         * to quickly reject points in hitTest.
+         */
+        FaceDriller(const gp_Pln& plane, TopoDS_Wire outerWire, const Bnd_Box &outerBox = Bnd_Box());
 
         /**
          * @brief hitTest: returns True if point is on the face
@@ -97,6 +104,7 @@ protected:
         gp_Pln myPlane;
         TopoDS_Face myFace;
         Handle(Geom_Surface) myHPlane;
+        Bnd_Box myBox;
     };
 };
 
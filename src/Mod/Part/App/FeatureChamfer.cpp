@@ -52,6 +52,8 @@ App::DocumentObjectExecReturn *Chamfer::execute(void)
     App::DocumentObject* link = Base.getValue();
     if (!link)
         return new App::DocumentObjectExecReturn("No object linked");
+    if (restoreCachedResult())
+        return App::DocumentObject::StdReturn;
 
     try {
         auto baseShape = Feature::getShape(link);
@@ -95,6 +97,7 @@ App::DocumentObjectExecReturn *Chamfer::execute(void)
         prop.setContainer(this);
         prop.touch();
 
+        cacheResult(std::vector<ShapeHistory>(1, history));
         return App::DocumentObject::StdReturn;
     }
     catch (Standard_Failure& e) {
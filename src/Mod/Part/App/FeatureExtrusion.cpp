@@ -320,11 +320,14 @@ App::DocumentObjectExecReturn *Extrusion::execute(void)
     App::DocumentObject* link = Base.getValue();
     if (!link)
         return new App::DocumentObjectExecReturn("No object linked");
+    if (restoreCachedResult())
+        return App::DocumentObject::StdReturn;
 
     try {
         Extrusion::ExtrusionParameters params = computeFinalParameters();
         TopoShape result = extrudeShape(Feature::getShape(link),params);
         this->Shape.setValue(result);
+        cacheResult();
         return App::DocumentObject::StdReturn;
     }
     catch (Standard_Failure& e) {
@@ -79,6 +79,9 @@ App::DocumentObjectExecReturn *Boolean::execute(void)
         if (!base || !tool)
             return new App::DocumentObjectExecReturn("Linked object is not a Part object");
 
+        if (restoreCachedResult())
+            return App::DocumentObject::StdReturn;
+
         // Now, let's get the TopoDS_Shape
         TopoDS_Shape BaseShape = Feature::getShape(base);
         if (BaseShape.IsNull())
@@ -133,6 +136,7 @@ App::DocumentObjectExecReturn *Boolean::execute(void)
 
         this->Shape.setValue(resShape);
         this->History.setValues(history);
+        cacheResult();
         return App::DocumentObject::StdReturn;
     }
     catch (...) {
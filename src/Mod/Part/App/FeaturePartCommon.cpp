@@ -29,6 +29,7 @@
 # include <Standard_Failure.hxx>
 # include <TopoDS_Iterator.hxx>
 # include <TopTools_IndexedMapOfShape.hxx>
+# include <TopTools_ListOfShape.hxx>
 # include <TopExp.hxx>
 #endif
 
@@ -121,7 +122,19 @@ App::DocumentObjectExecReturn *MultiCommon::execute(void)
                     throw Base::RuntimeError("Input shape is null");
 
                 // Let's call algorithm computing a fuse operation:
+#if OCC_VERSION_HEX >= 0x070000
+                // let OCC intersect the faces of both shapes on all cores
+                BRepAlgoAPI_Common mkCommon;
+                TopTools_ListOfShape shapeArguments,shapeTools;
+                shapeArguments.Append(resShape);
+                shapeTools.Append(*it);
+                mkCommon.SetArguments(shapeArguments);
+                mkCommon.SetTools(shapeTools);
+                mkCommon.SetRunParallel(Standard_True);
+                mkCommon.Build();
+#else
                 BRepAlgoAPI_Common mkCommon(resShape, *it);
+#endif
                 // Let's check if the fusion has been successful
                 if (!mkCommon.IsDone()) 
                     throw BooleanException("Intersection failed");
@@ -23,17 +23,23 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <exception>
+# include <memory>
+# include <BRep_Builder.hxx>
 # include <BRepAlgoAPI_Fuse.hxx>
 # include <BRepCheck_Analyzer.hxx>
 # include <Standard_Failure.hxx>
+# include <TopoDS_Compound.hxx>
 # include <TopoDS_Iterator.hxx>
 # include <TopTools_IndexedMapOfShape.hxx>
 # include <TopExp.hxx>
 #endif
 
+#include <QtConcurrentMap>
 
 #include "FeaturePartFuse.h"
 #include "modelRefine.h"
+#include "Tools.h"
 #include <App/Application.h>
 #include <Base/Parameter.h>
 #include <Base/Exception.h>
@@ -82,6 +88,23 @@ short MultiFuse::mustExecute() const
     return 0;
 }
 
+/// Maps the faces of a shape to their indices in the faces of the result
+static ShapeHistory mapHistory(const TopoDS_Shape& shape, const TopTools_IndexedMapOfShape& resultFaces)
+{
+    ShapeHistory history;
+    history.type = TopAbs_FACE;
+
+    TopTools_IndexedMapOfShape faces;
+    TopExp::MapShapes(shape, TopAbs_FACE, faces);
+    for (int i=1; i<=faces.Extent(); i++) {
+        ShapeHistory::List &list = history.shapeMap[i-1];
+        int index = resultFaces.FindIndex(faces(i));
+        if (index > 0)
+            list.push_back(index-1);
+    }
+    return history;
+}
+
 App::DocumentObjectExecReturn *MultiFuse::execute(void)
 {
     std::vector<TopoDS_Shape> s;
@@ -140,28 +163,106 @@ App::DocumentObjectExecReturn *MultiFuse::execute(void)
                 }
             }
 #else
-            BRepAlgoAPI_Fuse mkFuse;
-            TopTools_ListOfShape shapeArguments,shapeTools;
-            const TopoDS_Shape& shape = s.front();
-            if (shape.IsNull())
-                throw Base::RuntimeError("Input shape is null");
-            shapeArguments.Append(shape);
-
-            for (std::vector<TopoDS_Shape>::iterator it = s.begin()+1; it != s.end(); ++it) {
+            for (std::vector<TopoDS_Shape>::iterator it = s.begin(); it != s.end(); ++it) {
                 if (it->IsNull())
                     throw Base::RuntimeError("Input shape is null");
-                shapeTools.Append(*it);
             }
 
-            mkFuse.SetArguments(shapeArguments);
-            mkFuse.SetTools(shapeTools);
-            mkFuse.Build();
-            if (!mkFuse.IsDone())
-                throw Base::RuntimeError("MultiFusion failed");
+            // Shapes whose bounding boxes don't overlap can't interact. Fuse
+            // each cluster of overlapping shapes on its own and put the
+            // results into one compound, just like a single fusion of
+            // disjoint shapes would do.
+            std::vector< std::vector<int> > clusters = clusterShapes(s);
+            std::vector< std::unique_ptr<BRepAlgoAPI_Fuse> > fusers(clusters.size());
+            std::vector<TopoDS_Shape> results(clusters.size());
+
+            auto fuseCluster = [&](std::size_t i) {
+                const std::vector<int>& cluster = clusters[i];
+                if (cluster.size() < 2) {
+                    results[i] = s[cluster.front()];
+                    return;
+                }
 
-            TopoDS_Shape resShape = mkFuse.Shape();
-            for (std::vector<TopoDS_Shape>::iterator it = s.begin(); it != s.end(); ++it) {
-                history.push_back(buildHistory(mkFuse, TopAbs_FACE, resShape, *it));
+                fusers[i].reset(new BRepAlgoAPI_Fuse);
+                BRepAlgoAPI_Fuse& mkFuse = *fusers[i];
+                TopTools_ListOfShape shapeArguments,shapeTools;
+                shapeArguments.Append(s[cluster.front()]);
+                for (std::vector<int>::const_iterator it = cluster.begin()+1; it != cluster.end(); ++it)
+                    shapeTools.Append(s[*it]);
+
+                mkFuse.SetArguments(shapeArguments);
+                mkFuse.SetTools(shapeTools);
+#if OCC_VERSION_HEX >= 0x070000
+                mkFuse.SetRunParallel(Standard_True);
+                mkFuse.SetNonDestructive(Standard_True);
+#endif
+                mkFuse.Build();
+                if (!mkFuse.IsDone())
+                    throw Base::RuntimeError("MultiFusion failed");
+                results[i] = mkFuse.Shape();
+            };
+
+#if OCC_VERSION_HEX >= 0x070000
+            // Non-destructive fusions don't touch the inputs, so the clusters
+            // can run concurrently even if they share sub-shapes.
+            std::vector<std::size_t> indices(clusters.size());
+            for (std::size_t i=0; i<indices.size(); ++i)
+                indices[i] = i;
+            std::vector<std::exception_ptr> errors(clusters.size());
+            QtConcurrent::blockingMap(indices, [&](std::size_t i) {
+                try {
+                    fuseCluster(i);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+            for (const std::exception_ptr& error : errors) {
+                if (error)
+                    std::rethrow_exception(error);
+            }
+#else
+            for (std::size_t i=0; i<clusters.size(); ++i)
+                fuseCluster(i);
+#endif
+
+            TopoDS_Shape resShape;
+            if (clusters.size() == 1) {
+                resShape = results.front();
+                for (std::vector<TopoDS_Shape>::iterator it = s.begin(); it != s.end(); ++it) {
+                    history.push_back(buildHistory(*fusers.front(), TopAbs_FACE, resShape, *it));
+                }
+            }
+            else {
+                TopoDS_Compound comp;
+                BRep_Builder builder;
+                builder.MakeCompound(comp);
+                for (std::vector<TopoDS_Shape>::iterator it = results.begin(); it != results.end(); ++it) {
+                    if (it->ShapeType() == TopAbs_COMPOUND) {
+                        for (TopoDS_Iterator xp(*it); xp.More(); xp.Next())
+                            builder.Add(comp, xp.Value());
+                    }
+                    else {
+                        builder.Add(comp, *it);
+                    }
+                }
+                resShape = comp;
+
+                // history of each input to its cluster result, then to the compound
+                TopTools_IndexedMapOfShape resultFaces;
+                TopExp::MapShapes(resShape, TopAbs_FACE, resultFaces);
+                history.resize(s.size());
+                for (std::size_t i=0; i<clusters.size(); ++i) {
+                    if (!fusers[i]) {
+                        history[clusters[i].front()] = mapHistory(s[clusters[i].front()], resultFaces);
+                        continue;
+                    }
+                    ShapeHistory toResult = mapHistory(results[i], resultFaces);
+                    for (int index : clusters[i]) {
+                        ShapeHistory hist = buildHistory(*fusers[i], TopAbs_FACE, results[i], s[index]);
+                        history[index] = joinHistory(hist, toResult);
+                    }
+                }
             }
 #endif
             if (resShape.IsNull())
@@ -0,0 +1,307 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <cstring>
+# include <functional>
+# include <set>
+# include <sstream>
+# include <Standard_Failure.hxx>
+# include <Standard_Integer.hxx>
+# include <TopAbs_ShapeEnum.hxx>
+# include <TopExp.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
+#endif
+
+#include <App/Application.h>
+#include <App/PropertyContainer.h>
+#include <Base/Console.h>
+#include <Base/Parameter.h>
+#include <Base/Writer.h>
+
+#include "FeatureResultCache.h"
+#include "PartFeature.h"
+#include "PropertyTopoShape.h"
+#include "ShapeFingerprint.h"
+
+FC_LOG_LEVEL_INIT("Part",true,true)
+
+using namespace Part;
+
+namespace {
+
+/// Writes properties including the content of their extra files into one string
+class KeyWriter : public Base::Writer
+{
+public:
+    KeyWriter() {
+        setForceXML(false);
+    }
+    virtual std::ostream &Stream(void) override {
+        return stream;
+    }
+    virtual void writeFiles(void) override {
+        // a property may request further files while writing its own
+        for (std::size_t i=0; i<FileList.size(); ++i) {
+            stream << FileList[i].FileName << '\n';
+            FileList[i].Object->SaveDocFile(*this);
+        }
+        FileList.clear();
+    }
+    std::string getString() const {
+        return stream.str();
+    }
+
+private:
+    std::stringstream stream;
+};
+
+/// Properties that are no input of a recompute
+bool isIgnoredProperty(const App::PropertyContainer *container, const App::Property *prop)
+{
+    static const std::set<std::string> names = {
+        "Shape", "Placement", "Label", "Label2", "Visibility", "ExpressionEngine"
+    };
+    const char *name = prop->getName();
+    if (!name || names.count(name))
+        return true;
+    short type = container->getPropertyType(prop);
+    return (type & App::Prop_Output) || (type & App::Prop_Transient)
+        || prop->testStatus(App::Property::Output)
+        || prop->testStatus(App::Property::Transient);
+}
+
+/// Rough estimate of the memory used by a shape
+std::size_t estimateSize(const TopoDS_Shape &shape)
+{
+    if (shape.IsNull())
+        return 0;
+    TopTools_IndexedMapOfShape faces, edges, vertices;
+    TopExp::MapShapes(shape, TopAbs_FACE, faces);
+    TopExp::MapShapes(shape, TopAbs_EDGE, edges);
+    TopExp::MapShapes(shape, TopAbs_VERTEX, vertices);
+    // Surfaces, curves and pcurves dominate, the values are typical sizes of
+    // BSpline geometry and the topological structures around it.
+    return 1024 + faces.Extent() * 2048 + edges.Extent() * 768 + vertices.Extent() * 128;
+}
+
+inline void hashCombine(std::size_t &seed, std::size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------
+
+FeatureResultKey::FeatureResultKey(const Feature *feature)
+    : type(feature->getTypeId())
+{
+    _hash = std::hash<std::string>()(type.getName());
+
+    // Input shapes of all linked objects, in link order
+    for (auto obj : feature->getOutList()) {
+        TopoDS_Shape shape = Feature::getShape(obj);
+        uint64_t fingerprint = shapeFingerprint(shape);
+        fingerprints.push_back(fingerprint);
+        hashCombine(_hash, static_cast<std::size_t>(fingerprint));
+        if (!fingerprint && !shape.IsNull()) {
+            hashCombine(_hash, static_cast<std::size_t>(shape.HashCode(IntegerLast())));
+            shapes.push_back(shape);
+        }
+    }
+
+    // Values of all input properties
+    std::vector<App::Property*> props;
+    feature->getPropertyList(props);
+    KeyWriter writer;
+    for (auto prop : props) {
+        if (isIgnoredProperty(feature, prop))
+            continue;
+        writer.Stream() << prop->getName() << '\n';
+        prop->Save(writer);
+    }
+    writer.writeFiles();
+    parameters = writer.getString();
+    hashCombine(_hash, std::hash<std::string>()(parameters));
+}
+
+bool FeatureResultKey::operator==(const FeatureResultKey &other) const
+{
+    if (_hash != other._hash || type != other.type
+            || fingerprints != other.fingerprints
+            || shapes.size() != other.shapes.size()
+            || parameters != other.parameters)
+        return false;
+    for (std::size_t i=0; i<shapes.size(); ++i) {
+        if (!shapes[i].IsEqual(other.shapes[i]))
+            return false;
+    }
+    return true;
+}
+
+std::size_t FeatureResultKey::size() const
+{
+    return sizeof(*this) + parameters.size() + fingerprints.size() * sizeof(uint64_t)
+        + shapes.size() * sizeof(TopoDS_Shape);
+}
+
+// ------------------------------------------------------------------------
+
+struct FeatureResultCache::Entry {
+    std::shared_ptr<FeatureResultKey> key;
+    TopoShape shape;
+    std::vector<std::pair<std::string, std::unique_ptr<App::Property> > > outputs;
+    std::vector<ShapeHistory> history;
+    std::size_t size = 0;
+};
+
+FeatureResultCache::FeatureResultCache()
+    : totalSize(0)
+{
+}
+
+FeatureResultCache &FeatureResultCache::instance()
+{
+    static FeatureResultCache _Instance;
+    return _Instance;
+}
+
+static std::size_t getCacheLimit()
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath(
+            "User parameter:BaseApp/Preferences/Mod/Part/General");
+    long size = hGrp->GetInt("ResultCacheSize", 0);
+    return size > 0 ? static_cast<std::size_t>(size) * 1024 * 1024 : 0;
+}
+
+bool FeatureResultCache::isEnabled() const
+{
+    return getCacheLimit() > 0;
+}
+
+std::shared_ptr<FeatureResultKey> FeatureResultCache::makeKey(const Feature *feature) const
+{
+    if (!isEnabled())
+        return std::shared_ptr<FeatureResultKey>();
+    try {
+        return std::make_shared<FeatureResultKey>(feature);
+    }
+    catch (Base::Exception &e) {
+        FC_LOG("cannot build result key of " << feature->getFullName() << ": " << e.what());
+    }
+    catch (Standard_Failure &e) {
+        FC_LOG("cannot build result key of " << feature->getFullName() << ": " << e.GetMessageString());
+    }
+    return std::shared_ptr<FeatureResultKey>();
+}
+
+bool FeatureResultCache::restore(const FeatureResultKey &key, Feature *feature)
+{
+    auto it = lookup.find(&key);
+    if (it == lookup.end())
+        return false;
+
+    // move to front as most recently used
+    entries.splice(entries.begin(), entries, it->second);
+    const Entry &entry = *entries.front();
+
+    feature->Shape.setValue(entry.shape);
+    for (auto &output : entry.outputs) {
+        App::Property *prop = feature->getPropertyByName(output.first.c_str());
+        if (prop && prop->getTypeId() == output.second->getTypeId())
+            prop->Paste(*output.second);
+    }
+    if (!entry.history.empty()) {
+        // same as the features do, see Fillet::execute()
+        PropertyShapeHistory prop;
+        prop.setValues(entry.history);
+        prop.setContainer(feature);
+        prop.touch();
+    }
+    FC_LOG("restored cached result of " << feature->getFullName());
+    return true;
+}
+
+void FeatureResultCache::store(const std::shared_ptr<FeatureResultKey> &key, const Feature *feature,
+        const std::vector<ShapeHistory> &history)
+{
+    std::size_t limit = getCacheLimit();
+    if (!key || !limit)
+        return;
+
+    std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+    entry->key = key;
+    entry->shape = feature->Shape.getShape();
+    entry->history = history;
+    entry->size = key->size() + estimateSize(entry->shape.getShape());
+
+    std::vector<App::Property*> props;
+    feature->getPropertyList(props);
+    for (auto prop : props) {
+        if (prop == &feature->Shape || !prop->getName())
+            continue;
+        short type = feature->getPropertyType(prop);
+        if (!(type & App::Prop_Output) && !prop->testStatus(App::Property::Output))
+            continue;
+        // outputs of the base classes are not results of the recompute
+        if (std::strcmp(prop->getName(), "Placement") == 0)
+            continue;
+        entry->outputs.emplace_back(prop->getName(), std::unique_ptr<App::Property>(prop->Copy()));
+    }
+
+    if (entry->size > limit)
+        return;
+
+    auto it = lookup.find(key.get());
+    if (it != lookup.end()) {
+        totalSize -= (*it->second)->size;
+        entries.erase(it->second);
+        lookup.erase(it);
+    }
+
+    entries.push_front(entry);
+    lookup[key.get()] = entries.begin();
+    totalSize += entry->size;
+    evict(limit);
+}
+
+void FeatureResultCache::evict(std::size_t limit)
+{
+    while (totalSize > limit && !entries.empty()) {
+        const std::shared_ptr<Entry> &entry = entries.back();
+        totalSize -= entry->size;
+        lookup.erase(entry->key.get());
+        entries.pop_back();
+    }
+}
+
+void FeatureResultCache::clear()
+{
+    lookup.clear();
+    entries.clear();
+    totalSize = 0;
+}
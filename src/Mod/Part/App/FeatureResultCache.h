@@ -0,0 +1,141 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PART_FEATURERESULTCACHE_H
+#define PART_FEATURERESULTCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <Base/Type.h>
+#include "TopoShape.h"
+
+namespace App {
+class Property;
+}
+
+namespace Part
+{
+
+class Feature;
+struct ShapeHistory;
+
+/** Identifies the inputs of one recompute of a Part feature
+ *
+ * The key consists of the feature type, the shapes of all objects the
+ * feature links to, and the values of all its non-output properties. The
+ * shapes are compared by their content, see shapeFingerprint(), because an
+ * input that is recomputed again, e.g. after undo, gets a new TShape with
+ * the same geometry. Shapes with geometry that can't be hashed fall back to
+ * comparing the identity.
+ */
+class PartExport FeatureResultKey
+{
+public:
+    FeatureResultKey(const Feature *feature);
+
+    bool operator==(const FeatureResultKey &other) const;
+    std::size_t hash() const {
+        return _hash;
+    }
+    /// Rough number of bytes held by the key
+    std::size_t size() const;
+
+private:
+    Base::Type type;
+    std::vector<uint64_t> fingerprints;
+    // only for inputs without a fingerprint
+    std::vector<TopoDS_Shape> shapes;
+    std::string parameters;
+    std::size_t _hash;
+};
+
+/** Opt-in cache of Part feature recompute results
+ *
+ * Features that support it call Feature::restoreCachedResult() at the start
+ * of execute() and Feature::cacheResult() after a successful recompute. When
+ * the inputs return to a state already seen, e.g. after undo or when
+ * toggling a parameter back, the stored outputs are restored instead of
+ * running the modeling operations again.
+ *
+ * The cache is limited by the parameter "ResultCacheSize" in
+ * Mod/Part/General, in MB. It is 0 by default, which disables the cache.
+ * Once the limit is exceeded, the least recently used results are dropped.
+ * The size of a result is estimated from its topology.
+ */
+class PartExport FeatureResultCache
+{
+public:
+    static FeatureResultCache &instance();
+
+    /// Returns whether the cache is enabled
+    bool isEnabled() const;
+    /// Returns the key of the current inputs of the feature, or null if the cache is disabled
+    std::shared_ptr<FeatureResultKey> makeKey(const Feature *feature) const;
+    /** Restores the outputs stored for the key into the feature
+     * @return false if there is no result for this key
+     */
+    bool restore(const FeatureResultKey &key, Feature *feature);
+    /** Stores the current outputs of the feature
+     * @param key: key as returned by makeKey() before the recompute
+     * @param feature: the recomputed feature
+     * @param history: history to re-emit on restore, for features that
+     * only signal it through a temporary property
+     */
+    void store(const std::shared_ptr<FeatureResultKey> &key, const Feature *feature,
+            const std::vector<ShapeHistory> &history);
+    /// Removes all results
+    void clear();
+
+private:
+    FeatureResultCache();
+
+    struct KeyHasher {
+        std::size_t operator()(const FeatureResultKey *key) const {
+            return key->hash();
+        }
+    };
+    struct KeyEqual {
+        bool operator()(const FeatureResultKey *a, const FeatureResultKey *b) const {
+            return *a == *b;
+        }
+    };
+    struct Entry;
+    typedef std::list<std::shared_ptr<Entry> > EntryList;
+
+    void evict(std::size_t limit);
+
+private:
+    EntryList entries; // most recently used first
+    std::unordered_map<const FeatureResultKey*, EntryList::iterator, KeyHasher, KeyEqual> lookup;
+    std::size_t totalSize;
+};
+
+} //namespace Part
+
+#endif // PART_FEATURERESULTCACHE_H
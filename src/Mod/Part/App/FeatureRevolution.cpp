@@ -130,6 +130,8 @@ App::DocumentObjectExecReturn *Revolution::execute(void)
     App::DocumentObject* link = Source.getValue();
     if (!link)
         return new App::DocumentObjectExecReturn("No object linked");
+    if (restoreCachedResult())
+        return App::DocumentObject::StdReturn;
 
     try {
         //read out axis link
@@ -192,6 +194,7 @@ App::DocumentObjectExecReturn *Revolution::execute(void)
         if (revolve.IsNull())
             return new App::DocumentObjectExecReturn("Resulting shape is null");
         this->Shape.setValue(revolve);
+        cacheResult();
         return App::DocumentObject::StdReturn;
     }
     catch (Standard_Failure& e) {
@@ -71,6 +71,7 @@
 #include "PartPyCXX.h"
 #include "PartFeature.h"
 #include "PartFeaturePy.h"
+#include "FeatureResultCache.h"
 #include "TopoShapePy.h"
 
 using namespace Part;
@@ -653,6 +654,26 @@ ShapeHistory Feature::joinHistory(const ShapeHistory& oldH, const ShapeHistory&
     return join;
 }
 
+bool Feature::restoreCachedResult()
+{
+    auto &cache = FeatureResultCache::instance();
+    _ResultKey = cache.makeKey(this);
+    if (_ResultKey && cache.restore(*_ResultKey, this)) {
+        // execute() returns right away and cacheResult() isn't called
+        _ResultKey.reset();
+        return true;
+    }
+    return false;
+}
+
+void Feature::cacheResult(const std::vector<ShapeHistory> &history)
+{
+    if (_ResultKey) {
+        FeatureResultCache::instance().store(_ResultKey, this, history);
+        _ResultKey.reset();
+    }
+}
+
     /// returns the type name of the ViewProvider
 const char* Feature::getViewProviderName(void) const {
     return "PartGui::ViewProviderPart";
@@ -41,6 +41,7 @@ namespace Part
 {
 
 class PartFeaturePy;
+class FeatureResultKey;
 
 /** Base class of all shape feature classes in FreeCAD
  */
@@ -125,6 +126,21 @@ protected:
     ShapeHistory buildHistory(BRepBuilderAPI_MakeShape&, TopAbs_ShapeEnum type,
         const TopoDS_Shape& newS, const TopoDS_Shape& oldS);
     ShapeHistory joinHistory(const ShapeHistory&, const ShapeHistory&);
+    /**
+     * Restores the outputs of an earlier recompute with the same inputs, see
+     * FeatureResultCache. Call it at the start of execute(). Returns true
+     * if the outputs were restored and execute() can return right away.
+     */
+    bool restoreCachedResult();
+    /**
+     * Stores the outputs of a successful recompute in FeatureResultCache
+     * history: history to re-emit on restore, for features that only
+     * signal it through a temporary property
+     */
+    void cacheResult(const std::vector<ShapeHistory> &history = std::vector<ShapeHistory>());
+
+private:
+    std::shared_ptr<FeatureResultKey> _ResultKey;
 };
 
 class FilletBase : public Part::Feature
@@ -68,6 +68,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <stdexcept>
+#include <exception>
 
 #include <cmath>
 #include <ctime>
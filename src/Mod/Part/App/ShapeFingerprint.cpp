@@ -0,0 +1,311 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <cstring>
+# include <BRep_Tool.hxx>
+# include <BRepTools.hxx>
+# include <BRepAdaptor_Curve.hxx>
+# include <BRepAdaptor_Surface.hxx>
+# include <GeomAdaptor_Curve.hxx>
+# include <Geom_BezierCurve.hxx>
+# include <Geom_BezierSurface.hxx>
+# include <Geom_BSplineCurve.hxx>
+# include <Geom_BSplineSurface.hxx>
+# include <Geom_SurfaceOfLinearExtrusion.hxx>
+# include <Geom_SurfaceOfRevolution.hxx>
+# include <TopExp.hxx>
+# include <gp_Circ.hxx>
+# include <gp_Cone.hxx>
+# include <gp_Cylinder.hxx>
+# include <gp_Elips.hxx>
+# include <gp_Hypr.hxx>
+# include <gp_Lin.hxx>
+# include <gp_Parab.hxx>
+# include <gp_Pln.hxx>
+# include <gp_Pnt.hxx>
+# include <gp_Sphere.hxx>
+# include <gp_Torus.hxx>
+# include <gp_Trsf.hxx>
+# include <TopoDS.hxx>
+# include <TopoDS_Edge.hxx>
+# include <TopoDS_Face.hxx>
+# include <TopoDS_Vertex.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
+#endif
+
+#include "ShapeFingerprint.h"
+
+namespace {
+// 64 bit FNV-1a
+class Fingerprint
+{
+public:
+    template <typename T>
+    void add(const T& value) {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        for (unsigned char b : bytes) {
+            hash ^= b;
+            hash *= 1099511628211ULL;
+        }
+    }
+    void add(const gp_XYZ& xyz) {
+        add(xyz.X());
+        add(xyz.Y());
+        add(xyz.Z());
+    }
+    void add(const gp_Ax1& ax) {
+        add(ax.Location().XYZ());
+        add(ax.Direction().XYZ());
+    }
+    void add(const gp_Ax2& ax) {
+        add(ax.Location().XYZ());
+        add(ax.Direction().XYZ());
+        add(ax.XDirection().XYZ());
+    }
+    void add(const gp_Ax3& ax) {
+        add(ax.Location().XYZ());
+        add(ax.Direction().XYZ());
+        add(ax.XDirection().XYZ());
+        add(ax.YDirection().XYZ());
+    }
+    void add(const gp_Trsf& trsf) {
+        for (int r=1; r<=3; r++) {
+            for (int c=1; c<=4; c++)
+                add(trsf.Value(r,c));
+        }
+    }
+    uint64_t value() const {
+        // zero is reserved for an invalid key
+        return hash ? hash : 1;
+    }
+
+private:
+    uint64_t hash = 14695981039346656037ULL;
+};
+
+// Adds the definition of a curve, returns false if its type isn't supported
+bool addCurve(Fingerprint& fp, const Adaptor3d_Curve& curve)
+{
+    GeomAbs_CurveType type = curve.GetType();
+    fp.add(static_cast<int32_t>(type));
+    switch (type) {
+    case GeomAbs_Line:
+        fp.add(curve.Line().Position());
+        return true;
+    case GeomAbs_Circle:
+        fp.add(curve.Circle().Position());
+        fp.add(curve.Circle().Radius());
+        return true;
+    case GeomAbs_Ellipse:
+        fp.add(curve.Ellipse().Position());
+        fp.add(curve.Ellipse().MajorRadius());
+        fp.add(curve.Ellipse().MinorRadius());
+        return true;
+    case GeomAbs_Hyperbola:
+        fp.add(curve.Hyperbola().Position());
+        fp.add(curve.Hyperbola().MajorRadius());
+        fp.add(curve.Hyperbola().MinorRadius());
+        return true;
+    case GeomAbs_Parabola:
+        fp.add(curve.Parabola().Position());
+        fp.add(curve.Parabola().Focal());
+        return true;
+    case GeomAbs_BezierCurve: {
+        Handle(Geom_BezierCurve) bezier = curve.Bezier();
+        fp.add(static_cast<int32_t>(bezier->NbPoles()));
+        for (int i=1; i<=bezier->NbPoles(); i++) {
+            fp.add(bezier->Pole(i).XYZ());
+            fp.add(bezier->Weight(i));
+        }
+        return true;
+    }
+    case GeomAbs_BSplineCurve: {
+        Handle(Geom_BSplineCurve) spline = curve.BSpline();
+        fp.add(static_cast<int32_t>(spline->Degree()));
+        fp.add(static_cast<int32_t>(spline->IsPeriodic()));
+        fp.add(static_cast<int32_t>(spline->NbPoles()));
+        for (int i=1; i<=spline->NbPoles(); i++) {
+            fp.add(spline->Pole(i).XYZ());
+            fp.add(spline->Weight(i));
+        }
+        fp.add(static_cast<int32_t>(spline->NbKnots()));
+        for (int i=1; i<=spline->NbKnots(); i++) {
+            fp.add(spline->Knot(i));
+            fp.add(static_cast<int32_t>(spline->Multiplicity(i)));
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+// Adds the definition of the surface of a face, returns false if its type isn't supported
+bool addSurface(Fingerprint& fp, const TopoDS_Face& face)
+{
+    BRepAdaptor_Surface surface(face, Standard_False);
+    GeomAbs_SurfaceType type = surface.GetType();
+    fp.add(static_cast<int32_t>(type));
+    switch (type) {
+    case GeomAbs_Plane:
+        fp.add(surface.Plane().Position());
+        return true;
+    case GeomAbs_Cylinder:
+        fp.add(surface.Cylinder().Position());
+        fp.add(surface.Cylinder().Radius());
+        return true;
+    case GeomAbs_Cone:
+        fp.add(surface.Cone().Position());
+        fp.add(surface.Cone().RefRadius());
+        fp.add(surface.Cone().SemiAngle());
+        return true;
+    case GeomAbs_Sphere:
+        fp.add(surface.Sphere().Position());
+        fp.add(surface.Sphere().Radius());
+        return true;
+    case GeomAbs_Torus:
+        fp.add(surface.Torus().Position());
+        fp.add(surface.Torus().MajorRadius());
+        fp.add(surface.Torus().MinorRadius());
+        return true;
+    case GeomAbs_BezierSurface: {
+        Handle(Geom_BezierSurface) bezier = surface.Bezier();
+        fp.add(static_cast<int32_t>(bezier->NbUPoles()));
+        fp.add(static_cast<int32_t>(bezier->NbVPoles()));
+        for (int i=1; i<=bezier->NbUPoles(); i++) {
+            for (int j=1; j<=bezier->NbVPoles(); j++) {
+                fp.add(bezier->Pole(i,j).XYZ());
+                fp.add(bezier->Weight(i,j));
+            }
+        }
+        return true;
+    }
+    case GeomAbs_BSplineSurface: {
+        Handle(Geom_BSplineSurface) spline = surface.BSpline();
+        fp.add(static_cast<int32_t>(spline->UDegree()));
+        fp.add(static_cast<int32_t>(spline->VDegree()));
+        fp.add(static_cast<int32_t>(spline->IsUPeriodic()));
+        fp.add(static_cast<int32_t>(spline->IsVPeriodic()));
+        fp.add(static_cast<int32_t>(spline->NbUPoles()));
+        fp.add(static_cast<int32_t>(spline->NbVPoles()));
+        for (int i=1; i<=spline->NbUPoles(); i++) {
+            for (int j=1; j<=spline->NbVPoles(); j++) {
+                fp.add(spline->Pole(i,j).XYZ());
+                fp.add(spline->Weight(i,j));
+            }
+        }
+        fp.add(static_cast<int32_t>(spline->NbUKnots()));
+        for (int i=1; i<=spline->NbUKnots(); i++) {
+            fp.add(spline->UKnot(i));
+            fp.add(static_cast<int32_t>(spline->UMultiplicity(i)));
+        }
+        fp.add(static_cast<int32_t>(spline->NbVKnots()));
+        for (int i=1; i<=spline->NbVKnots(); i++) {
+            fp.add(spline->VKnot(i));
+            fp.add(static_cast<int32_t>(spline->VMultiplicity(i)));
+        }
+        return true;
+    }
+    case GeomAbs_SurfaceOfRevolution:
+    case GeomAbs_SurfaceOfExtrusion: {
+        // the adaptor doesn't give access to the basis curve in the same way
+        // in all OCC versions, so take it from the geometry itself
+        TopLoc_Location loc;
+        Handle(Geom_Surface) geom = BRep_Tool::Surface(face, loc);
+        fp.add(loc.Transformation());
+        Handle(Geom_Curve) basis;
+        Handle(Geom_SurfaceOfRevolution) rev = Handle(Geom_SurfaceOfRevolution)::DownCast(geom);
+        Handle(Geom_SurfaceOfLinearExtrusion) ext = Handle(Geom_SurfaceOfLinearExtrusion)::DownCast(geom);
+        if (!rev.IsNull()) {
+            fp.add(rev->Axis());
+            basis = rev->BasisCurve();
+        }
+        else if (!ext.IsNull()) {
+            fp.add(ext->Direction().XYZ());
+            basis = ext->BasisCurve();
+        }
+        if (basis.IsNull())
+            return false;
+        return addCurve(fp, GeomAdaptor_Curve(basis));
+    }
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+uint64_t Part::shapeFingerprint(const TopoDS_Shape& shape)
+{
+    if (shape.IsNull())
+        return 0;
+
+    TopTools_IndexedMapOfShape faceMap, edgeMap, vertexMap;
+    TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+    TopExp::MapShapes(shape, TopAbs_EDGE, edgeMap);
+    TopExp::MapShapes(shape, TopAbs_VERTEX, vertexMap);
+
+    Fingerprint fp;
+    fp.add(static_cast<int32_t>(faceMap.Extent()));
+    fp.add(static_cast<int32_t>(edgeMap.Extent()));
+    fp.add(static_cast<int32_t>(vertexMap.Extent()));
+
+    for (int i=1; i<=vertexMap.Extent(); i++) {
+        gp_Pnt pnt = BRep_Tool::Pnt(TopoDS::Vertex(vertexMap(i)));
+        fp.add(pnt.X());
+        fp.add(pnt.Y());
+        fp.add(pnt.Z());
+    }
+
+    for (int i=1; i<=edgeMap.Extent(); i++) {
+        const TopoDS_Edge& edge = TopoDS::Edge(edgeMap(i));
+        fp.add(static_cast<int32_t>(edge.Orientation()));
+        if (BRep_Tool::Degenerated(edge))
+            continue;
+        BRepAdaptor_Curve curve(edge);
+        if (!addCurve(fp, curve))
+            return 0;
+        fp.add(curve.FirstParameter());
+        fp.add(curve.LastParameter());
+    }
+
+    for (int i=1; i<=faceMap.Extent(); i++) {
+        const TopoDS_Face& face = TopoDS::Face(faceMap(i));
+        fp.add(static_cast<int32_t>(face.Orientation()));
+        if (!addSurface(fp, face))
+            return 0;
+        Standard_Real u1, u2, v1, v2;
+        BRepTools::UVBounds(face, u1, u2, v1, v2);
+        fp.add(u1);
+        fp.add(u2);
+        fp.add(v1);
+        fp.add(v2);
+    }
+
+    return fp.value();
+}
@@ -0,0 +1,50 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PART_SHAPEFINGERPRINT_H
+#define PART_SHAPEFINGERPRINT_H
+
+#include <cstdint>
+#include <TopoDS_Shape.hxx>
+
+namespace Part
+{
+
+/** Computes a hash over the topology and the geometry of a shape
+ *
+ * The hash covers the number of sub-shapes, the vertex positions, the
+ * definitions of all curves and surfaces (axes, radii, poles, weights,
+ * knots), their parameter ranges and the orientations. Unlike
+ * TopoDS_Shape::HashCode() it doesn't depend on the identity of the TShape,
+ * so equal geometry built twice gets the same value. The location of the
+ * shape is part of the hash.
+ *
+ * Returns 0 for a null shape and for shapes containing geometry that can't
+ * be hashed, e.g. offset surfaces or edges without a 3D curve.
+ */
+PartExport uint64_t shapeFingerprint(const TopoDS_Shape& shape);
+
+} //namespace Part
+
+#endif // PART_SHAPEFINGERPRINT_H
@@ -22,10 +22,16 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
 # include <cassert>
+# include <vector>
 # include <gp_Pln.hxx>
 # include <gp_Lin.hxx>
 # include <Adaptor3d_HCurveOnSurface.hxx>
+# include <Bnd_BoundSortBox.hxx>
+# include <Bnd_Box.hxx>
+# include <Bnd_HArray1OfBox.hxx>
+# include <BRepBndLib.hxx>
 # include <Geom_BSplineSurface.hxx>
 # include <Geom_Plane.hxx>
 # include <GeomAdaptor_HCurve.hxx>
@@ -38,17 +44,86 @@
 # include <GeomPlate_PlateG0Criterion.hxx>
 # include <GeomPlate_PointConstraint.hxx>
 # include <Precision.hxx>
+# include <Standard_Failure.hxx>
 # include <Standard_Mutex.hxx>
 # include <Standard_TypeMismatch.hxx>
+# include <TColStd_ListIteratorOfListOfInteger.hxx>
 # include <TColStd_ListOfTransient.hxx>
 # include <TColStd_ListIteratorOfListOfTransient.hxx>
 # include <TColgp_SequenceOfXY.hxx>
 # include <TColgp_SequenceOfXYZ.hxx>
+# include <TopoDS_Shape.hxx>
 #endif
 
 #include <Base/Vector3D.h>
 #include "Tools.h"
 
+std::vector< std::vector<int> > Part::clusterShapes(const std::vector<TopoDS_Shape>& shapes)
+{
+    int count = static_cast<int>(shapes.size());
+    std::vector< std::vector<int> > clusters;
+    if (count == 0)
+        return clusters;
+
+    Handle(Bnd_HArray1OfBox) boxes = new Bnd_HArray1OfBox(1, count);
+    Bnd_Box enclosing;
+    bool voidBox = false;
+    for (int i=0; i<count && !voidBox; ++i) {
+        Bnd_Box &box = boxes->ChangeValue(i+1);
+        try {
+            BRepBndLib::Add(shapes[i], box);
+        }
+        catch (Standard_Failure&) {
+            box.SetVoid();
+        }
+        voidBox = box.IsVoid();
+        box.Enlarge(Precision::Confusion());
+        enclosing.Add(box);
+    }
+
+    // Without a box for every shape, put everything into one cluster
+    if (voidBox || count < 2) {
+        clusters.emplace_back();
+        for (int i=0; i<count; ++i)
+            clusters.back().push_back(i);
+        return clusters;
+    }
+
+    std::vector<int> parent(count);
+    for (int i=0; i<count; ++i)
+        parent[i] = i;
+    auto findRoot = [&parent](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
+    Bnd_BoundSortBox index;
+    index.Initialize(enclosing, boxes);
+    for (int i=0; i<count; ++i) {
+        const TColStd_ListOfInteger& hits = index.Compare(boxes->Value(i+1));
+        for (TColStd_ListIteratorOfListOfInteger it(hits); it.More(); it.Next()) {
+            int a = findRoot(i);
+            int b = findRoot(it.Value()-1);
+            if (a != b)
+                parent[std::max(a,b)] = std::min(a,b);
+        }
+    }
+
+    std::vector<int> clusterOf(count, -1);
+    for (int i=0; i<count; ++i) {
+        int root = findRoot(i);
+        if (clusterOf[root] < 0) {
+            clusterOf[root] = static_cast<int>(clusters.size());
+            clusters.emplace_back();
+        }
+        clusters[clusterOf[root]].push_back(i);
+    }
+    return clusters;
+}
+
 void Part::closestPointsOnLines(const gp_Lin& lin1, const gp_Lin& lin2, gp_Pnt& p1, gp_Pnt& p2)
 {
     // they might be the same point
@@ -24,6 +24,7 @@
 #ifndef PART_TOOLS_H
 #define PART_TOOLS_H
 
+#include <vector>
 #include <Base/Converter.h>
 #include <gp_Pnt.hxx>
 #include <gp_Vec.hxx>
@@ -31,6 +32,7 @@
 #include <gp_XYZ.hxx>
 #include <Geom_Surface.hxx>
 #include <TColStd_ListOfTransient.hxx>
+#include <TopoDS_Shape.hxx>
 
 class gp_Lin;
 class gp_Pln;
@@ -95,6 +97,17 @@ PartExport
 bool intersect(const gp_Pln& pln1, const gp_Pln& pln2, gp_Lin& lin);
 PartExport
 bool tangentialArc(const gp_Pnt& p0, const gp_Vec& v0, const gp_Pnt& p1, gp_Pnt& c, gp_Dir& a);
+/** Groups the shapes into clusters of shapes whose bounding boxes overlap,
+ * directly or through other shapes of the same cluster
+ *
+ * Shapes of different clusters can't touch each other. The clusters are
+ * ordered by their first shape, and the shapes in a cluster keep their input
+ * order. If a box can't be computed, all shapes end up in one cluster.
+ *
+ * @return Clusters of indices into shapes
+ */
+PartExport
+std::vector< std::vector<int> > clusterShapes(const std::vector<TopoDS_Shape>& shapes);
 
 class PartExport Tools
 {
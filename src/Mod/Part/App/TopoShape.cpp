@@ -199,6 +199,7 @@
 
 #include "PartPyCXX.h"
 #include "TopoShape.h"
+#include "TopoShapeCache.h"
 #include "CrossSection.h"
 #include "TopoShapeFacePy.h"
 #include "TopoShapeEdgePy.h"
@@ -323,6 +324,26 @@ TopoShape::TopoShape(const TopoShape& shape)
   : _Shape(shape._Shape)
 {
     Tag = shape.Tag;
+    _Cache = std::atomic_load(&shape._Cache);
+}
+
+std::shared_ptr<TopoShapeCache> TopoShape::getCache() const
+{
+    // Besides setShape() and resetCache() the cache is checked against the
+    // current shape to catch direct assignments of _Shape. std::atomic_load/
+    // store allow concurrent readers of a const TopoShape to create it at the
+    // same time.
+    auto cache = std::atomic_load(&_Cache);
+    if(!cache || !cache->isValidFor(_Shape)) {
+        cache = std::make_shared<TopoShapeCache>(_Shape);
+        std::atomic_store(&_Cache, cache);
+    }
+    return cache;
+}
+
+void TopoShape::resetCache()
+{
+    std::atomic_store(&_Cache, std::shared_ptr<TopoShapeCache>());
 }
 
 std::vector<const char*> TopoShape::getElementTypes(void) const
@@ -372,8 +393,9 @@ TopoDS_Shape TopoShape::getSubShape(TopAbs_ShapeEnum type, int index, bool silen
                     return it.Value();
             }
         } else {
-            TopTools_IndexedMapOfShape anIndices;
-            TopExp::MapShapes(this->_Shape, type, anIndices);
+            // keep the cache alive while the map is in use
+            auto cache = getCache();
+            const auto &anIndices = cache->getSubShapeMap(type);
             if(index <= anIndices.Extent())
                 return anIndices.FindKey(index);
         }
@@ -406,9 +428,7 @@ unsigned long TopoShape::countSubShapes(TopAbs_ShapeEnum Type) const
             ++count;
         return count;
     }
-    TopTools_IndexedMapOfShape anIndices;
-    TopExp::MapShapes(this->_Shape, Type, anIndices);
-    return anIndices.Extent();
+    return getCache()->countSubShapes(Type);
 }
 
 bool TopoShape::hasSubShape(TopAbs_ShapeEnum type) const {
@@ -426,8 +446,9 @@ bool TopoShape::hasSubShape(const char *Type) const {
 }
 
 template<class T>
-static inline std::vector<T> _getSubShapes(const TopoDS_Shape &s, TopAbs_ShapeEnum type) {
+static inline std::vector<T> _getSubShapes(const TopoShape &shape, TopAbs_ShapeEnum type) {
     std::vector<T> shapes;
+    const TopoDS_Shape &s = shape.getShape();
     if(s.IsNull())
         return shapes;
 
@@ -437,8 +458,8 @@ static inline std::vector<T> _getSubShapes(const TopoDS_Shape &s, TopAbs_ShapeEn
         return shapes;
     }
 
-    TopTools_IndexedMapOfShape anIndices;
-    TopExp::MapShapes(s, type, anIndices);
+    auto cache = shape.getCache();
+    const auto &anIndices = cache->getSubShapeMap(type);
     int count = anIndices.Extent();
     shapes.reserve(count);
     for(int i=1;i<=count;++i)
@@ -447,11 +468,11 @@ static inline std::vector<T> _getSubShapes(const TopoDS_Shape &s, TopAbs_ShapeEn
 }
 
 std::vector<TopoShape> TopoShape::getSubTopoShapes(TopAbs_ShapeEnum type) const {
-    return _getSubShapes<TopoShape>(_Shape,type);
+    return _getSubShapes<TopoShape>(*this,type);
 }
 
 std::vector<TopoDS_Shape> TopoShape::getSubShapes(TopAbs_ShapeEnum type) const {
-    return _getSubShapes<TopoDS_Shape>(_Shape,type);
+    return _getSubShapes<TopoDS_Shape>(*this,type);
 }
 
 static std::array<std::string,TopAbs_SHAPE> _ShapeNames;
@@ -598,7 +619,7 @@ PyObject * TopoShape::getPyObject()
 void TopoShape::setPyObject(PyObject* obj)
 {
     if (PyObject_TypeCheck(obj, &TopoShapePy::Type)) {
-        this->_Shape = static_cast<TopoShapePy*>(obj)->getTopoShapePtr()->getShape();
+        setShape(static_cast<TopoShapePy*>(obj)->getTopoShapePtr()->getShape());
     }
     else {
         std::string error = std::string("type must be 'Shape', not ");
@@ -612,6 +633,7 @@ void TopoShape::operator = (const TopoShape& sh)
     if (this != &sh) {
         this->Tag = sh.Tag;
         this->_Shape = sh._Shape;
+        std::atomic_store(&this->_Cache, std::atomic_load(&sh._Cache));
     }
 }
 
@@ -1251,9 +1273,10 @@ Base::BoundBox3d TopoShape::getBoundBox(void) const
     Base::BoundBox3d box;
     try {
         // If the shape is empty an exception may be thrown
-        Bnd_Box bounds;
-        BRepBndLib::Add(_Shape, bounds);
-        bounds.SetGap(0.0);
+        auto cache = getCache();
+        const Bnd_Box &bounds = cache->getBoundBox();
+        if (bounds.IsVoid())
+            return box;
         Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
         bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
 
@@ -2030,17 +2053,14 @@ TopoDS_Shape TopoShape::section(const std::vector<TopoDS_Shape>& shapes,
 
 std::list<TopoDS_Wire> TopoShape::slice(const Base::Vector3d& dir, double d) const
 {
-    CrossSection cs(dir.x, dir.y, dir.z, this->_Shape);
+    CrossSection cs(dir.x, dir.y, dir.z, *this);
     return cs.slice(d);
 }
 
 TopoDS_Compound TopoShape::slices(const Base::Vector3d& dir, const std::vector<double>& d) const
 {
-    std::vector< std::list<TopoDS_Wire> > wire_list;
-    CrossSection cs(dir.x, dir.y, dir.z, this->_Shape);
-    for (std::vector<double>::const_iterator jt = d.begin(); jt != d.end(); ++jt) {
-        wire_list.push_back(cs.slice(*jt));
-    }
+    CrossSection cs(dir.x, dir.y, dir.z, *this);
+    std::vector< std::list<TopoDS_Wire> > wire_list = cs.slice(d);
 
     std::vector< std::list<TopoDS_Wire> >::const_iterator ft;
     TopoDS_Compound comp;
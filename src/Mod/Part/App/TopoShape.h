@@ -25,6 +25,7 @@
 #define PART_TOPOSHAPE_H
 
 #include <iosfwd>
+#include <memory>
 #include <TopoDS_Compound.hxx>
 #include <TopoDS_Wire.hxx>
 #include <TopTools_ListOfShape.hxx>
@@ -43,6 +44,8 @@ class Color;
 namespace Part
 {
 
+class TopoShapeCache;
+
 /* A special sub-class to indicate null shapes
  */
 class PartExport NullShapeException : public Base::ValueError
@@ -97,6 +100,7 @@ public:
 
     inline void setShape(const TopoDS_Shape& shape) {
         this->_Shape = shape;
+        resetCache();
     }
 
     inline const TopoDS_Shape& getShape() const {
@@ -365,8 +369,25 @@ public:
     static const std::string &shapeName(TopAbs_ShapeEnum type,bool silent=false);
     const std::string &shapeName(bool silent=false) const;
     static std::pair<TopAbs_ShapeEnum,int> shapeTypeAndIndex(const char *name);
+
+    /** Returns the index of this shape
+     *
+     * The index is built lazily and shared among copies of this TopoShape
+     * as long as they hold the same TopoDS_Shape. A new one is created
+     * once the shape is changed.
+     */
+    std::shared_ptr<TopoShapeCache> getCache() const;
+    /** Drops the index of this shape
+     *
+     * Must be called by code that modifies the underlying TopoDS_TShape in
+     * place, e.g. with BRep_Builder, as this can't be detected by getCache().
+     * setShape() already does it.
+     */
+    void resetCache();
+
 private:
     TopoDS_Shape _Shape;
+    mutable std::shared_ptr<TopoShapeCache> _Cache;
 };
 
 } //namespace Part
@@ -0,0 +1,190 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <Bnd_BoundSortBox.hxx>
+# include <Bnd_HArray1OfBox.hxx>
+# include <BRepBndLib.hxx>
+# include <gp_Pln.hxx>
+# include <Precision.hxx>
+# include <Standard_Failure.hxx>
+# include <TColStd_ListIteratorOfListOfInteger.hxx>
+# include <TopExp.hxx>
+#endif
+
+#include <Base/Console.h>
+
+#include "TopoShapeCache.h"
+
+FC_LOG_LEVEL_INIT("TopoShape",true,true)
+
+using namespace Part;
+
+struct TopoShapeCache::TypeData {
+    TopTools_IndexedMapOfShape shapes;
+    Handle(Bnd_HArray1OfBox) boxes;
+    Bnd_BoundSortBox index;
+    bool hasBoxes = false;
+    bool hasIndex = false;
+};
+
+static Bnd_Box _VoidBox;
+
+TopoShapeCache::TopoShapeCache(const TopoDS_Shape &shape)
+    :_Shape(shape)
+{
+}
+
+TopoShapeCache::~TopoShapeCache()
+{
+}
+
+static void addBox(const TopoDS_Shape &shape, Bnd_Box &box, bool exact)
+{
+    try {
+        // Some shapes (e.g. infinite or degenerated ones) may throw.
+        BRepBndLib::Add(shape, box);
+        // Boxes used for filtering keep the tolerance enlargement, or they
+        // would reject shapes touching the query within tolerance.
+        if(exact)
+            box.SetGap(0.0);
+        else
+            box.Enlarge(Precision::Confusion());
+    } catch (Standard_Failure &e) {
+        FC_LOG("failed to get bound box: " << e.GetMessageString());
+        box.SetVoid();
+    }
+}
+
+TopoShapeCache::TypeData &TopoShapeCache::getTypeData(TopAbs_ShapeEnum type, bool withBoxes) const
+{
+    auto &data = types[type];
+    if(!data) {
+        data.reset(new TypeData);
+        if(!_Shape.IsNull())
+            TopExp::MapShapes(_Shape, type, data->shapes);
+    }
+    if(!withBoxes || data->hasBoxes)
+        return *data;
+
+    data->hasBoxes = true;
+    int count = data->shapes.Extent();
+    if(!count)
+        return *data;
+
+    data->boxes = new Bnd_HArray1OfBox(1, count);
+    Bnd_Box enclosing;
+    for(int i=1; i<=count; ++i) {
+        Bnd_Box &box = data->boxes->ChangeValue(i);
+        addBox(data->shapes.FindKey(i), box, false);
+        enclosing.Add(box);
+    }
+    if(!enclosing.IsVoid()) {
+        enclosing.Enlarge(Precision::Confusion());
+        data->index.Initialize(enclosing, data->boxes);
+        data->hasIndex = true;
+    }
+    return *data;
+}
+
+const TopTools_IndexedMapOfShape &TopoShapeCache::getSubShapeMap(TopAbs_ShapeEnum type) const
+{
+    static const TopTools_IndexedMapOfShape _EmptyMap;
+    if(type < 0 || type >= TopAbs_SHAPE)
+        return _EmptyMap;
+    QMutexLocker lock(&mutex);
+    return getTypeData(type, false).shapes;
+}
+
+int TopoShapeCache::countSubShapes(TopAbs_ShapeEnum type) const
+{
+    return getSubShapeMap(type).Extent();
+}
+
+TopoDS_Shape TopoShapeCache::getSubShape(TopAbs_ShapeEnum type, int index) const
+{
+    const auto &shapes = getSubShapeMap(type);
+    if(index <= 0 || index > shapes.Extent())
+        return TopoDS_Shape();
+    return shapes.FindKey(index);
+}
+
+const Bnd_Box &TopoShapeCache::getBoundBox() const
+{
+    QMutexLocker lock(&mutex);
+    if(!bounds) {
+        bounds.reset(new Bnd_Box);
+        if(!_Shape.IsNull())
+            addBox(_Shape, *bounds, true);
+    }
+    return *bounds;
+}
+
+const Bnd_Box &TopoShapeCache::getSubShapeBoundBox(TopAbs_ShapeEnum type, int index) const
+{
+    if(type < 0 || type >= TopAbs_SHAPE)
+        return _VoidBox;
+    QMutexLocker lock(&mutex);
+    auto &data = getTypeData(type, true);
+    if(index <= 0 || index > data.shapes.Extent())
+        return _VoidBox;
+    return data.boxes->Value(index);
+}
+
+static std::vector<int> toIndices(const TColStd_ListOfInteger &list)
+{
+    std::vector<int> res;
+    res.reserve(list.Extent());
+    for(TColStd_ListIteratorOfListOfInteger it(list); it.More(); it.Next())
+        res.push_back(it.Value());
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+std::vector<int> TopoShapeCache::findSubShapes(TopAbs_ShapeEnum type, const Bnd_Box &box) const
+{
+    if(type < 0 || type >= TopAbs_SHAPE || box.IsVoid())
+        return std::vector<int>();
+    // Bnd_BoundSortBox::Compare() keeps its result in the object, so the
+    // lock is held for the whole query.
+    QMutexLocker lock(&mutex);
+    auto &data = getTypeData(type, true);
+    if(!data.hasIndex)
+        return std::vector<int>();
+    return toIndices(data.index.Compare(box));
+}
+
+std::vector<int> TopoShapeCache::findSubShapes(TopAbs_ShapeEnum type, const gp_Pln &plane) const
+{
+    if(type < 0 || type >= TopAbs_SHAPE)
+        return std::vector<int>();
+    QMutexLocker lock(&mutex);
+    auto &data = getTypeData(type, true);
+    if(!data.hasIndex)
+        return std::vector<int>();
+    return toIndices(data.index.Compare(plane));
+}
@@ -0,0 +1,119 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PART_TOPOSHAPECACHE_H
+#define PART_TOPOSHAPECACHE_H
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <QMutex>
+#include <Bnd_Box.hxx>
+#include <TopAbs_ShapeEnum.hxx>
+#include <TopoDS_Shape.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+class gp_Pln;
+
+namespace Part
+{
+
+/** Lazily built index of a shape
+ *
+ * The cache holds the sub-shape maps as returned by TopExp::MapShapes(), the
+ * bounding box of the shape and a bounding box index per sub-shape type for
+ * spatial queries. Each part is only built on first use. A TopoShape creates
+ * the cache on demand and shares it with its copies, see TopoShape::getCache().
+ * The cache is bound to one TopoDS_Shape and is never modified afterwards
+ * except for lazy building, which is guarded by a mutex. So it is safe to
+ * query from several threads.
+ */
+class PartExport TopoShapeCache
+{
+public:
+    explicit TopoShapeCache(const TopoDS_Shape &shape);
+    ~TopoShapeCache();
+
+    /// The shape this cache is built for
+    const TopoDS_Shape &getShape() const {
+        return _Shape;
+    }
+    /// Checks whether the cache can be used for the given shape
+    bool isValidFor(const TopoDS_Shape &shape) const {
+        return _Shape.IsEqual(shape);
+    }
+
+    /** Returns the map of all sub-shapes of the given type
+     *
+     * The indices are the same as in TopExp::MapShapes(), i.e. 1-based and
+     * matching the sub-element names, e.g. Face1. TopAbs_SHAPE is not
+     * supported and returns an empty map.
+     */
+    const TopTools_IndexedMapOfShape &getSubShapeMap(TopAbs_ShapeEnum type) const;
+    /// Returns the number of sub-shapes of the given type
+    int countSubShapes(TopAbs_ShapeEnum type) const;
+    /// Returns the sub-shape of the given type and 1-based index, or a null shape
+    TopoDS_Shape getSubShape(TopAbs_ShapeEnum type, int index) const;
+
+    /// Returns the bounding box of the shape without gap
+    const Bnd_Box &getBoundBox() const;
+    /** Returns the bounding box of the sub-shape with the 1-based index
+     *
+     * Unlike getBoundBox() the box is enlarged by the shape tolerance, at
+     * least Precision::Confusion(), so that it can be used for IsOut() tests.
+     */
+    const Bnd_Box &getSubShapeBoundBox(TopAbs_ShapeEnum type, int index) const;
+
+    /** Finds the sub-shapes whose bounding box intersects the given box
+     *
+     * @param type: sub-shape type
+     * @param box: query box
+     *
+     * @return Sorted 1-based indices of the candidate sub-shapes. This is
+     * a pre-filter, the caller still has to check the real geometry.
+     */
+    std::vector<int> findSubShapes(TopAbs_ShapeEnum type, const Bnd_Box &box) const;
+    /** Finds the sub-shapes whose bounding box intersects the given plane
+     *
+     * @param type: sub-shape type
+     * @param plane: query plane
+     *
+     * @return Sorted 1-based indices of the candidate sub-shapes.
+     */
+    std::vector<int> findSubShapes(TopAbs_ShapeEnum type, const gp_Pln &plane) const;
+
+private:
+    struct TypeData;
+    TypeData &getTypeData(TopAbs_ShapeEnum type, bool withBoxes) const;
+
+private:
+    TopoDS_Shape _Shape;
+    mutable QMutex mutex;
+    mutable std::array<std::unique_ptr<TypeData>, TopAbs_SHAPE> types;
+    mutable std::unique_ptr<Bnd_Box> bounds;
+};
+
+} //namespace Part
+
+#endif // PART_TOPOSHAPECACHE_H
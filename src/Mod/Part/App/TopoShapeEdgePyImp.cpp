@@ -800,6 +800,7 @@ void TopoShapeEdgePy::setTolerance(Py::Float tol)
     BRep_Builder aBuilder;
     const TopoDS_Edge& e = TopoDS::Edge(getTopoShapePtr()->getShape());
     aBuilder.UpdateEdge(e, (double)tol);
+    getTopoShapePtr()->resetCache();
 }
 
 Py::Float TopoShapeEdgePy::getLength(void) const
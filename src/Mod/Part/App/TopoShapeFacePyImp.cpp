@@ -941,6 +941,7 @@ void TopoShapeFacePy::setTolerance(Py::Float tol)
     BRep_Builder aBuilder;
     const TopoDS_Face& f = TopoDS::Face(getTopoShapePtr()->getShape());
     aBuilder.UpdateFace(f, (double)tol);
+    getTopoShapePtr()->resetCache();
 }
 
 Py::Tuple TopoShapeFacePy::getParameterRange(void) const
@@ -151,6 +151,7 @@ void TopoShapeVertexPy::setTolerance(Py::Float tol)
     BRep_Builder aBuilder;
     const TopoDS_Vertex& v = TopoDS::Vertex(getTopoShapePtr()->getShape());
     aBuilder.UpdateVertex(v, (double)tol);
+    getTopoShapePtr()->resetCache();
 }
 
 Py::Float TopoShapeVertexPy::getX(void) const
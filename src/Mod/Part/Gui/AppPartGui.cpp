@@ -150,6 +150,7 @@ PyMOD_INIT_FUNC(PartGui)
     PyModule_AddObject(partGuiModule, "AttachEngineResources", pAttachEngineTextsModule);
 
     PartGui::PropertyEnumAttacherItem               ::init();
+    PartGui::PropertyTessellationCache              ::init();
     PartGui::SoBrepFaceSet                          ::initClass();
     PartGui::SoBrepEdgeSet                          ::initClass();
     PartGui::SoBrepPointSet                         ::initClass();
@@ -218,15 +218,13 @@ void CrossSections::apply()
     Standard::SetReentrant(Standard_True);
     for (std::vector<App::DocumentObject*>::iterator it = obj.begin(); it != obj.end(); ++it) {
         Part::CrossSection cs(a,b,c,static_cast<Part::Feature*>(*it)->Shape.getValue());
-        QFuture< std::list<TopoDS_Wire> > future = QtConcurrent::mapped
-            (d, boost::bind(&Part::CrossSection::section, &cs, bp::_1));
-        future.waitForFinished();
-        QFuture< std::list<TopoDS_Wire> >::const_iterator ft;
+        std::vector< std::list<TopoDS_Wire> > wire_list = cs.slice(d);
+        std::vector< std::list<TopoDS_Wire> >::const_iterator ft;
         TopoDS_Compound comp;
         BRep_Builder builder;
         builder.MakeCompound(comp);
 
-        for (ft = future.begin(); ft != future.end(); ++ft) {
+        for (ft = wire_list.begin(); ft != wire_list.end(); ++ft) {
             const std::list<TopoDS_Wire>& w = *ft;
             for (std::list<TopoDS_Wire>::const_iterator wt = w.begin(); wt != w.end(); ++wt) {
                 if (!wt->IsNull())
@@ -243,33 +241,33 @@ void CrossSections::apply()
         section->purgeTouched();
     }
 #else
-    Base::SequencerLauncher seq("Cross-sections...", obj.size() * (d.size() +1));
+    Base::SequencerLauncher seq("Cross-sections...", obj.size());
     Gui::Command::runCommand(Gui::Command::App, "import Part\n");
     Gui::Command::runCommand(Gui::Command::App, "from FreeCAD import Base\n");
+
+    // Shape.slices() computes all planes of one object in a single call
+    // and slices them concurrently
+    QStringList distances;
+    for (std::vector<double>::iterator jt = d.begin(); jt != d.end(); ++jt)
+        distances << QString::number(*jt, 'g', 17);
+
     for (std::vector<App::DocumentObject*>::iterator it = obj.begin(); it != obj.end(); ++it) {
         App::Document* doc = (*it)->getDocument();
         std::string s = (*it)->getNameInDocument();
         s += "_cs";
         Gui::Command::runCommand(Gui::Command::App, QString::fromLatin1(
-            "wires=list()\n"
-            "shape=FreeCAD.getDocument(\"%1\").%2.Shape\n")
+            "shape=FreeCAD.getDocument(\"%1\").%2.Shape\n"
+            "comp=shape.slices(Base.Vector(%3,%4,%5),[%6])\n")
             .arg(QLatin1String(doc->getName()))
-            .arg(QLatin1String((*it)->getNameInDocument())).toLatin1());
-
-        for (std::vector<double>::iterator jt = d.begin(); jt != d.end(); ++jt) {
-            Gui::Command::runCommand(Gui::Command::App, QString::fromLatin1(
-                "for i in shape.slice(Base.Vector(%1,%2,%3),%4):\n"
-                "    wires.append(i)\n"
-                ).arg(a).arg(b).arg(c).arg(*jt).toLatin1());
-            seq.next();
-        }
+            .arg(QLatin1String((*it)->getNameInDocument()))
+            .arg(a).arg(b).arg(c)
+            .arg(distances.join(QLatin1String(","))).toLatin1());
 
         Gui::Command::runCommand(Gui::Command::App, QString::fromLatin1(
-            "comp=Part.Compound(wires)\n"
             "slice=FreeCAD.getDocument(\"%1\").addObject(\"Part::Feature\",\"%2\")\n"
             "slice.Shape=comp\n"
             "slice.purgeTouched()\n"
-            "del slice,comp,wires,shape")
+            "del slice,comp,shape")
             .arg(QLatin1String(doc->getName()))
             .arg(QLatin1String(s.c_str())).toLatin1());
 
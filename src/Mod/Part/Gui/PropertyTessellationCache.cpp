@@ -0,0 +1,257 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <limits>
+# include <Python.h>
+# include <TopLoc_Location.hxx>
+# include <TopoDS_Shape.hxx>
+#endif
+
+#include <Base/Exception.h>
+#include <Base/PyObjectBase.h>
+#include <Base/Reader.h>
+#include <Base/Stream.h>
+#include <Base/Writer.h>
+#include <App/Application.h>
+#include <Mod/Part/App/ShapeFingerprint.h>
+
+#include "PropertyTessellationCache.h"
+#include "ViewProviderExt.h"
+
+using namespace PartGui;
+
+namespace {
+// The counts in the file are not trusted. Memory is only reserved up to this
+// number of elements in advance, beyond that it grows with the data actually read.
+const uint32_t MaxReserve = 1 << 20;
+
+bool readVectors(Base::InputStream& str, uint32_t count, std::vector<SbVec3f>& values)
+{
+    values.reserve(std::min(count, MaxReserve));
+    float x, y, z;
+    for (uint32_t i = 0; i < count; i++) {
+        str >> x >> y >> z;
+        if (!str)
+            return false;
+        values.emplace_back(x, y, z);
+    }
+    return true;
+}
+
+bool readIndices(Base::InputStream& str, uint32_t count, std::vector<int32_t>& values)
+{
+    values.reserve(std::min(count, MaxReserve));
+    int32_t i;
+    for (uint32_t n = 0; n < count; n++) {
+        str >> i;
+        if (!str)
+            return false;
+        values.push_back(i);
+    }
+    return true;
+}
+}
+
+bool TessellationKey::operator == (const TessellationKey& key) const
+{
+    return fingerprint == key.fingerprint &&
+           deviation == key.deviation &&
+           angularDeflection == key.angularDeflection &&
+           normalsFromUV == key.normalsFromUV;
+}
+
+uint64_t TessellationKey::shapeFingerprint(const TopoDS_Shape& shape)
+{
+    if (shape.IsNull())
+        return 0;
+    return Part::shapeFingerprint(shape.Located(TopLoc_Location()));
+}
+
+// ----------------------------------------------------------------------------
+
+TYPESYSTEM_SOURCE(PartGui::PropertyTessellationCache, App::Property)
+
+PropertyTessellationCache::PropertyTessellationCache()
+{
+}
+
+PropertyTessellationCache::~PropertyTessellationCache()
+{
+}
+
+void PropertyTessellationCache::setValue()
+{
+    restored.reset();
+}
+
+std::shared_ptr<TessellationData> PropertyTessellationCache::takeRestored()
+{
+    std::shared_ptr<TessellationData> data;
+    data.swap(restored);
+    return data;
+}
+
+PyObject *PropertyTessellationCache::getPyObject(void)
+{
+    Py_Return;
+}
+
+void PropertyTessellationCache::setPyObject(PyObject *)
+{
+    throw Base::RuntimeError("Property is read-only");
+}
+
+void PropertyTessellationCache::Save (Base::Writer &writer) const
+{
+    std::string file;
+    if (!writer.isForceXML()) {
+        ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Part");
+        const ViewProviderPartExt* vp = dynamic_cast<const ViewProviderPartExt*>(getContainer());
+        if (vp && hGrp->GetBool("SaveTessellationCache", false) && vp->hasTessellation())
+            file = writer.addFile("Tessellation.bin", this);
+    }
+    if (file.empty())
+        writer.Stream() << writer.ind() << "<TessellationCache/>" << std::endl;
+    else
+        writer.Stream() << writer.ind() << "<TessellationCache file=\"" << file << "\"/>" << std::endl;
+}
+
+void PropertyTessellationCache::Restore(Base::XMLReader &reader)
+{
+    reader.readElement("TessellationCache");
+    restored.reset();
+    if (!reader.hasAttribute("file"))
+        return;
+    std::string file (reader.getAttribute("file"));
+    if (!file.empty()) {
+        // initiate a file read
+        reader.addFile(file.c_str(),this);
+    }
+}
+
+void PropertyTessellationCache::SaveDocFile (Base::Writer &writer) const
+{
+    TessellationData data;
+    const ViewProviderPartExt* vp = dynamic_cast<const ViewProviderPartExt*>(getContainer());
+    if (!vp || !vp->getTessellation(data))
+        data = TessellationData();
+
+    Base::OutputStream str(writer.Stream());
+    uint32_t version = 1;
+    str << version;
+    str << data.key.fingerprint << data.key.deviation << data.key.angularDeflection
+        << data.key.normalsFromUV;
+    str << static_cast<uint32_t>(data.verts.size()) << static_cast<uint32_t>(data.norms.size())
+        << static_cast<uint32_t>(data.index.size()) << static_cast<uint32_t>(data.parts.size())
+        << static_cast<uint32_t>(data.lines.size()) << data.startIndex;
+
+    for (const auto& v : data.verts)
+        str << v[0] << v[1] << v[2];
+    for (const auto& n : data.norms)
+        str << n[0] << n[1] << n[2];
+    for (int32_t i : data.index)
+        str << i;
+    for (int32_t i : data.parts)
+        str << i;
+    for (int32_t i : data.lines)
+        str << i;
+}
+
+void PropertyTessellationCache::RestoreDocFile(Base::Reader &reader)
+{
+    // If the data doesn't fit the cache stays empty and the shape gets tessellated again
+    restored.reset();
+
+    Base::InputStream str(reader);
+    uint32_t version = 0;
+    str >> version;
+    if (version != 1)
+        return;
+
+    std::shared_ptr<TessellationData> data = std::make_shared<TessellationData>();
+    str >> data->key.fingerprint >> data->key.deviation >> data->key.angularDeflection
+        >> data->key.normalsFromUV;
+    uint32_t numVerts=0, numNorms=0, numIndex=0, numParts=0, numLines=0;
+    str >> numVerts >> numNorms >> numIndex >> numParts >> numLines >> data->startIndex;
+    if (!str || !data->key.isValid())
+        return;
+
+    // the indices are int32 for Coin
+    const uint32_t maxCount = static_cast<uint32_t>(std::numeric_limits<int32_t>::max());
+    if (numVerts > maxCount || numNorms > numVerts || numIndex > maxCount ||
+        numParts > maxCount || numLines > maxCount)
+        return;
+
+    if (!readVectors(str, numVerts, data->verts) ||
+        !readVectors(str, numNorms, data->norms) ||
+        !readIndices(str, numIndex, data->index) ||
+        !readIndices(str, numParts, data->parts) ||
+        !readIndices(str, numLines, data->lines))
+        return;
+
+    // don't trust the file blindly, an invalid index would crash the renderer
+    int32_t maxIndex = static_cast<int32_t>(numVerts);
+    auto validIndex = [maxIndex](int32_t i) {
+        return i >= -1 && i < maxIndex;
+    };
+    if (data->startIndex < 0 || data->startIndex > maxIndex)
+        return;
+    if (!std::all_of(data->index.begin(), data->index.end(), validIndex) ||
+        !std::all_of(data->lines.begin(), data->lines.end(), validIndex))
+        return;
+    int64_t numTriangles = 0;
+    for (int32_t i : data->parts) {
+        if (i < 0)
+            return;
+        numTriangles += i;
+    }
+    if (numTriangles * 4 != static_cast<int64_t>(numIndex))
+        return;
+
+    restored = data;
+}
+
+App::Property *PropertyTessellationCache::Copy(void) const
+{
+    // the cache is bound to its view provider and never copied
+    return new PropertyTessellationCache();
+}
+
+void PropertyTessellationCache::Paste(const App::Property &)
+{
+}
+
+unsigned int PropertyTessellationCache::getMemSize (void) const
+{
+    if (!restored)
+        return 0;
+    return static_cast<unsigned int>(
+        (restored->verts.size() + restored->norms.size()) * sizeof(SbVec3f) +
+        (restored->index.size() + restored->parts.size() + restored->lines.size()) * sizeof(int32_t));
+}
@@ -0,0 +1,117 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PARTGUI_PROPERTYTESSELLATIONCACHE_H
+#define PARTGUI_PROPERTYTESSELLATIONCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <Inventor/SbVec3f.h>
+#include <App/Property.h>
+
+class TopoDS_Shape;
+
+namespace PartGui
+{
+
+/**
+ * Identifies the shape and the settings a tessellation was computed for.
+ */
+struct PartGuiExport TessellationKey
+{
+    uint64_t fingerprint = 0;
+    double deviation = 0.0;
+    double angularDeflection = 0.0;
+    bool normalsFromUV = true;
+
+    bool isValid() const {
+        return fingerprint != 0;
+    }
+    bool operator == (const TessellationKey&) const;
+    bool operator != (const TessellationKey& key) const {
+        return !(*this == key);
+    }
+
+    /** Computes a hash over the topology and the geometry of a shape, see
+     * Part::shapeFingerprint(). The placement of the shape itself is ignored.
+     * Returns 0 if the shape contains geometry that can't be hashed.
+     */
+    static uint64_t shapeFingerprint(const TopoDS_Shape&);
+};
+
+/**
+ * The arrays of the Inventor representation of a shape.
+ */
+struct PartGuiExport TessellationData
+{
+    TessellationKey key;
+    std::vector<SbVec3f> verts;
+    std::vector<SbVec3f> norms;
+    std::vector<int32_t> index;
+    std::vector<int32_t> parts;
+    std::vector<int32_t> lines;
+    int32_t startIndex = 0;
+};
+
+/**
+ * Stores the tessellation of a ViewProviderPartExt in the project file.
+ *
+ * Saving is optional and controlled by the parameter "SaveTessellationCache"
+ * of the Part module. On restore the data is kept until the view provider
+ * takes it and checks whether shape and settings still match.
+ */
+class PartGuiExport PropertyTessellationCache : public App::Property
+{
+    TYPESYSTEM_HEADER_WITH_OVERRIDE();
+
+public:
+    PropertyTessellationCache();
+    virtual ~PropertyTessellationCache();
+
+    /// Discards a restored tessellation
+    void setValue();
+    /// Returns the restored tessellation, if any, and releases it
+    std::shared_ptr<TessellationData> takeRestored();
+
+    virtual PyObject *getPyObject(void) override;
+    virtual void setPyObject(PyObject *) override;
+
+    virtual void Save (Base::Writer &writer) const override;
+    virtual void Restore(Base::XMLReader &reader) override;
+
+    virtual void SaveDocFile (Base::Writer &writer) const override;
+    virtual void RestoreDocFile(Base::Reader &reader) override;
+
+    virtual App::Property *Copy(void) const override;
+    virtual void Paste(const App::Property &from) override;
+    virtual unsigned int getMemSize (void) const override;
+
+private:
+    std::shared_ptr<TessellationData> restored;
+};
+
+} // namespace PartGui
+
+#endif // PARTGUI_PROPERTYTESSELLATIONCACHE_H
@@ -28,6 +28,7 @@
 # include <Bnd_Box.hxx>
 # include <Poly_Polygon3D.hxx>
 # include <BRepBndLib.hxx>
+# include <BRepBuilderAPI_Copy.hxx>
 # include <BRepBuilderAPI_MakeVertex.hxx>
 # include <BRepExtrema_DistShapeShape.hxx>
 # include <BRepMesh_IncrementalMesh.hxx>
@@ -97,6 +98,11 @@
 # include <QMenu>
 #endif
 
+#include <atomic>
+#include <memory>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
+
 #include <boost/algorithm/string/predicate.hpp>
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
@@ -118,6 +124,7 @@
 
 #include <Gui/ViewParams.h>
 #include "ViewProviderExt.h"
+#include "PropertyTessellationCache.h"
 #include "SoBrepPointSet.h"
 #include "SoBrepEdgeSet.h"
 #include "SoBrepFaceSet.h"
@@ -233,6 +240,7 @@ const char* ViewProviderPartExt::DrawStyleEnums[]= {"Solid","Dashed","Dotted","D
 ViewProviderPartExt::ViewProviderPartExt() 
 {
     VisualTouched = true;
+    visualValid = false;
     forceUpdateCount = 0;
     NormalsFromUV = true;
 
@@ -288,6 +296,7 @@ ViewProviderPartExt::ViewProviderPartExt()
     Lighting.setEnums(LightingEnums);
     ADD_PROPERTY_TYPE(DrawStyle,((long int)0), osgroup, App::Prop_None, "Defines the style of the edges in the 3D view.");
     DrawStyle.setEnums(DrawStyleEnums);
+    ADD_PROPERTY_TYPE(TessellationCache,(), osgroup, App::Prop_Hidden, "Tessellation stored in the project file.");
 
     coords = new SoCoordinate3();
     coords->ref();
@@ -354,6 +363,7 @@ ViewProviderPartExt::~ViewProviderPartExt()
     normb->unref();
     lineset->unref();
     nodeset->unref();
+    cancelVisualJob();
 }
 
 void ViewProviderPartExt::onChanged(const App::Property* prop)
@@ -591,7 +601,8 @@ std::vector<std::string> ViewProviderPartExt::getDisplayModes(void) const
 std::string ViewProviderPartExt::getElement(const SoDetail* detail) const
 {
     std::stringstream str;
-    if (detail) {
+    // the displayed mesh is outdated while a tessellation job is running
+    if (detail && !visualJob) {
         if (detail->getTypeId() == SoFaceDetail::getClassTypeId()) {
             const SoFaceDetail* face_detail = static_cast<const SoFaceDetail*>(detail);
             int face = face_detail->getPartIndex() + 1;
@@ -623,7 +634,7 @@ SoDetail* ViewProviderPartExt::getDetail(const char* subelement) const
     }
 
     SoDetail* detail = 0;
-    if (index < 0)
+    if (index < 0 || visualJob)
         return detail;
     if (element == "Face") {
         detail = new SoFaceDetail();
@@ -693,6 +704,10 @@ std::vector<Base::Vector3d> ViewProviderPartExt::getSelectionShape(const char* /
 
 void ViewProviderPartExt::setHighlightedFaces(const std::vector<App::Color>& colors)
 {
+    // applied again when the running tessellation job has finished
+    if (visualJob)
+        return;
+
     Gui::SoUpdateVBOAction action;
     action.apply(this->faceset);
 
@@ -935,6 +950,41 @@ void ViewProviderPartExt::reload()
         updateVisual();
 }
 
+void ViewProviderPartExt::finishRestoring()
+{
+    Gui::ViewProviderGeometryObject::finishRestoring();
+
+    // updateVisual() has been postponed until all files are read
+    if (VisualTouched && (isUpdateForced() || Visibility.getValue())) {
+        updateVisual();
+        onChanged(&DiffuseColor);
+    }
+
+    // drop a tessellation that hasn't been used
+    TessellationCache.setValue();
+}
+
+bool ViewProviderPartExt::hasTessellation() const
+{
+    return visualValid && !VisualTouched && !visualJob;
+}
+
+bool ViewProviderPartExt::getTessellation(TessellationData& data) const
+{
+    if (!hasTessellation())
+        return false;
+
+    data.key = visualKey;
+    data.key.fingerprint = TessellationKey::shapeFingerprint(Part::Feature::getShape(pcObject));
+    data.verts.assign(coords->point.getValues(0), coords->point.getValues(0) + coords->point.getNum());
+    data.norms.assign(norm->vector.getValues(0), norm->vector.getValues(0) + norm->vector.getNum());
+    data.index.assign(faceset->coordIndex.getValues(0), faceset->coordIndex.getValues(0) + faceset->coordIndex.getNum());
+    data.parts.assign(faceset->partIndex.getValues(0), faceset->partIndex.getValues(0) + faceset->partIndex.getNum());
+    data.lines.assign(lineset->coordIndex.getValues(0), lineset->coordIndex.getValues(0) + lineset->coordIndex.getNum());
+    data.startIndex = nodeset->startIndex.getValue();
+    return data.key.isValid();
+}
+
 void ViewProviderPartExt::updateData(const App::Property* prop)
 {
     const char *propName = prop->getName();
@@ -998,7 +1048,140 @@ void ViewProviderPartExt::unsetEdit(int ModNum)
     }
 }
 
+class ViewProviderPartExt::VisualJob : public TessellationData
+{
+public:
+    // set by the GUI thread when the job is superseded or the owner is destroyed
+    std::atomic<bool> cancelled{false};
+    // only accessed by the GUI thread
+    QFutureWatcher<void>* watcher = nullptr;
+    // the result filled by computeVisual() is usable
+    bool valid = false;
+};
+
 void ViewProviderPartExt::updateVisual()
+{
+    // a tessellation may still be read from the project file
+    if (isRestoring()) {
+        VisualTouched = true;
+        return;
+    }
+
+    TopoDS_Shape cShape = Part::Feature::getShape(getObject());
+
+    // any pending job is out of date now
+    cancelVisualJob();
+
+    if (cShape.IsNull()) {
+        applyVisual(TessellationData());
+        visualValid = false;
+        VisualTouched = false;
+        return;
+    }
+
+    double deviation = Deviation.getValue();
+    double angularDeflection = AngularDeflection.getValue();
+    bool normalsFromUV = NormalsFromUV;
+
+    // use the tessellation from the project file if neither shape nor settings have changed
+    std::shared_ptr<TessellationData> cached = TessellationCache.takeRestored();
+    if (cached) {
+        TessellationKey key;
+        key.deviation = deviation;
+        key.angularDeflection = angularDeflection;
+        key.normalsFromUV = normalsFromUV;
+        key.fingerprint = TessellationKey::shapeFingerprint(cShape);
+        if (cached->key == key) {
+            applyVisual(*cached);
+            visualValid = true;
+            VisualTouched = false;
+            return;
+        }
+    }
+
+    // Small shapes and forced updates are handled immediately so that callers
+    // relying on an up-to-date representation keep working.
+    bool async = false;
+    if (!isUpdateForced()) {
+        ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Part");
+        if (hGrp->GetBool("AsyncTessellation", true)) {
+            long threshold = hGrp->GetInt("AsyncTessellationFaces", 200);
+            long numFaces = 0;
+            for (TopExp_Explorer xp(cShape, TopAbs_FACE); xp.More() && numFaces < threshold; xp.Next())
+                numFaces++;
+            async = numFaces >= threshold;
+        }
+    }
+
+    if (!async) {
+        VisualJob job;
+        computeVisual(cShape, deviation, angularDeflection, normalsFromUV, job);
+        visualValid = job.valid;
+        if (job.valid)
+            applyVisual(job);
+        else
+            FC_ERR("Cannot compute Inventor representation for the shape of " << pcObject->getFullName());
+        VisualTouched = false;
+        return;
+    }
+
+    // Triangulations are stored in the (possibly shared) TShape. The job only
+    // works on its own copy of the shape, made here in the GUI thread, so it
+    // never touches a TShape that App code may be reading or meshing.
+    TopoDS_Shape copy;
+    try {
+        BRepBuilderAPI_Copy copier(cShape);
+        copy = copier.Shape();
+    }
+    catch (const Standard_Failure&) {
+        visualValid = false;
+        VisualTouched = false;
+        FC_ERR("Cannot compute Inventor representation for the shape of " << pcObject->getFullName());
+        return;
+    }
+
+    // The previous representation stays visible until the job has finished.
+    // Picking and per-face colors are suspended meanwhile because the old
+    // mesh doesn't match the faces of the new shape.
+    std::shared_ptr<VisualJob> job = std::make_shared<VisualJob>();
+    job->watcher = new QFutureWatcher<void>();
+    QObject::connect(job->watcher, &QFutureWatcher<void>::finished, job->watcher, [this, job]() {
+        job->watcher->deleteLater();
+        visualJob.reset();
+        if (job->cancelled)
+            return;
+        visualValid = job->valid;
+        if (!job->valid) {
+            FC_ERR("Cannot compute Inventor representation for the shape of " << pcObject->getFullName());
+            return;
+        }
+        applyVisual(*job);
+        // the number of faces may have changed since the colors were set
+        onChanged(&DiffuseColor);
+        if (faceset->partIndex.getNum() > pcShapeMaterial->diffuseColor.getNum())
+            pcFaceBind->value = SoMaterialBinding::OVERALL;
+    });
+    visualJob = job;
+    job->watcher->setFuture(QtConcurrent::run([=]() {
+        if (!job->cancelled)
+            computeVisual(copy, deviation, angularDeflection, normalsFromUV, *job);
+    }));
+
+    VisualTouched = false;
+}
+
+void ViewProviderPartExt::cancelVisualJob()
+{
+    if (visualJob) {
+        visualJob->cancelled = true;
+        visualJob->watcher->disconnect();
+        visualJob->watcher->deleteLater();
+        visualJob.reset();
+    }
+}
+
+void ViewProviderPartExt::applyVisual(const TessellationData& data)
 {
     Gui::SoUpdateVBOAction action;
     action.apply(this->faceset);
@@ -1015,23 +1198,42 @@ void ViewProviderPartExt::updateVisual()
     haction.apply(this->lineset);
     haction.apply(this->nodeset);
 
-    TopoDS_Shape cShape = Part::Feature::getShape(getObject());
-    if (cShape.IsNull()) {
-        coords  ->point      .setNum(0);
-        norm    ->vector     .setNum(0);
-        faceset ->coordIndex .setNum(0);
-        faceset ->partIndex  .setNum(0);
-        lineset ->coordIndex .setNum(0);
-        nodeset ->startIndex .setValue(0);
-        VisualTouched = false;
-        return;
-    }
+    // swap all fields in one go so that no inconsistent state gets rendered
+    coords  ->point      .setNum(static_cast<int>(data.verts.size()));
+    norm    ->vector     .setNum(static_cast<int>(data.norms.size()));
+    faceset ->coordIndex .setNum(static_cast<int>(data.index.size()));
+    faceset ->partIndex  .setNum(static_cast<int>(data.parts.size()));
+    lineset ->coordIndex .setNum(static_cast<int>(data.lines.size()));
+
+    std::copy(data.verts.begin(), data.verts.end(), coords->point.startEditing());
+    std::copy(data.norms.begin(), data.norms.end(), norm->vector.startEditing());
+    std::copy(data.index.begin(), data.index.end(), faceset->coordIndex.startEditing());
+    std::copy(data.parts.begin(), data.parts.end(), faceset->partIndex.startEditing());
+    std::copy(data.lines.begin(), data.lines.end(), lineset->coordIndex.startEditing());
+    nodeset ->startIndex .setValue(data.startIndex);
+
+    coords  ->point       .finishEditing();
+    norm    ->vector      .finishEditing();
+    faceset ->coordIndex  .finishEditing();
+    faceset ->partIndex   .finishEditing();
+    lineset ->coordIndex  .finishEditing();
+
+    visualKey = data.key;
+}
 
+void ViewProviderPartExt::computeVisual(TopoDS_Shape cShape, double deviation, double angularDeflection,
+                                        bool normalsFromUV, VisualJob& job)
+{
     // time measurement and book keeping
     Base::TimeInfo start_time;
     int numTriangles=0,numNodes=0,numNorms=0,numFaces=0,numEdges=0,numLines=0;
     std::set<int> faceEdges;
 
+    // the fingerprint of the shape is only computed when it's needed for saving
+    job.key.deviation = deviation;
+    job.key.angularDeflection = angularDeflection;
+    job.key.normalsFromUV = normalsFromUV;
+
     try {
         // calculating the deflection value
         Bnd_Box bounds;
@@ -1040,16 +1242,20 @@ void ViewProviderPartExt::updateVisual()
         Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
         bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
         Standard_Real deflection = ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 *
-            Deviation.getValue();
+            deviation;
 
         // create or use the mesh on the data structure
 #if OCC_VERSION_HEX >= 0x060600
-        Standard_Real AngDeflectionRads = AngularDeflection.getValue() / 180.0 * M_PI;
+        Standard_Real AngDeflectionRads = angularDeflection / 180.0 * M_PI;
         BRepMesh_IncrementalMesh(cShape,deflection,Standard_False,
                 AngDeflectionRads,Standard_True);
 #else
+        (void)angularDeflection;
         BRepMesh_IncrementalMesh(cShape,deflection);
 #endif
+        if (job.cancelled)
+            return;
+
         // We must reset the location here because the transformation data
         // are set in the placement property
         TopLoc_Location aLoc;
@@ -1112,23 +1318,21 @@ void ViewProviderPartExt::updateVisual()
         TopExp::MapShapes(cShape, TopAbs_VERTEX, vertexMap);
         numNodes += vertexMap.Extent();
 
-        // create memory for the nodes and indexes
-        coords  ->point      .setNum(numNodes);
-        norm    ->vector     .setNum(numNorms);
-        faceset ->coordIndex .setNum(numTriangles*4);
-        faceset ->partIndex  .setNum(numFaces);
-        // get the raw memory for fast fill up
-        SbVec3f* verts = coords  ->point       .startEditing();
-        SbVec3f* norms = norm    ->vector      .startEditing();
-        int32_t* index = faceset ->coordIndex  .startEditing();
-        int32_t* parts = faceset ->partIndex   .startEditing();
-
-        // preset the normal vector with null vector
-        for (int i=0;i < numNorms;i++)
-            norms[i]= SbVec3f(0.0,0.0,0.0);
+        // create memory for the nodes and indexes, the normals are preset with null vectors
+        job.verts.resize(numNodes);
+        job.norms.assign(numNorms, SbVec3f(0.0,0.0,0.0));
+        job.index.resize(numTriangles*4);
+        job.parts.resize(numFaces);
+        SbVec3f* verts = job.verts.data();
+        SbVec3f* norms = job.norms.data();
+        int32_t* index = job.index.data();
+        int32_t* parts = job.parts.data();
 
         int ii = 0,faceNodeOffset=0,faceTriaOffset=0;
         for (int i=1; i <= faceMap.Extent(); i++, ii++) {
+            if (job.cancelled)
+                return;
+
             TopLoc_Location aLoc;
             const TopoDS_Face &actFace = TopoDS::Face(faceMap(i));
             // get the mesh of the shape
@@ -1154,7 +1358,7 @@ void ViewProviderPartExt::updateVisual()
             const Poly_Array1OfTriangle& Triangles = mesh->Triangles();
             const TColgp_Array1OfPnt& Nodes = mesh->Nodes();
             TColgp_Array1OfDir Normals (Nodes.Lower(), Nodes.Upper());
-            if (NormalsFromUV)
+            if (normalsFromUV)
                 getNormals(actFace, mesh, Normals);
             
             for (int g=1;g<=nbTriInFace;g++) {
@@ -1174,7 +1378,7 @@ void ViewProviderPartExt::updateVisual()
 
                 // get the 3 normals of this triangle
                 gp_Vec NV1, NV2, NV3;
-                if (NormalsFromUV) {
+                if (normalsFromUV) {
                     NV1.SetXYZ(Normals(N1).XYZ());
                     NV2.SetXYZ(Normals(N2).XYZ());
                     NV3.SetXYZ(Normals(N3).XYZ());
@@ -1194,13 +1398,12 @@ void ViewProviderPartExt::updateVisual()
                     V1.Transform(myTransf);
                     V2.Transform(myTransf);
                     V3.Transform(myTransf);
-                    if (NormalsFromUV) {
+                    if (normalsFromUV) {
                         NV1.Transform(myTransf);
                         NV2.Transform(myTransf);
                         NV3.Transform(myTransf);
                     }
                 }
-
                 // add the normals for all points of this triangle
                 norms[faceNodeOffset+N1-1] += SbVec3f(NV1.X(),NV1.Y(),NV1.Z());
                 norms[faceNodeOffset+N2-1] += SbVec3f(NV2.X(),NV2.Y(),NV2.Z());
@@ -1300,7 +1503,7 @@ void ViewProviderPartExt::updateVisual()
             }
         }
 
-        nodeset->startIndex.setValue(faceNodeOffset);
+        job.startIndex = faceNodeOffset;
         for (int i=0; i<vertexMap.Extent(); i++) {
             const TopoDS_Vertex& aVertex = TopoDS::Vertex(vertexMap(i+1));
             gp_Pnt pnt = BRep_Tool::Pnt(aVertex);
@@ -1311,39 +1514,30 @@ void ViewProviderPartExt::updateVisual()
         for (int i = 0; i< numNorms ;i++)
             norms[i].normalize();
         
-        std::vector<int32_t> lineSetCoords;
+        job.lines.clear();
         for (std::map<int, std::vector<int32_t> >::iterator it = lineSetMap.begin(); it != lineSetMap.end(); ++it) {
-            lineSetCoords.insert(lineSetCoords.end(), it->second.begin(), it->second.end());
-            lineSetCoords.push_back(-1);
+            job.lines.insert(job.lines.end(), it->second.begin(), it->second.end());
+            job.lines.push_back(-1);
         }
-
-        // preset the index vector size
-        numLines =  lineSetCoords.size();
-        lineset ->coordIndex .setNum(numLines);
-        int32_t* lines = lineset ->coordIndex  .startEditing();
-
-        int l=0;
-        for (std::vector<int32_t>::const_iterator it=lineSetCoords.begin();it!=lineSetCoords.end();++it,l++)
-            lines[l] = *it;
-
-        // end the editing of the nodes
-        coords  ->point       .finishEditing();
-        norm    ->vector      .finishEditing();
-        faceset ->coordIndex  .finishEditing();
-        faceset ->partIndex   .finishEditing();
-        lineset ->coordIndex  .finishEditing();
+        numLines = static_cast<int>(job.lines.size());
+        job.valid = true;
     }
     catch (...) {
-        FC_ERR("Cannot compute Inventor representation for the shape of " << pcObject->getFullName());
+        job.valid = false;
+        return;
     }
 
 #   ifdef FC_DEBUG
         // printing some information
         Base::Console().Log("ViewProvider update time: %f s\n",Base::TimeInfo::diffTimeF(start_time,Base::TimeInfo()));
         Base::Console().Log("Shape tria info: Faces:%d Edges:%d Nodes:%d Triangles:%d IdxVec:%d\n",numFaces,numEdges,numNodes,numTriangles,numLines);
+#   else
+    (void)start_time;
+    (void)numEdges;
+    (void)numLines;
 #   endif
-    VisualTouched = false;
 }
+
 void ViewProviderPartExt::forceUpdate(bool enable) {
     if(enable) {
         if(++forceUpdateCount == 1) {
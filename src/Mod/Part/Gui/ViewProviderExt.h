@@ -33,7 +33,9 @@
 #include <App/PropertyUnits.h>
 #include <Gui/ViewProviderGeometryObject.h>
 #include <map>
+#include <memory>
 #include <Mod/Part/App/PartFeature.h>
+#include "PropertyTessellationCache.h"
 
 class TopoDS_Shape;
 class TopoDS_Edge;
@@ -90,6 +92,7 @@ public:
     App::PropertyColorList LineColorArray;
     // Faces (Gui::ViewProviderGeometryObject::ShapeColor and Gui::ViewProviderGeometryObject::ShapeMaterial apply)
     App::PropertyColorList DiffuseColor;
+    PropertyTessellationCache TessellationCache;
 
     virtual void attach(App::DocumentObject *) override;
     virtual void setDisplayMode(const char* ModeName) override;
@@ -97,6 +100,11 @@ public:
     virtual std::vector<std::string> getDisplayModes(void) const override;
     /// Update the view representation
     void reload();
+    virtual void finishRestoring() override;
+    /// Checks whether the Inventor representation is up to date with the shape
+    bool hasTessellation() const;
+    /// Copies the Inventor representation of the shape
+    bool getTessellation(TessellationData&) const;
     /// If no other task is pending it opens a dialog to allow to change face colors
     bool changeFaceColors();
 
@@ -157,9 +165,13 @@ protected:
     /// get called by the container whenever a property has been changed
     virtual void onChanged(const App::Property* prop) override;
     bool loadParameter();
+    /** Updates the Inventor representation of the shape.
+     * Big shapes are tessellated in a background job and the previous
+     * representation is kept until the job has finished.
+     */
     void updateVisual();
-    void getNormals(const TopoDS_Face&  theFace, const Handle(Poly_Triangulation)& aPolyTri,
-                    TColgp_Array1OfDir& theNormals);
+    static void getNormals(const TopoDS_Face&  theFace, const Handle(Poly_Triangulation)& aPolyTri,
+                           TColgp_Array1OfDir& theNormals);
 
     // nodes for the data representation
     SoMaterialBinding * pcFaceBind;
@@ -182,6 +194,16 @@ protected:
     bool NormalsFromUV;
 
 private:
+    class VisualJob;
+    static void computeVisual(TopoDS_Shape shape, double deviation, double angularDeflection,
+                              bool normalsFromUV, VisualJob& job);
+    void applyVisual(const TessellationData& data);
+    void cancelVisualJob();
+
+private:
+    std::shared_ptr<VisualJob> visualJob;
+    TessellationKey visualKey;
+    bool visualValid;
     // settings stuff
     int forceUpdateCount;
     static App::PropertyFloatConstraint::Constraints sizeRange;
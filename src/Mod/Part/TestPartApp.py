@@ -54,6 +54,45 @@ class PartTestCases(unittest.TestCase):
         #self.Doc.addObject("Part::Feature","Face").Shape = result
         #self.assertTrue(isinstance(result.Surface, Part.BSplineSurface))
 
+    def testResultCacheUndoRedo(self):
+        hGrp = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part/General")
+        cacheSize = hGrp.GetInt("ResultCacheSize", 0)
+        hGrp.SetInt("ResultCacheSize", 16)
+        try:
+            self.Doc.UndoMode = 1
+            box = self.Doc.addObject("Part::Box","Box")
+            cyl = self.Doc.addObject("Part::Cylinder","Cylinder")
+            cut = self.Doc.addObject("Part::Cut","Cut")
+            cut.Base = box
+            cut.Tool = cyl
+            self.Doc.recompute()
+            shape1 = cut.Shape
+
+            self.Doc.openTransaction("Change")
+            box.Length = 20
+            self.Doc.recompute()
+            self.Doc.commitTransaction()
+            shape2 = cut.Shape
+            self.assertFalse(shape2.isPartner(shape1))
+
+            # the inputs are built again with the same geometry but new
+            # TShapes, a hit restores the very same result shape
+            self.Doc.undo()
+            box.touch()
+            cyl.touch()
+            self.Doc.recompute()
+            self.assertEqual(box.Length, 10)
+            self.assertTrue(cut.Shape.isPartner(shape1))
+
+            self.Doc.redo()
+            box.touch()
+            cyl.touch()
+            self.Doc.recompute()
+            self.assertEqual(box.Length, 20)
+            self.assertTrue(cut.Shape.isPartner(shape2))
+        finally:
+            hGrp.SetInt("ResultCacheSize", cacheSize)
+
     def tearDown(self):
         #closing doc
         FreeCAD.closeDocument("PartTest")
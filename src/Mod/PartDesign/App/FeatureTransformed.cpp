@@ -34,6 +34,10 @@
 # include <BRepBuilderAPI_Copy.hxx>
 # include <BRepBndLib.hxx>
 # include <Bnd_Box.hxx>
+# include <TopoDS.hxx>
+# include <TopTools_ListOfShape.hxx>
+# include <TopTools_ListIteratorOfListOfShape.hxx>
+# include <memory>
 #endif
 
 
@@ -52,6 +56,7 @@
 #include <Base/Reader.h>
 #include <App/Application.h>
 #include <Mod/Part/App/modelRefine.h>
+#include <Mod/Part/App/Tools.h>
 
 using namespace PartDesign;
 
@@ -250,6 +255,10 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
     typedef std::map<App::DocumentObject*,  trsf_it> rej_it_map;
     rej_it_map nointersect_trsfms;
 
+    Base::Reference<ParameterGrp> hGrp = App::GetApplication().GetUserParameter()
+        .GetGroup("BaseApp")->GetGroup("Preferences")->GetGroup("Mod/PartDesign");
+    bool batchBoolean = hGrp->GetBool("TransformedBatchBoolean", true);
+
     // NOTE: It would be possible to build a compound from all original addShapes/subShapes and then
     // transform the compounds as a whole. But we choose to apply the transformations to each
     // Original separately. This way it is easier to discover what feature causes a fuse/cut
@@ -277,6 +286,29 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
             return new App::DocumentObjectExecReturn("Only additive and subtractive features can be transformed");
         }
 
+        // Fuse or cut all copies with one boolean. This is not done if the
+        // original has both an add and a sub shape, because then the result
+        // depends on the order in which the copies are applied. If the result
+        // is ambiguous the copies are applied one by one below.
+        bool done = false;
+        std::vector<std::size_t> rejectedIndices;
+        if (batchBoolean && fuseShape.isNull() != cutShape.isNull()) {
+            App::DocumentObjectExecReturn *ret = applyTransformations(*o,
+                    fuseShape.isNull() ? cutShape.getShape() : fuseShape.getShape(),
+                    !fuseShape.isNull(), transformations, support, rejectedIndices, done);
+            if (ret)
+                return ret;
+        }
+        if (done) {
+            for (std::vector<std::size_t>::const_iterator it = rejectedIndices.begin(); it != rejectedIndices.end(); ++it) {
+#ifdef FC_DEBUG // do not write this in release mode because a message appears already in the task view
+                Base::Console().Warning("Transformed shape does not intersect support %s: Removed\n", (*o)->getNameInDocument());
+#endif
+                nointersect_trsfms[*o].insert(transformations.begin() + *it);
+            }
+            continue;
+        }
+
         // Transform the add/subshape and collect the resulting shapes for overlap testing
         /*typedef std::vector<std::vector<gp_Trsf>::const_iterator> trsf_it_vec;
         trsf_it_vec v_transformations;
@@ -406,6 +438,131 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
     return App::DocumentObject::StdReturn;
 }
 
+App::DocumentObjectExecReturn *Transformed::applyTransformations(App::DocumentObject *original,
+        const TopoDS_Shape &tool, bool fuse, const std::vector<gp_Trsf> &transformations,
+        TopoDS_Shape &support, std::vector<std::size_t> &rejectedIndices, bool &done) const
+{
+    done = true;
+    try {
+        // The support followed by all transformed copies of the tool
+        std::vector<TopoDS_Shape> shapes;
+        shapes.reserve(transformations.size());
+        shapes.push_back(support);
+        for (std::size_t i=1; i<transformations.size(); ++i) {
+            // Make an explicit copy of the shape because the "true" parameter to BRepBuilderAPI_Transform
+            // seems to be pretty broken
+            BRepBuilderAPI_Copy copy(tool);
+            TopoDS_Shape shape = copy.Shape();
+            if (shape.IsNull())
+                return new App::DocumentObjectExecReturn("Transformed: Linked shape object is empty");
+
+            BRepBuilderAPI_Transform mkTrf(shape, transformations[i], false); // No need to copy, now
+            if (!mkTrf.IsDone())
+                return new App::DocumentObjectExecReturn("Transformation failed", original);
+            shapes.push_back(mkTrf.Shape());
+        }
+
+        // Copies whose bounding box is not connected to the support, directly
+        // or through other copies, can't intersect it. They are left out of
+        // the boolean. The support is in the first cluster.
+        std::vector< std::vector<int> > clusters = Part::clusterShapes(shapes);
+        std::vector<bool> connected(shapes.size(), false);
+        for (std::vector<int>::const_iterator it = clusters.front().begin(); it != clusters.front().end(); ++it)
+            connected[*it] = true;
+
+        TopTools_ListOfShape arguments, tools;
+        arguments.Append(support);
+        for (std::size_t i=1; i<shapes.size(); ++i) {
+            if (connected[i])
+                tools.Append(shapes[i]);
+            else if (fuse)
+                rejectedIndices.push_back(i);
+        }
+        if (tools.IsEmpty())
+            return nullptr;
+
+        std::unique_ptr<BRepAlgoAPI_BooleanOperation> mkBool;
+        if (fuse)
+            mkBool.reset(new BRepAlgoAPI_Fuse);
+        else
+            mkBool.reset(new BRepAlgoAPI_Cut);
+        mkBool->SetArguments(arguments);
+        mkBool->SetTools(tools);
+#if OCC_VERSION_HEX >= 0x070000
+        mkBool->SetRunParallel(Standard_True);
+#endif
+        mkBool->Build();
+        if (!mkBool->IsDone()) {
+            return new App::DocumentObjectExecReturn(fuse ?
+                    "Fusion with support failed" : "Cut out of support failed", original);
+        }
+
+        if (!fuse) {
+            support = mkBool->Shape();
+            return nullptr;
+        }
+
+        // Checks whether any face of the shape, or a face it was turned into,
+        // is in the given map
+        auto hasFaceIn = [&mkBool](const TopoDS_Shape &shape, const TopTools_IndexedMapOfShape &faces) {
+            for (TopExp_Explorer xp(shape, TopAbs_FACE); xp.More(); xp.Next()) {
+                if (faces.Contains(xp.Current()))
+                    return true;
+                const TopTools_ListOfShape &modified = mkBool->Modified(xp.Current());
+                for (TopTools_ListIteratorOfListOfShape it(modified); it.More(); it.Next()) {
+                    if (faces.Contains(it.Value()))
+                        return true;
+                }
+            }
+            return false;
+        };
+
+        TopTools_IndexedMapOfShape solids;
+        TopExp::MapShapes(mkBool->Shape(), TopAbs_SOLID, solids);
+        if (solids.Extent() == 0)
+            return new App::DocumentObjectExecReturn("Resulting shape is not a solid", original);
+        if (solids.Extent() == 1) {
+            support = solids(1);
+            return nullptr;
+        }
+
+        // The result solid is the one the support went into. Copies that
+        // end up in any other solid don't intersect the support. Copies
+        // that were swallowed completely don't appear at all and count as
+        // intersecting, as they do when fused one by one.
+        TopoDS_Shape solid;
+        TopTools_IndexedMapOfShape otherFaces;
+        for (int i=1; i<=solids.Extent(); ++i) {
+            TopTools_IndexedMapOfShape faces;
+            TopExp::MapShapes(solids(i), TopAbs_FACE, faces);
+            if (solid.IsNull() && hasFaceIn(support, faces))
+                solid = solids(i);
+            else
+                TopExp::MapShapes(solids(i), TopAbs_FACE, otherFaces);
+        }
+        if (solid.IsNull()) {
+            // e.g. if all faces of the support were replaced by new ones
+            rejectedIndices.clear();
+            done = false;
+            return nullptr;
+        }
+
+        for (std::size_t i=1; i<shapes.size(); ++i) {
+            if (connected[i] && hasFaceIn(shapes[i], otherFaces))
+                rejectedIndices.push_back(i);
+        }
+
+        support = solid;
+        return nullptr;
+    }
+    catch (Standard_Failure& e) {
+        std::string msg("Transformation: Intersection check failed");
+        if (e.GetMessageString() != NULL)
+            msg += std::string(": '") + e.GetMessageString() + "'";
+        return new App::DocumentObjectExecReturn(msg.c_str());
+    }
+}
+
 TopoDS_Shape Transformed::refineShapeIfActive(const TopoDS_Shape& oldShape) const
 {
     if (this->Refine.getValue()) {
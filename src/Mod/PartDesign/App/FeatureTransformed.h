@@ -92,6 +92,23 @@ protected:
     void Restore(Base::XMLReader &reader);
     virtual void positionBySupport(void);
     TopoDS_Shape refineShapeIfActive(const TopoDS_Shape&) const;
+    /** Fuses or cuts all transformed copies of one original with the support
+     * in a single boolean operation
+     * @param original the feature the tool shape comes from
+     * @param tool the add or sub shape of the original
+     * @param fuse true to fuse the copies, false to cut them
+     * @param transformations all transformations, the first (identity) one is skipped
+     * @param support the support, replaced by the result on success
+     * @param rejectedIndices receives the indices of transformations whose copy
+     * does not intersect the support
+     * @param done set to false if the result can't be told apart from the copies
+     * that don't intersect the support. The support is unchanged then and the
+     * copies have to be applied one by one.
+     * @return null on success, otherwise the error to return from execute()
+     */
+    App::DocumentObjectExecReturn *applyTransformations(App::DocumentObject *original,
+        const TopoDS_Shape &tool, bool fuse, const std::vector<gp_Trsf> &transformations,
+        TopoDS_Shape &support, std::vector<std::size_t> &rejectedIndices, bool &done) const;
     void divideTools(const std::vector<TopoDS_Shape> &toolsIn, std::vector<TopoDS_Shape> &individualsOut,
 		     TopoDS_Compound &compoundOut) const; 
 
@@ -156,9 +156,8 @@ private:
             App::DocumentObject* obj = static_cast<App::DocumentObjectPy*>(pObj)->getDocumentObjectPtr();
             if (obj->getTypeId().isDerivedFrom(Base::Type::fromName("Path::Feature"))) {
                 const Toolpath& path = static_cast<Path::Feature*>(obj)->Path.getValue();
-                std::string gcode = path.toGCode();
                 std::ofstream ofile(EncodedName.c_str());
-                ofile << gcode;
+                path.toGCode(ofile);
                 ofile.close();
             }
             else {
@@ -194,9 +193,7 @@ private:
         try {
             // read the gcode file
             std::ifstream filestr(file.filePath().c_str());
-            std::stringstream buffer;
-            buffer << filestr.rdbuf();
-            std::string gcode = buffer.str();
+            std::string gcode((std::istreambuf_iterator<char>(filestr)), std::istreambuf_iterator<char>());
             Toolpath path;
             path.setFromGCode(gcode);
             Path::Feature *object = static_cast<Path::Feature *>(pcDoc->addObject("Path::Feature",file.fileNamePure().c_str()));
@@ -3132,14 +3132,20 @@ static inline void addParameter(bool verbose, Command &cmd, const char *name,
         cmd.Parameters[name] = relative?d:next;
 }
 
-static inline void addGCode(bool verbose, Toolpath &path, const gp_Pnt &last,
+static inline void setGCode(bool verbose, Command &cmd, const gp_Pnt &last,
         const gp_Pnt &next, const char *name)
 {
-    Command cmd;
     cmd.Name = name;
     addParameter(verbose,cmd,"X",last.X(),next.X());
     addParameter(verbose,cmd,"Y",last.Y(),next.Y());
     addParameter(verbose,cmd,"Z",last.Z(),next.Z());
+}
+
+static inline void addGCode(bool verbose, Toolpath &path, const gp_Pnt &last,
+        const gp_Pnt &next, const char *name)
+{
+    Command cmd;
+    setGCode(verbose,cmd,last,next,name);
     path.addCommand(cmd);
     return;
 }
@@ -3147,12 +3153,13 @@ static inline void addGCode(bool verbose, Toolpath &path, const gp_Pnt &last,
 static inline void addG1(bool verbose,Toolpath &path, const gp_Pnt &last,
         const gp_Pnt &next, double f, double &last_f)
 {
-    addGCode(verbose,path,last,next,"G1");
+    Command cmd;
+    setGCode(verbose,cmd,last,next,"G1");
     if(f>Precision::Confusion()) {
-        Command *cmd = path.getCommands().back();
-        addParameter(verbose,*cmd,"F",last_f,f);
+        addParameter(verbose,cmd,"F",last_f,f);
         last_f = f;
     }
+    path.addCommand(cmd);
     return;
 }
 
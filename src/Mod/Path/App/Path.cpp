@@ -24,9 +24,20 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
+# include <cctype>
+# include <cmath>
+# include <cstring>
+# include <exception>
+# include <functional>
+# include <iterator>
+# include <limits>
 # include <boost/regex.hpp>
 #endif
 
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include <App/Application.h>
 #include <Base/Console.h>
 #include <Base/Exception.h>
@@ -50,11 +61,12 @@ using namespace Base;
 TYPESYSTEM_SOURCE(Path::Toolpath , Base::Persistence)
 
 Toolpath::Toolpath()
+    : unusedAxisValues(0)
 {
 }
 
 Toolpath::Toolpath(const Toolpath& otherPath)
-    : vpcCommands(otherPath.vpcCommands.size())
+    : unusedAxisValues(0)
     , center(otherPath.center)
 {
     *this = otherPath;
@@ -71,12 +83,17 @@ Toolpath &Toolpath::operator=(const Toolpath& otherPath)
     if (this == &otherPath)
         return *this;
 
-    clear();
-    vpcCommands.resize(otherPath.vpcCommands.size());
-    int i = 0;
-    for (std::vector<Command*>::const_iterator it=otherPath.vpcCommands.begin();it!=otherPath.vpcCommands.end();++it,i++) {
-        vpcCommands[i] = new Command(**it);
-    }
+    opcodes = otherPath.opcodes;
+    axisMasks = otherPath.axisMasks;
+    axisOffsets.clear();
+    axisValues.clear();
+    unusedAxisValues = 0;
+    appendAxisWords(otherPath);
+    extraWords = otherPath.extraWords;
+    opcodeNames = otherPath.opcodeNames;
+    opcodeIndex = otherPath.opcodeIndex;
+    extraNames = otherPath.extraNames;
+    extraIndex = otherPath.extraIndex;
     center = otherPath.center;
     recalculate();
     return *this;
@@ -84,16 +101,109 @@ Toolpath &Toolpath::operator=(const Toolpath& otherPath)
 
 void Toolpath::clear(void)
 {
-    for(std::vector<Command*>::iterator it = vpcCommands.begin();it!=vpcCommands.end();++it)
-        delete ( *it );
-    vpcCommands.clear();
+    opcodes.clear();
+    axisMasks.clear();
+    axisOffsets.clear();
+    axisValues.clear();
+    unusedAxisValues = 0;
+    extraWords.clear();
+    opcodeNames.clear();
+    opcodeIndex.clear();
+    extraNames.clear();
+    extraIndex.clear();
     recalculate();
 }
 
+static const char AxisLetters[] = "XYZABCFIJK";
+
+static inline int axisIndex(char c)
+{
+    switch (c) {
+        case 'X': return Toolpath::AxisX;
+        case 'Y': return Toolpath::AxisY;
+        case 'Z': return Toolpath::AxisZ;
+        case 'A': return Toolpath::AxisA;
+        case 'B': return Toolpath::AxisB;
+        case 'C': return Toolpath::AxisC;
+        case 'F': return Toolpath::AxisF;
+        case 'I': return Toolpath::AxisI;
+        case 'J': return Toolpath::AxisJ;
+        case 'K': return Toolpath::AxisK;
+        default: return -1;
+    }
+}
+
+int Toolpath::axisOf(const std::string &name)
+{
+    if (name.size() != 1)
+        return -1;
+    return axisIndex(name[0]);
+}
+
+std::uint32_t Toolpath::internOpcode(const std::string &name)
+{
+    auto res = opcodeIndex.emplace(name, static_cast<std::uint32_t>(opcodeNames.size()));
+    if (res.second)
+        opcodeNames.push_back(name);
+    return res.first->second;
+}
+
+std::uint32_t Toolpath::internExtraName(const std::string &name)
+{
+    auto res = extraIndex.emplace(name, static_cast<std::uint32_t>(extraNames.size()));
+    if (res.second)
+        extraNames.push_back(name);
+    return res.first->second;
+}
+
+std::vector<Toolpath::ExtraWord>::const_iterator Toolpath::findExtras(unsigned int pos) const
+{
+    return std::lower_bound(extraWords.begin(), extraWords.end(), pos,
+            [](const ExtraWord &word, unsigned int p) { return word.command < p; });
+}
+
+// Stores the words of Cmd for the command at pos, which must not have any
+// extra words yet. The axis words are always appended to axisValues.
+void Toolpath::setCommandWords(unsigned int pos, const Command &Cmd)
+{
+    if (axisValues.size() > std::numeric_limits<std::uint32_t>::max() - AxisCount)
+        throw Base::RuntimeError("Toolpath too large");
+
+    double axes[AxisCount];
+    std::uint16_t mask = 0;
+    auto where = extraWords.begin() + (findExtras(pos) - extraWords.begin());
+    for (std::map<std::string,double>::const_iterator it = Cmd.Parameters.begin(); it != Cmd.Parameters.end(); ++it) {
+        int axis = axisOf(it->first);
+        if (axis >= 0) {
+            axes[axis] = it->second;
+            mask |= 1 << axis;
+        } else {
+            ExtraWord word = { static_cast<std::uint32_t>(pos), internExtraName(it->first), it->second };
+            where = extraWords.insert(where, word) + 1;
+            mask |= 1 << AxisCount;
+        }
+    }
+
+    opcodes[pos] = internOpcode(Cmd.Name);
+    axisMasks[pos] = mask;
+    axisOffsets[pos] = static_cast<std::uint32_t>(axisValues.size());
+    for (int axis = 0; axis < AxisCount; ++axis) {
+        if (mask & (1 << axis))
+            axisValues.push_back(axes[axis]);
+    }
+}
+
+void Toolpath::appendCommand(const Command &Cmd)
+{
+    opcodes.push_back(0);
+    axisMasks.push_back(0);
+    axisOffsets.push_back(0);
+    setCommandWords(opcodes.size() - 1, Cmd);
+}
+
 void Toolpath::addCommand(const Command &Cmd)
 {
-    Command *tmp = new Command(Cmd);
-    vpcCommands.push_back(tmp);
+    appendCommand(Cmd);
     recalculate();
 }
 
@@ -101,9 +211,13 @@ void Toolpath::insertCommand(const Command &Cmd, int pos)
 {
     if (pos == -1) {
         addCommand(Cmd);
-    } else if (pos <= static_cast<int>(vpcCommands.size())) {
-        Command *tmp = new Command(Cmd);
-        vpcCommands.insert(vpcCommands.begin()+pos,tmp);
+    } else if (pos >= 0 && pos <= static_cast<int>(opcodes.size())) {
+        for (auto it = extraWords.begin() + (findExtras(pos) - extraWords.begin()); it != extraWords.end(); ++it)
+            ++it->command;
+        opcodes.insert(opcodes.begin() + pos, 0);
+        axisMasks.insert(axisMasks.begin() + pos, 0);
+        axisOffsets.insert(axisOffsets.begin() + pos, 0);
+        setCommandWords(pos, Cmd);
     } else {
         throw Base::IndexError("Index not in range");
     }
@@ -112,34 +226,101 @@ void Toolpath::insertCommand(const Command &Cmd, int pos)
 
 void Toolpath::deleteCommand(int pos)
 {
-    if (pos == -1) {
-        //delete(*vpcCommands.rbegin()); // causes crash
-        vpcCommands.pop_back();
-    } else if (pos <= static_cast<int>(vpcCommands.size())) {
-        vpcCommands.erase (vpcCommands.begin()+pos);
-    } else {
+    if (pos == -1)
+        pos = static_cast<int>(opcodes.size()) - 1;
+    if (pos < 0 || pos >= static_cast<int>(opcodes.size()))
         throw Base::IndexError("Index not in range");
-    }
+
+    auto first = extraWords.begin() + (findExtras(pos) - extraWords.begin());
+    auto last = first;
+    while (last != extraWords.end() && last->command == static_cast<std::uint32_t>(pos))
+        ++last;
+    for (auto it = extraWords.erase(first, last); it != extraWords.end(); ++it)
+        --it->command;
+
+    // the axis words of a command in the middle are left unused in axisValues
+    // until they make up half of it, only the words at the end are released
+    std::size_t count = countAxes(axisMasks[pos] & ((1 << AxisCount) - 1));
+    if (axisOffsets[pos] + count == axisValues.size())
+        axisValues.resize(axisOffsets[pos]);
+    else
+        unusedAxisValues += count;
+    opcodes.erase(opcodes.begin() + pos);
+    axisMasks.erase(axisMasks.begin() + pos);
+    axisOffsets.erase(axisOffsets.begin() + pos);
+    if (unusedAxisValues * 2 > axisValues.size())
+        compactAxisWords();
     recalculate();
 }
 
+Command Toolpath::getCommand(unsigned int pos) const
+{
+    Command cmd;
+    cmd.Name = getCommandName(pos);
+    std::uint16_t mask = axisMasks[pos];
+    std::size_t index = axisOffsets[pos];
+    for (int axis = 0; axis < AxisCount; ++axis) {
+        if (mask & (1 << axis))
+            cmd.Parameters[std::string(1, AxisLetters[axis])] = axisValues[index++];
+    }
+    if (mask & (1 << AxisCount)) {
+        for (auto it = findExtras(pos); it != extraWords.end() && it->command == pos; ++it)
+            cmd.Parameters[extraNames[it->name]] = it->value;
+    }
+    return cmd;
+}
+
+bool Toolpath::hasParam(unsigned int pos, const std::string &name) const
+{
+    int axis = axisOf(name);
+    if (axis >= 0)
+        return hasAxis(pos, static_cast<Axis>(axis));
+    if (!(axisMasks[pos] & (1 << AxisCount)))
+        return false;
+    auto key = extraIndex.find(name);
+    if (key == extraIndex.end())
+        return false;
+    for (auto it = findExtras(pos); it != extraWords.end() && it->command == pos; ++it) {
+        if (it->name == key->second)
+            return true;
+    }
+    return false;
+}
+
+double Toolpath::getParam(unsigned int pos, const std::string &name, double fallback) const
+{
+    int axis = axisOf(name);
+    if (axis >= 0)
+        return getAxis(pos, static_cast<Axis>(axis), fallback);
+    if (!(axisMasks[pos] & (1 << AxisCount)))
+        return fallback;
+    auto key = extraIndex.find(name);
+    if (key == extraIndex.end())
+        return fallback;
+    for (auto it = findExtras(pos); it != extraWords.end() && it->command == pos; ++it) {
+        if (it->name == key->second)
+            return it->value;
+    }
+    return fallback;
+}
+
 double Toolpath::getLength()
 {
-    if(vpcCommands.size()==0)
+    if(opcodes.size()==0)
         return 0;
     double l = 0;
     Vector3d last(0,0,0);
     Vector3d next;
-    for(std::vector<Command*>::const_iterator it = vpcCommands.begin();it!=vpcCommands.end();++it) {
-        std::string name = (*it)->Name;
-        next = (*it)->getPlacement(last).getPosition();
+    for(unsigned int i = 0; i < getSize(); ++i) {
+        const std::string &name = getCommandName(i);
+        next = Vector3d(getAxis(i, AxisX, last.x), getAxis(i, AxisY, last.y), getAxis(i, AxisZ, last.z));
         if ( (name == "G0") || (name == "G00") || (name == "G1") || (name == "G01") ) {
             // straight line
             l += (next - last).Length();
             last = next;
         } else if ( (name == "G2") || (name == "G02") || (name == "G3") || (name == "G03") ) {
             // arc
-            Vector3d center = (*it)->getCenter();
+            Vector3d center(getAxis(i, AxisI), getAxis(i, AxisJ), getAxis(i, AxisK));
             double radius = (last - center).Length();
             double angle = (next - center).GetAngle(last - center);
             l += angle * radius;
@@ -168,7 +349,7 @@ double Toolpath::getCycleTime(double hFeed, double vFeed, double hRapid, double
         vRapid = vFeed;
     }
 
-    if (vpcCommands.size() == 0) {
+    if (opcodes.size() == 0) {
         return 0;
     }
     double l = 0;
@@ -176,14 +357,14 @@ double Toolpath::getCycleTime(double hFeed, double vFeed, double hRapid, double
     bool verticalMove = false;
     Vector3d last(0,0,0);
     Vector3d next;
-    for (std::vector<Command*>::const_iterator it = vpcCommands.begin();it!=vpcCommands.end();++it) {
-        std::string name = (*it)->Name;
-        float feedrate = (*it)->getParam("F");
+    for (unsigned int i = 0; i < getSize(); ++i) {
+        const std::string &name = getCommandName(i);
+        float feedrate = getAxis(i, AxisF);
 
         l = 0;
         verticalMove = false;
         feedrate = hFeed;
-        next = (*it)->getPlacement(last).getPosition();
+        next = Vector3d(getAxis(i, AxisX, last.x), getAxis(i, AxisY, last.y), getAxis(i, AxisZ, last.z));
 
         if (last.z != next.z){
             verticalMove = true;
@@ -202,7 +383,7 @@ double Toolpath::getCycleTime(double hFeed, double vFeed, double hRapid, double
             l += (next - last).Length();
         }else if ((name == "G2") || (name == "G02") || (name == "G3") || (name == "G03") ) {
             // Arc Move
-            Vector3d center = (*it)->getCenter();
+            Vector3d center(getAxis(i, AxisI), getAxis(i, AxisJ), getAxis(i, AxisK));
             double radius = (last - center).Length();
             double angle = (next - center).GetAngle(last - center);
             l += angle * radius;
@@ -286,91 +467,514 @@ Base::BoundBox3d Toolpath::getBoundBox() const
     return visitor.bb;
 }
 
-static void bulkAddCommand(const std::string &gcodestr, std::vector<Command*> &commands, bool &inches)
+namespace {
+
+inline bool isSegmentStart(char c)
 {
-    Command *cmd = new Command();
-    cmd->setFromGCode(gcodestr);
-    if ("G20" == cmd->Name) {
-        inches = true;
-        delete cmd;
-    } else if ("G21" == cmd->Name) {
-        inches = false;
-        delete cmd;
-    } else {
-        if (inches) {
-            cmd->scaleBy(25.4);
+    return c == '(' || c == 'g' || c == 'G' || c == 'm' || c == 'M';
+}
+
+inline const char *findSegmentStart(const char *p, const char *end)
+{
+    while (p != end && !isSegmentStart(*p))
+        ++p;
+    return p;
+}
+
+inline const char *findChar(const char *p, const char *end, char c)
+{
+    const void *found = std::memchr(p, c, end - p);
+    return found ? static_cast<const char*>(found) : end;
+}
+
+// The words of one command read by Toolpath::appendGCode
+struct GCodeCommand
+{
+    std::string name;
+    std::uint16_t mask;
+    double axes[Toolpath::AxisCount];
+    std::vector<std::pair<char, double> > extras;
+
+    void setWord(char key, double value) {
+        int axis = axisIndex(key);
+        if (axis >= 0) {
+            axes[axis] = value;
+            mask |= 1 << axis;
+            return;
+        }
+        for (std::pair<char, double> &extra : extras) {
+            if (extra.first == key) {
+                extra.second = value;
+                return;
+            }
+        }
+        extras.emplace_back(key, value);
+    }
+
+    // scales the same words as Command::scaleBy
+    void scaleBy(double factor) {
+        static const int axes_scaled[] = { Toolpath::AxisX, Toolpath::AxisY, Toolpath::AxisZ,
+                                           Toolpath::AxisI, Toolpath::AxisJ, Toolpath::AxisF };
+        for (int axis : axes_scaled) {
+            if (mask & (1 << axis))
+                axes[axis] *= factor;
+        }
+        for (std::pair<char, double> &extra : extras) {
+            if (extra.first == 'R' || extra.first == 'Q')
+                extra.second *= factor;
+        }
+    }
+};
+
+// Reads one command in [begin, end) with the same rules as Command::setFromGCode,
+// value is a scratch buffer reused between calls
+void parseCommand(const char *begin, const char *end, GCodeCommand &cmd, std::string &value)
+{
+    enum { Start, CommandName, Argument, Comment } mode = Start;
+    char key = 0;
+    cmd.name.clear();
+    cmd.mask = 0;
+    cmd.extras.clear();
+    value.clear();
+    for (const char *p = begin; p != end; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (std::isdigit(c) || c == '-' || c == '.') {
+            value += *p;
+        } else if (std::isalpha(c)) {
+            if (mode == CommandName) {
+                if (!key || value.empty())
+                    throw Base::BadFormatError("Badly formatted GCode command");
+                cmd.name.assign(1, static_cast<char>(std::toupper(static_cast<unsigned char>(key))));
+                cmd.name += value;
+                value.clear();
+                mode = Argument;
+            } else if (mode == Start) {
+                mode = CommandName;
+            } else if (mode == Argument) {
+                if (!key || value.empty())
+                    throw Base::BadFormatError("Badly formatted GCode argument");
+                cmd.setWord(static_cast<char>(std::toupper(static_cast<unsigned char>(key))), std::atof(value.c_str()));
+                value.clear();
+            } else {
+                value += *p;
+            }
+            key = *p;
+        } else if (c == '(') {
+            mode = Comment;
+        } else if (c == ')') {
+            key = '(';
+            value += ')';
+        } else if (mode == Comment) {
+            // add non-ascii characters only if this is a comment
+            value += *p;
         }
-        commands.push_back(cmd);
+    }
+    if (!key || value.empty())
+        throw Base::BadFormatError("Badly formatted GCode argument");
+    if (mode == Comment) {
+        cmd.name.assign(1, key);
+        cmd.name += value;
+    } else if (mode == CommandName) {
+        cmd.name.assign(1, static_cast<char>(std::toupper(static_cast<unsigned char>(key))));
+        cmd.name += value;
+    } else {
+        cmd.setWord(static_cast<char>(std::toupper(static_cast<unsigned char>(key))), std::atof(value.c_str()));
     }
 }
 
-void Toolpath::setFromGCode(const std::string instr)
+// inputs smaller than this are read in one go
+const std::size_t GCodeChunkSize = 1 << 20;
+
+} // namespace
+
+// Appends the commands of the GCode in [begin, end), which must start at the
+// beginning of the GCode or at the beginning of a command. units is 0 for
+// millimeters, 1 for inches or -1 if not known yet, unresolved returns the
+// number of leading commands read while it was not known.
+void Toolpath::appendGCode(const char *begin, const char *end, int &units, unsigned int &unresolved)
 {
-    clear();
+    GCodeCommand cmd;
+    std::string value;
+    unresolved = 0;
 
-    // remove comments
-    //boost::regex e("\\(.*?\\)");
-    //std::string str = boost::regex_replace(instr, e, "");
-    std::string str(instr);
+    auto addSegment = [&](const char *first, const char *last) {
+        parseCommand(first, last, cmd, value);
+        if ("G20" == cmd.name) {
+            units = 1;
+            return;
+        } else if ("G21" == cmd.name) {
+            units = 0;
+            return;
+        }
+        if (units == 1)
+            cmd.scaleBy(25.4);
+        else if (units < 0)
+            ++unresolved;
+
+        if (axisValues.size() > std::numeric_limits<std::uint32_t>::max() - AxisCount)
+            throw Base::RuntimeError("Toolpath too large");
+        std::uint32_t pos = static_cast<std::uint32_t>(opcodes.size());
+        std::uint16_t mask = cmd.mask;
+        for (const std::pair<char, double> &extra : cmd.extras) {
+            ExtraWord word = { pos, internExtraName(std::string(1, extra.first)), extra.second };
+            extraWords.push_back(word);
+            mask |= 1 << AxisCount;
+        }
+        opcodes.push_back(internOpcode(cmd.name));
+        axisMasks.push_back(mask);
+        axisOffsets.push_back(static_cast<std::uint32_t>(axisValues.size()));
+        for (int axis = 0; axis < AxisCount; ++axis) {
+            if (mask & (1 << axis))
+                axisValues.push_back(cmd.axes[axis]);
+        }
+    };
 
     // split input string by () or G or M commands
-    std::string mode = "command";
-    std::size_t found = str.find_first_of("(gGmM");
-    int last = -1;
-    bool inches = false;
-    while (found != std::string::npos)
-    {
-        if (str[found] == '(') {
-            // start of comment
-            if ( (last > -1) && (mode == "command") ) {
-                // before opening a comment, add the last found command
-                std::string gcodestr = str.substr(last, found-last);
-                bulkAddCommand(gcodestr, vpcCommands, inches);
-            }
-            mode = "comment";
+    const char *last = nullptr;
+    bool comment = false;
+    const char *found = findSegmentStart(begin, end);
+    while (found != end) {
+        if (*found == '(') {
+            // start of comment, before opening it add the last found command
+            if (last)
+                addSegment(last, found);
+            comment = true;
             last = found;
-            found = str.find_first_of(')', found+1);
-        } else if (str[found] == ')') {
+            found = findChar(found + 1, end, ')');
+        } else if (*found == ')') {
             // end of comment
-            std::string gcodestr = str.substr(last, found-last+1);
-            bulkAddCommand(gcodestr, vpcCommands, inches);
-            last = -1;
-            found = str.find_first_of("(gGmM", found+1);
-            mode = "command";
-        } else if (mode == "command") {
+            addSegment(last, found + 1);
+            comment = false;
+            last = nullptr;
+            found = findSegmentStart(found + 1, end);
+        } else {
             // command
-            if (last > -1) {
-                std::string gcodestr = str.substr(last, found-last);
-                bulkAddCommand(gcodestr, vpcCommands, inches);
-            }
+            if (last)
+                addSegment(last, found);
             last = found;
-            found = str.find_first_of("(gGmM", found+1);
+            found = findSegmentStart(found + 1, end);
         }
     }
     // add the last command found, if any
-    if (last > -1) {
-        if (mode == "command") {
-            std::string gcodestr = str.substr(last,std::string::npos);
-            bulkAddCommand(gcodestr, vpcCommands, inches);
+    if (last && !comment)
+        addSegment(last, end);
+}
+
+void Toolpath::appendPath(const Toolpath &other)
+{
+    if (axisValues.size() + other.axisValues.size() > std::numeric_limits<std::uint32_t>::max() - AxisCount)
+        throw Base::RuntimeError("Toolpath too large");
+
+    std::vector<std::uint32_t> opcodeMap(other.opcodeNames.size());
+    for (std::size_t i = 0; i < opcodeMap.size(); ++i)
+        opcodeMap[i] = internOpcode(other.opcodeNames[i]);
+    std::vector<std::uint32_t> extraMap(other.extraNames.size());
+    for (std::size_t i = 0; i < extraMap.size(); ++i)
+        extraMap[i] = internExtraName(other.extraNames[i]);
+
+    std::uint32_t first = static_cast<std::uint32_t>(opcodes.size());
+    opcodes.reserve(opcodes.size() + other.opcodes.size());
+    for (std::uint32_t opcode : other.opcodes)
+        opcodes.push_back(opcodeMap[opcode]);
+    axisMasks.insert(axisMasks.end(), other.axisMasks.begin(), other.axisMasks.end());
+    appendAxisWords(other);
+    extraWords.reserve(extraWords.size() + other.extraWords.size());
+    for (const ExtraWord &word : other.extraWords) {
+        ExtraWord copy = { word.command + first, extraMap[word.name], word.value };
+        extraWords.push_back(copy);
+    }
+}
+
+// Appends the axis offsets and words of all commands of other, without the
+// words other still keeps for deleted commands.
+void Toolpath::appendAxisWords(const Toolpath &other)
+{
+    std::uint32_t valueOffset = static_cast<std::uint32_t>(axisValues.size());
+    axisOffsets.reserve(axisOffsets.size() + other.axisOffsets.size());
+    if (other.unusedAxisValues == 0) {
+        for (std::uint32_t offset : other.axisOffsets)
+            axisOffsets.push_back(offset + valueOffset);
+        axisValues.insert(axisValues.end(), other.axisValues.begin(), other.axisValues.end());
+        return;
+    }
+
+    axisValues.reserve(axisValues.size() + other.axisValues.size() - other.unusedAxisValues);
+    for (std::size_t pos = 0; pos < other.axisOffsets.size(); ++pos) {
+        auto words = other.axisValues.begin() + other.axisOffsets[pos];
+        axisOffsets.push_back(static_cast<std::uint32_t>(axisValues.size()));
+        axisValues.insert(axisValues.end(), words,
+                words + countAxes(other.axisMasks[pos] & ((1 << AxisCount) - 1)));
+    }
+}
+
+// Drops the axis words of deleted commands and stores the words in command order.
+void Toolpath::compactAxisWords()
+{
+    Toolpath packed;
+    packed.axisMasks.swap(axisMasks);
+    packed.axisOffsets.swap(axisOffsets);
+    packed.axisValues.swap(axisValues);
+    packed.unusedAxisValues = unusedAxisValues;
+    unusedAxisValues = 0;
+    appendAxisWords(packed);
+    axisMasks.swap(packed.axisMasks);
+}
+
+void Toolpath::scaleCommand(unsigned int pos, double factor)
+{
+    std::uint16_t mask = axisMasks[pos];
+    std::size_t index = axisOffsets[pos];
+    for (int axis = 0; axis < AxisCount; ++axis) {
+        if (!(mask & (1 << axis)))
+            continue;
+        switch (axis) {
+            case AxisX:
+            case AxisY:
+            case AxisZ:
+            case AxisI:
+            case AxisJ:
+            case AxisF:
+                axisValues[index] *= factor;
+                break;
+        }
+        ++index;
+    }
+    if (mask & (1 << AxisCount)) {
+        auto it = extraWords.begin() + (findExtras(pos) - extraWords.begin());
+        for (; it != extraWords.end() && it->command == pos; ++it) {
+            const std::string &name = extraNames[it->name];
+            if (name == "R" || name == "Q")
+                it->value *= factor;
+        }
+    }
+}
+
+void Toolpath::setFromGCode(const std::string &gcode)
+{
+    setFromGCode(gcode.data(), gcode.data() + gcode.size());
+}
+
+void Toolpath::setFromGCode(const char *begin, const char *end)
+{
+    clear();
+
+    std::size_t size = end - begin;
+    std::size_t count = std::min<std::size_t>(size / GCodeChunkSize,
+            4 * static_cast<std::size_t>(std::max(1, QThread::idealThreadCount())));
+    if (count <= 1) {
+        int units = 0;
+        unsigned int unresolved;
+        appendGCode(begin, end, units, unresolved);
+        recalculate();
+        return;
+    }
+
+    // Split the input in chunks starting at a command. Comments are skipped
+    // sequentially first, as a chunk must not start inside of one.
+    std::vector<const char*> bounds(1, begin);
+    const char *pos = begin;
+    for (std::size_t i = 1; i < count; ++i) {
+        const char *target = std::max(pos, begin + size * i / count);
+        for (;;) {
+            const char *open = findChar(pos, target, '(');
+            if (open == target)
+                break;
+            const char *close = findChar(open + 1, end, ')');
+            pos = close == end ? end : close + 1;
+            target = std::max(pos, target);
+        }
+        pos = findSegmentStart(target, end);
+        if (pos != bounds.back())
+            bounds.push_back(pos);
+    }
+    if (bounds.back() != end)
+        bounds.push_back(end);
+
+    // read the chunks in parallel, the units of the commands at the start of a
+    // chunk are only known once all the chunks before it are read
+    int chunks = static_cast<int>(bounds.size()) - 1;
+    std::vector<Toolpath> parts(chunks);
+    std::vector<int> units(chunks, -1);
+    std::vector<unsigned int> unresolved(chunks, 0);
+    std::vector<std::exception_ptr> errors(chunks);
+    units[0] = 0;
+    std::vector<int> indices(chunks);
+    for (int i = 0; i < chunks; ++i)
+        indices[i] = i;
+    QtConcurrent::blockingMap(indices, [&](int i) {
+        try {
+            parts[i].appendGCode(bounds[i], bounds[i + 1], units[i], unresolved[i]);
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    });
+
+    int inches = 0;
+    for (int i = 0; i < chunks; ++i) {
+        unsigned int first = getSize();
+        appendPath(parts[i]);
+        parts[i].clear();
+        if (inches) {
+            for (unsigned int j = first; j < first + unresolved[i]; ++j)
+                scaleCommand(j, 25.4);
+        }
+        if (units[i] >= 0)
+            inches = units[i];
+        if (errors[i]) {
+            recalculate();
+            std::rethrow_exception(errors[i]);
         }
     }
     recalculate();
 }
 
+namespace {
+
+void appendInteger(std::string &out, std::uint64_t value)
+{
+    char buf[20];
+    int n = 0;
+    do {
+        buf[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n)
+        out += buf[--n];
+}
+
+// Appends a word value with the same rounding as Command::toGCode
+void appendNumber(std::string &out, double value, double scale, std::int64_t iscale, int precision, bool padzero)
+{
+    std::int64_t v = static_cast<std::int64_t>(value*scale);
+    if(v<0) {
+        v = -v;
+        out += '-';
+    }
+    v+=5;
+    v /= 10;
+    appendInteger(out, v/iscale);
+    if(!precision)
+        return;
+
+    int width = precision;
+    std::int64_t digits = v%iscale;
+    if(!padzero) {
+        if(!digits)
+            return;
+        while(digits%10 == 0) {
+            digits/=10;
+            --width;
+        }
+    }
+    char buf[20];
+    for (int n = width; n > 0; --n) {
+        buf[n-1] = static_cast<char>('0' + digits%10);
+        digits /= 10;
+    }
+    out += '.';
+    out.append(buf, width);
+}
+
+// commands formatted by each task of Toolpath::emitGCode
+const unsigned int GCodeRangeSize = 16384;
+
+} // namespace
+
+// Appends the lines of the commands in [first, last) as Command::toGCode()
+// would write them, with the words sorted by name and N left out.
+void Toolpath::formatGCode(unsigned int first, unsigned int last, std::string &out) const
+{
+    static const Axis sortedAxes[AxisCount] = { AxisA, AxisB, AxisC, AxisF, AxisI, AxisJ, AxisK, AxisX, AxisY, AxisZ };
+    static const std::string axisNames[AxisCount] = { "X", "Y", "Z", "A", "B", "C", "F", "I", "J", "K" };
+    const int precision = 6;
+    const bool padzero = true;
+    const double scale = std::pow(10.0,precision+1);
+    const std::int64_t iscale = static_cast<std::int64_t>(scale)/10;
+
+    std::vector<std::pair<const std::string*, double> > words;
+    for (unsigned int pos = first; pos < last; ++pos) {
+        out += getCommandName(pos);
+        std::uint16_t mask = axisMasks[pos];
+        if (!(mask & (1 << AxisCount))) {
+            for (Axis axis : sortedAxes) {
+                if (mask & (1 << axis)) {
+                    out += ' ';
+                    out += AxisLetters[axis];
+                    appendNumber(out, getAxis(pos, axis), scale, iscale, precision, padzero);
+                }
+            }
+        } else {
+            words.clear();
+            std::size_t index = axisOffsets[pos];
+            for (int axis = 0; axis < AxisCount; ++axis) {
+                if (mask & (1 << axis))
+                    words.emplace_back(&axisNames[axis], axisValues[index++]);
+            }
+            for (auto it = findExtras(pos); it != extraWords.end() && it->command == pos; ++it) {
+                const std::string &name = extraNames[it->name];
+                if (name != "N")
+                    words.emplace_back(&name, it->value);
+            }
+            std::sort(words.begin(), words.end(),
+                    [](const std::pair<const std::string*, double> &a, const std::pair<const std::string*, double> &b) {
+                        return *a.first < *b.first;
+                    });
+            for (const std::pair<const std::string*, double> &word : words) {
+                out += ' ';
+                out += *word.first;
+                appendNumber(out, word.second, scale, iscale, precision, padzero);
+            }
+        }
+        out += '\n';
+    }
+}
+
+// Formats the commands block by block, the ranges of a block are formatted
+// concurrently and then passed to the sink in order. Only one block is held
+// in memory at a time.
+void Toolpath::emitGCode(const std::function<void(const std::string&)> &sink) const
+{
+    std::size_t size = getSize();
+    std::size_t ranges = static_cast<std::size_t>(std::max(1, QThread::idealThreadCount()));
+    std::vector<std::string> buffers(std::min(ranges, (size + GCodeRangeSize - 1) / GCodeRangeSize));
+    std::vector<int> indices;
+    for (std::size_t first = 0; first < size; first += ranges * GCodeRangeSize) {
+        int count = static_cast<int>(std::min(ranges, (size - first + GCodeRangeSize - 1) / GCodeRangeSize));
+        indices.resize(count);
+        for (int i = 0; i < count; ++i)
+            indices[i] = i;
+        QtConcurrent::blockingMap(indices, [&](int i) {
+            std::size_t begin = first + i * GCodeRangeSize;
+            std::size_t end = std::min(size, begin + GCodeRangeSize);
+            buffers[i].clear();
+            formatGCode(static_cast<unsigned int>(begin), static_cast<unsigned int>(end), buffers[i]);
+        });
+        for (int i = 0; i < count; ++i)
+            sink(buffers[i]);
+    }
+}
+
 std::string Toolpath::toGCode(void) const
 {
     std::string result;
-    for (std::vector<Command*>::const_iterator it=vpcCommands.begin();it!=vpcCommands.end();++it) {
-        result += (*it)->toGCode();
-        result += "\n";
-    }
+    emitGCode([&result](const std::string &block) {
+        result += block;
+    });
     return result;
 }
 
+void Toolpath::toGCode(std::ostream &stream) const
+{
+    emitGCode([&stream](const std::string &block) {
+        stream.write(block.data(), block.size());
+    });
+}
+
 void Toolpath::recalculate(void) // recalculates the path cache
 {
 
-    if(vpcCommands.size()==0)
+    if(opcodes.size()==0)
         return;
 
     // TODO recalculate the KDL stuff. At the moment, this is unused.
@@ -434,7 +1038,16 @@ void Toolpath::recalculate(void) // recalculates the path cache
 
 unsigned int Toolpath::getMemSize (void) const
 {
-    return toGCode().size();
+    std::size_t size = opcodes.size() * sizeof(std::uint32_t)
+        + axisMasks.size() * sizeof(std::uint16_t)
+        + axisOffsets.size() * sizeof(std::uint32_t)
+        + axisValues.size() * sizeof(double)
+        + extraWords.size() * sizeof(ExtraWord);
+    for (std::vector<std::string>::const_iterator it = opcodeNames.begin(); it != opcodeNames.end(); ++it)
+        size += it->size();
+    for (std::vector<std::string>::const_iterator it = extraNames.begin(); it != extraNames.end(); ++it)
+        size += it->size();
+    return static_cast<unsigned int>(size);
 }
 
 void Toolpath::setCenter(const Base::Vector3d &c)
@@ -455,7 +1068,7 @@ void Toolpath::Save (Writer &writer) const
         writer.incInd();
         saveCenter(writer, center);
         for(unsigned int i = 0; i < getSize(); i++) {
-            vpcCommands[i]->Save(writer);
+            getCommand(i).Save(writer);
         }
         writer.decInd();
     } else {
@@ -470,9 +1083,9 @@ void Toolpath::Save (Writer &writer) const
 
 void Toolpath::SaveDocFile (Base::Writer &writer) const
 {
-    if (toGCode().empty())
+    if (getSize() == 0)
         return;
-    writer.Stream() << toGCode();
+    toGCode(writer.Stream());
 }
 
 void Toolpath::Restore(XMLReader &reader)
@@ -488,12 +1101,7 @@ void Toolpath::Restore(XMLReader &reader)
 
 void Toolpath::RestoreDocFile(Base::Reader &reader)
 {
-    std::string gcode;
-    std::string line;
-    while (reader >> line) {
-        gcode += line;
-        gcode += " ";
-    }
+    std::string gcode((std::istreambuf_iterator<char>(reader)), std::istreambuf_iterator<char>());
     setFromGCode(gcode);
 
 }
@@ -24,6 +24,11 @@
 #ifndef PATH_Path_H
 #define PATH_Path_H
 
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <unordered_map>
+#include <vector>
 #include "Command.h"
 //#include "Mod/Robot/App/kdl_cp/path_composite.hpp"
 //#include "Mod/Robot/App/kdl_cp/frames_io.hpp"
@@ -34,7 +39,15 @@
 namespace Path
 {
 
-    /** The representation of a CNC Toolpath */
+    /** The representation of a CNC Toolpath
+     *
+     * The commands are not stored as Command objects: names are interned,
+     * the axis words X, Y, Z, A, B, C, F, I, J, K of all commands are packed
+     * in one array with a per-command mask of the words present, and the
+     * remaining words are kept in a sparse list. getCommand() rebuilds a
+     * Command when one is needed, while code walking large paths should use
+     * the direct accessors below.
+     */
     
     class PathExport Toolpath : public Base::Persistence
     {
@@ -62,14 +75,29 @@ namespace Path
             double getLength(void); // return the Length (mm) of the Path
             double getCycleTime(double, double, double, double); // return the Cycle Time (s) of the Path
             void recalculate(void); // recalculates the points
-            void setFromGCode(const std::string); // sets the path from the contents of the given GCode string
+            void setFromGCode(const std::string &gcode); // sets the path from the contents of the given GCode string
+            void setFromGCode(const char *begin, const char *end); // same, reading the given buffer in place
             std::string toGCode(void) const; // gets a gcode string representation from the Path
+            void toGCode(std::ostream &stream) const; // writes the gcode representation of the Path to a stream
             Base::BoundBox3d getBoundBox(void) const;
             
             // shortcut functions
-            unsigned int getSize(void) const { return vpcCommands.size(); }
-            const std::vector<Command*> &getCommands(void) const { return vpcCommands; }
-            const Command &getCommand(unsigned int pos)    const { return *vpcCommands[pos]; }
+            unsigned int getSize(void) const { return opcodes.size(); }
+            Command getCommand(unsigned int pos) const; // returns a copy of the command at the given position
+
+            // direct access to the stored words, names are upper case
+            enum Axis { AxisX, AxisY, AxisZ, AxisA, AxisB, AxisC, AxisF, AxisI, AxisJ, AxisK, AxisCount };
+            static int axisOf(const std::string &name); // returns the axis of a word name, or -1
+            const std::string &getCommandName(unsigned int pos) const { return opcodeNames[opcodes[pos]]; }
+            bool hasAxis(unsigned int pos, Axis axis) const { return (axisMasks[pos] & (1 << axis)) != 0; }
+            double getAxis(unsigned int pos, Axis axis, double fallback = 0.0) const {
+                std::uint16_t mask = axisMasks[pos];
+                if (!(mask & (1 << axis)))
+                    return fallback;
+                return axisValues[axisOffsets[pos] + countAxes(mask & ((1 << axis) - 1))];
+            }
+            bool hasParam(unsigned int pos, const std::string &name) const;
+            double getParam(unsigned int pos, const std::string &name, double fallback = 0.0) const;
         
             // support for rotation
             const Base::Vector3d& getCenter() const { return center; }
@@ -78,7 +106,44 @@ namespace Path
             static const int SchemaVersion = 2;
 
         protected:
-            std::vector<Command*> vpcCommands;
+            /// A word that is not an axis word, sorted by command
+            struct ExtraWord {
+                std::uint32_t command;
+                std::uint32_t name; // index in extraNames
+                double value;
+            };
+
+            static int countAxes(std::uint16_t mask) {
+                int count = 0;
+                for (; mask; mask &= mask - 1)
+                    ++count;
+                return count;
+            }
+            std::uint32_t internOpcode(const std::string &name);
+            std::uint32_t internExtraName(const std::string &name);
+            void appendCommand(const Command &Cmd); // adds a command without recalculating
+            void appendAxisWords(const Toolpath &other);
+            void compactAxisWords();
+            void setCommandWords(unsigned int pos, const Command &Cmd);
+            std::vector<ExtraWord>::const_iterator findExtras(unsigned int pos) const;
+            void appendGCode(const char *begin, const char *end, int &units, unsigned int &unresolved);
+            void appendPath(const Toolpath &other);
+            void scaleCommand(unsigned int pos, double factor);
+            void formatGCode(unsigned int first, unsigned int last, std::string &out) const;
+            void emitGCode(const std::function<void(const std::string&)> &sink) const;
+
+            // one entry per command
+            std::vector<std::uint32_t> opcodes;     // index in opcodeNames
+            std::vector<std::uint16_t> axisMasks;   // bit n set if axis n is present, bit AxisCount if extra words exist
+            std::vector<std::uint32_t> axisOffsets; // index of the first axis word in axisValues
+            // shared storage
+            std::vector<double> axisValues;
+            std::size_t unusedAxisValues; // words of deleted commands still stored in axisValues
+            std::vector<ExtraWord> extraWords;
+            std::vector<std::string> opcodeNames;
+            std::unordered_map<std::string, std::uint32_t> opcodeIndex;
+            std::vector<std::string> extraNames;
+            std::unordered_map<std::string, std::uint32_t> extraIndex;
             Base::Vector3d center;
             //KDL::Path_Composite *pcPath;
             
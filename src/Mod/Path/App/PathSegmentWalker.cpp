@@ -141,21 +141,17 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
     for (unsigned int  i = 0; i < tp.getSize(); i++) {
         std::deque<Base::Vector3d> points;
 
-        const Path::Command &cmd = tp.getCommand(i);
-        const std::string &name = cmd.Name;
-        Base::Vector3d next = cmd.getPlacement().getPosition();
-        double a = A;
-        double b = B;
-        double c = C;
+        const std::string &name = tp.getCommandName(i);
+        Base::Vector3d next(tp.getAxis(i, Toolpath::AxisX), tp.getAxis(i, Toolpath::AxisY), tp.getAxis(i, Toolpath::AxisZ));
+        double a = tp.getAxis(i, Toolpath::AxisA, A);
+        double b = tp.getAxis(i, Toolpath::AxisB, B);
+        double c = tp.getAxis(i, Toolpath::AxisC, C);
 
         if (!absolute)
             next = last + next;
-        if (!cmd.has("X")) next.x = last.x;
-        if (!cmd.has("Y")) next.y = last.y;
-        if (!cmd.has("Z")) next.z = last.z;
-        if ( cmd.has("A")) a = cmd.getValue("A");
-        if ( cmd.has("B")) b = cmd.getValue("B");
-        if ( cmd.has("C")) c = cmd.getValue("C");
+        if (!tp.hasAxis(i, Toolpath::AxisX)) next.x = last.x;
+        if (!tp.hasAxis(i, Toolpath::AxisY)) next.y = last.y;
+        if (!tp.hasAxis(i, Toolpath::AxisZ)) next.z = last.z;
 
         Base::Rotation nrot = yawPitchRoll(a, b, c);
 
@@ -206,10 +202,11 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
             else
                 norm.*pz = 1.0;
 
+            Base::Vector3d offset(tp.getAxis(i, Toolpath::AxisI), tp.getAxis(i, Toolpath::AxisJ), tp.getAxis(i, Toolpath::AxisK));
             if (absolutecenter)
-                center = cmd.getCenter();
+                center = offset;
             else
-                center = (last + cmd.getCenter());
+                center = (last + offset);
             Base::Vector3d next0(next);
             next0.*pz = 0.0;
             Base::Vector3d last0(last);
@@ -277,9 +274,9 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
 
         } else if ((name=="G81")||(name=="G82")||(name=="G83")||(name=="G84")||(name=="G85")||(name=="G86")||(name=="G89")){
             // drill,tap,bore
-            double r = 0;
-            if (cmd.has("R"))
-                r = cmd.getValue("R");
+            static const std::string R = "R";
+            static const std::string Q = "Q";
+            double r = tp.getParam(i, R);
 
             std::deque<Base::Vector3d> plist;
             std::deque<Base::Vector3d> qlist;
@@ -314,8 +311,8 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
             Base::Vector3d p2r = compensateRotation(p2, nrot, rotCenter);
 
             double q;
-            if (cmd.has("Q")) {
-                q = cmd.getValue("Q");
+            if (tp.hasParam(i, Q)) {
+                q = tp.getParam(i, Q);
                 if (q>0) {
                     Base::Vector3d temp(next);
                     for(temp.*pz=r;temp.*pz>next.*pz;temp.*pz-=q) {
@@ -55,6 +55,13 @@
 
 #include <cinttypes>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
 
 // Python
 #include <Python.h>
@@ -24,6 +24,41 @@ import FreeCAD
 import Path
 from PathTests.PathTestUtils import PathTestBase
 
+def largeGCode():
+    """Returns GCode of a few MB and the commands expected from reading it.
+    Inputs of that size are read in parallel chunks, so the switches between
+    inches and millimeters and the comments containing command letters end up
+    at chunk boundaries."""
+    lines = []
+    expected = []
+    inches = False
+    i = 0
+    while len(lines) < 150000:
+        if i % 1000 == 0:
+            inches = (i // 1000) % 2 == 1
+            lines.append('G20' if inches else 'G21')
+        scale = 25.4 if inches else 1.0
+        x = float('%.3f' % (i * 0.013 % 100))
+        y = float('%.3f' % (i * 0.007 % 50 - 25))
+        if i % 7 == 0:
+            lines.append('(pass %d G1 X%d M3)' % (i, i))
+            expected.append((lines[-1], {}))
+        if i % 13 == 0:
+            lines.append('(multi line\nG0 Z5\ncomment %d)' % i)
+            expected.append((lines[-1], {}))
+        if i % 11 == 0:
+            lines.append('M3 S%d' % (1000 + i % 5000))
+            expected.append(('M3', {'S': 1000 + i % 5000}))
+        if i % 5 == 0:
+            lines.append('G83 X%.3f Y%.3f Z-1.5 R2.5 Q0.5 F120' % (x, y))
+            expected.append(('G83', {'X': x * scale, 'Y': y * scale, 'Z': -1.5 * scale,
+                                     'R': 2.5 * scale, 'Q': 0.5 * scale, 'F': 120 * scale}))
+        else:
+            lines.append('G1X%.3fY%.3fZ-0.5F300' % (x, y))
+            expected.append(('G1', {'X': x * scale, 'Y': y * scale, 'Z': -0.5 * scale, 'F': 300 * scale}))
+        i += 1
+    return '\n'.join(lines) + '\n', expected
+
 class TestPathCore(PathTestBase):
 
     def test00(self):
@@ -164,3 +199,133 @@ G0 Z0.500000
         path = Path.Path(commands)
 
         self.assertEqual(path.Length, 2)
+
+    def test60(self):
+        """Test inserting and deleting commands with extra words"""
+        def check(path, commands):
+            self.assertEqual(str(path.Commands), str(commands))
+            self.assertEqual(path.toGCode(), ''.join(c.toGCode() + '\n' for c in commands))
+
+        commands = []
+        commands.append(Path.Command("G0", {"X":0, "Y":0, "Z":5}))
+        commands.append(Path.Command("M3", {"S":12000}))
+        commands.append(Path.Command("G83", {"X":1, "Y":2, "Z":-3, "R":1, "Q":0.5, "F":100}))
+        commands.append(Path.Command("G1", {"X":10, "Y":-3.25, "F":600}))
+        commands.append(Path.Command("M6", {"T":2}))
+        path = Path.Path(commands)
+        check(path, commands)
+
+        # the extra words (S, R, Q, T, ...) must stay with their command
+        c = Path.Command("G81", {"X":4, "Y":5, "Z":-1, "R":2, "P":0.25})
+        path.insertCommand(c, 0)
+        commands.insert(0, c)
+        check(path, commands)
+
+        c = Path.Command("M8", {"E":3, "W":1.5})
+        path.insertCommand(c, 3)
+        commands.insert(3, c)
+        check(path, commands)
+
+        c = Path.Command("G2", {"X":1, "Y":2, "I":3, "J":4, "K":5})
+        path.insertCommand(c, len(commands))
+        commands.append(c)
+        check(path, commands)
+
+        c = Path.Command("M5", {"S":0})
+        path.insertCommand(c)
+        commands.append(c)
+        check(path, commands)
+
+        path.deleteCommand(3)
+        del commands[3]
+        check(path, commands)
+
+        path.deleteCommand(0)
+        del commands[0]
+        check(path, commands)
+
+        path.deleteCommand()
+        del commands[-1]
+        check(path, commands)
+
+        path.deleteCommand(1)
+        del commands[1]
+        check(path, commands)
+
+        while commands:
+            path.deleteCommand(0)
+            del commands[0]
+            check(path, commands)
+
+    def test61(self):
+        """Test copying a path after deleting commands in the middle"""
+        commands = [Path.Command("G1", {"X":i, "Y":-i, "F":100 + i}) for i in range(50)]
+        path = Path.Path(commands)
+        for i in range(30):
+            pos = (i * 7) % (len(commands) - 1)
+            path.deleteCommand(pos)
+            del commands[pos]
+            self.assertEqual(str(path.Commands), str(commands))
+            self.assertEqual(str(path.copy().Commands), str(commands))
+
+        other = Path.Path()
+        other.addCommands(path.Commands)
+        self.assertEqual(other.toGCode(), path.toGCode())
+
+    def test70(self):
+        """Test reading GCode larger than one chunk"""
+        gcode, expected = largeGCode()
+        self.assertGreater(len(gcode), 2 << 20)
+
+        path = Path.Path()
+        path.setFromGCode(gcode)
+        commands = path.Commands
+        self.assertEqual(len(commands), len(expected))
+        for i, (cmd, (name, params)) in enumerate(zip(commands, expected)):
+            self.assertEqual(cmd.Name, name, "command %d" % i)
+            parameters = cmd.Parameters
+            self.assertEqual(sorted(parameters.keys()), sorted(params.keys()), "command %d" % i)
+            for key, value in params.items():
+                self.assertAlmostEqual(parameters[key], value, msg="command %d" % i)
+
+    def test80(self):
+        """Test writing GCode and reading it back"""
+        lines = '''G21
+(setup)
+G0 X0 Y0 Z5
+M3 S12000
+G20
+G1 X1.5 Y-0.25 F20
+G2 X2 Y0 I0.25 J0.5
+G83 X1 Y2 Z-0.1 R0.1 Q0.02 F4
+G21
+G1 A10 B20 C30 W3
+M6 T2
+'''
+
+        output = '''(setup)
+G0 X0.000000 Y0.000000 Z5.000000
+M3 S12000.000000
+G1 F508.000000 X38.100000 Y-6.350000
+G2 I6.350000 J12.700000 X50.800000 Y0.000000
+G83 F101.600000 Q0.508000 R2.540000 X25.400000 Y50.800000 Z-2.540000
+G1 A10.000000 B20.000000 C30.000000 W3.000000
+M6 T2.000000
+'''
+
+        p = Path.Path()
+        p.setFromGCode(lines)
+        self.assertEqual(p.toGCode(), output)
+        p2 = Path.Path()
+        p2.setFromGCode(p.toGCode())
+        self.assertEqual(p2.toGCode(), output)
+        self.assertEqual(str(p2.Commands), str(p.Commands))
+
+        # large paths are written in parallel blocks
+        gcode, expected = largeGCode()
+        p.setFromGCode(gcode)
+        output = p.toGCode()
+        self.assertEqual(output.count('\n'), len(expected) + sum(name.count('\n') for name, params in expected))
+        p2.setFromGCode(output)
+        self.assertEqual(p2.Size, p.Size)
+        self.assertEqual(p2.toGCode(), output)
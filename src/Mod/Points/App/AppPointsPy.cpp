@@ -122,7 +122,9 @@ private:
                     pcFeature = new Points::FeatureCustom();
                 }
 
-                pcFeature->Points.setValue(reader->getPoints());
+                PointKernel kernel;
+                reader->swapPoints(kernel);
+                pcFeature->Points.swapValue(kernel);
                 // add gray values
                 if (reader->hasIntensities()) {
                     Points::PropertyGreyValueList* prop = static_cast<Points::PropertyGreyValueList*>
@@ -165,7 +167,9 @@ private:
                 }
 
                 // delayed adding of the points feature
-                pcFeature->Points.setValue(reader->getPoints());
+                PointKernel kernel;
+                reader->swapPoints(kernel);
+                pcFeature->Points.swapValue(kernel);
                 pcDoc->addObject(pcFeature, file.fileNamePure().c_str());
                 pcDoc->recomputeFeature(pcFeature);
                 pcFeature->purgeTouched();
@@ -237,7 +241,9 @@ private:
                     pcFeature = new Points::FeatureCustom();
                 }
 
-                pcFeature->Points.setValue(reader->getPoints());
+                PointKernel kernel;
+                reader->swapPoints(kernel);
+                pcFeature->Points.swapValue(kernel);
                 // add gray values
                 if (reader->hasIntensities()) {
                     Points::PropertyGreyValueList* prop = static_cast<Points::PropertyGreyValueList*>
@@ -271,7 +277,9 @@ private:
             else {
                 Points::Feature *pcFeature = static_cast<Points::Feature*>
                     (pcDoc->addObject("Points::Feature", file.fileNamePure().c_str()));
-                pcFeature->Points.setValue(reader->getPoints());
+                PointKernel kernel;
+                reader->swapPoints(kernel);
+                pcFeature->Points.swapValue(kernel);
                 pcDoc->recomputeFeature(pcFeature);
                 pcFeature->purgeTouched();
             }
@@ -34,10 +34,12 @@
 #include <Base/Matrix.h>
 #include <Base/Persistence.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
 #include <Base/Writer.h>
 
 #include "Points.h"
 #include "PointsAlgos.h"
+#include "PointsKDTree.h"
 #include "PointsPy.h"
 
 #ifdef _WIN32
@@ -49,9 +51,25 @@ using namespace std;
 
 TYPESYSTEM_SOURCE(Points::PointKernel, Data::ComplexGeoData)
 
+namespace {
+// number of points written or read at once by SaveDocFile/RestoreDocFile
+const PointKernel::size_type BlockSize = 65536;
+
+// The blocks bypass the stream, so apply its byte order the same way
+// Base::Stream does for single values
+void swapBlock(const Base::Stream& str, std::vector<float>& block)
+{
+    if (str.byteOrder() == Base::Stream::BigEndian) {
+        for (float& f : block)
+            Base::SwapEndian<float>(f);
+    }
+}
+}
+
 PointKernel::PointKernel(const PointKernel& pts)
   : _Mtrx(pts._Mtrx)
   , _Points(pts._Points)
+  , _KDTree(std::atomic_load(&pts._KDTree))
 {
 
 }
@@ -122,13 +140,34 @@ Base::BoundBox3d PointKernel::getBoundBox(void)const
     return bnd;
 }
 
+void PointKernel::swap(PointKernel& Kernel)
+{
+    if (this != &Kernel) {
+        std::swap(this->_Mtrx, Kernel._Mtrx);
+        this->_Points.swap(Kernel._Points);
+        this->_KDTree.swap(Kernel._KDTree);
+    }
+}
+
 void PointKernel::operator = (const PointKernel& Kernel)
 {
     if (this != &Kernel) {
         // copy the mesh structure
         setTransform(Kernel._Mtrx);
         this->_Points = Kernel._Points;
+        this->_KDTree = std::atomic_load(&Kernel._KDTree);
+    }
+}
+
+std::shared_ptr<const PointsKDTree> PointKernel::getKDTree() const
+{
+    // const methods may run concurrently, the modifiers need exclusive access
+    std::shared_ptr<const PointsKDTree> tree = std::atomic_load(&_KDTree);
+    if (!tree) {
+        tree = std::make_shared<PointsKDTree>(*this);
+        std::atomic_store(&_KDTree, tree);
     }
+    return tree;
 }
 
 unsigned int PointKernel::getMemSize (void) const
@@ -179,8 +218,22 @@ void PointKernel::SaveDocFile (Base::Writer &writer) const
     uint32_t uCt = (uint32_t)size();
     str << uCt;
     // store the data without transforming it
-    for (std::vector<value_type>::const_iterator it = _Points.begin(); it != _Points.end(); ++it) {
-        str << it->x << it->y << it->z;
+    // Note: the points are written in blocks to avoid the overhead of a stream
+    // operation per coordinate for huge point clouds
+    std::vector<float> block;
+    block.reserve(3 * BlockSize);
+    for (size_type i = 0; i < size(); i += BlockSize) {
+        size_type last = std::min<size_type>(i + BlockSize, size());
+        block.clear();
+        for (size_type j = i; j < last; j++) {
+            const value_type& pnt = _Points[j];
+            block.push_back(pnt.x);
+            block.push_back(pnt.y);
+            block.push_back(pnt.z);
+        }
+        swapBlock(str, block);
+        writer.Stream().write(reinterpret_cast<const char*>(block.data()),
+                              static_cast<std::streamsize>(block.size() * sizeof(float)));
     }
 }
 
@@ -198,6 +251,7 @@ void PointKernel::Restore(Base::XMLReader &reader)
     if (reader.DocumentSchema > 3) {
         std::string Matrix (reader.getAttribute("mtrx") );
         _Mtrx.fromString(Matrix);
+        _KDTree.reset();
     }
 }
 
@@ -207,10 +261,25 @@ void PointKernel::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt = 0;
     str >> uCt;
     _Points.resize(uCt);
-    for (unsigned long i=0; i < uCt; i++) {
-        float x, y, z;
-        str >> x >> y >> z;
-        _Points[i].Set(x,y,z);
+    _KDTree.reset();
+
+    // read the data in blocks, see SaveDocFile()
+    std::vector<float> block;
+    for (size_type i = 0; i < uCt; i += BlockSize) {
+        size_type last = std::min<size_type>(i + BlockSize, uCt);
+        block.resize(3 * (last - i));
+        reader.read(reinterpret_cast<char*>(block.data()),
+                    static_cast<std::streamsize>(block.size() * sizeof(float)));
+        if (!reader) {
+            // truncated data, keep only the complete blocks
+            _Points.resize(i);
+            break;
+        }
+        swapBlock(str, block);
+        std::vector<float>::const_iterator jt = block.begin();
+        for (size_type j = i; j < last; j++, jt += 3) {
+            _Points[j].Set(jt[0], jt[1], jt[2]);
+        }
     }
 }
 
@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <iterator>
+#include <memory>
 
 #include <Base/Vector3D.h>
 #include <Base/Matrix.h>
@@ -38,6 +39,7 @@
 namespace Points
 {
 
+class PointsKDTree;
 
 /** Point kernel
  */
@@ -64,6 +66,8 @@ public:
     }
 
     void operator = (const PointKernel&);
+    /// Swaps the points and the placement with \a kernel without copying them
+    void swap(PointKernel& kernel);
 
     /** @name Subelement management */
     //@{
@@ -77,16 +81,22 @@ public:
     virtual Data::Segment* getSubElement(const char* Type, unsigned long) const;
     //@}
 
-    inline void setTransform(const Base::Matrix4D& rclTrf){_Mtrx = rclTrf;}
+    inline void setTransform(const Base::Matrix4D& rclTrf){_Mtrx = rclTrf; _KDTree.reset();}
     inline Base::Matrix4D getTransform(void) const{return _Mtrx;}
+    /// Gives write access to the points, therefore the kd-tree is dropped
     std::vector<value_type>& getBasicPoints()
-    { return this->_Points; }
+    { _KDTree.reset(); return this->_Points; }
     const std::vector<value_type>& getBasicPoints() const
     { return this->_Points; }
     void setBasicPoints(const std::vector<value_type>& pts)
-    { this->_Points = pts; }
+    { this->_Points = pts; _KDTree.reset(); }
     void swap(std::vector<value_type>& pts)
-    { this->_Points.swap(pts); }
+    { this->_Points.swap(pts); _KDTree.reset(); }
+    /** Returns the kd-tree of the points with the placement applied. It is built on
+     * first use and shared with copies of the kernel until the points or the placement
+     * are modified.
+     */
+    std::shared_ptr<const PointsKDTree> getKDTree() const;
 
     virtual void getPoints(std::vector<Base::Vector3d> &Points,
         std::vector<Base::Vector3d> &Normals,
@@ -111,19 +121,21 @@ public:
 private:
     Base::Matrix4D _Mtrx;
     std::vector<value_type> _Points;
+    mutable std::shared_ptr<const PointsKDTree> _KDTree;
 
 public:
     /// number of points stored 
     size_type size(void) const {return this->_Points.size();}
     size_type countValid(void) const;
     std::vector<value_type> getValidPoints() const;
-    void resize(size_type n){_Points.resize(n);}
+    void resize(size_type n){_Points.resize(n); _KDTree.reset();}
     void reserve(size_type n){_Points.reserve(n);}
     inline void erase(size_type first, size_type last) {
         _Points.erase(_Points.begin()+first,_Points.begin()+last);
+        _KDTree.reset();
     }
 
-    void clear(void){_Points.clear();}
+    void clear(void){_Points.clear(); _KDTree.reset();}
 
 
     /// get the points
@@ -133,10 +145,12 @@ public:
     /// set the points
     inline void setPoint(const int idx,const Base::Vector3d& point) {
         _Points[idx] = transformToInside(point);
+        _KDTree.reset();
     }
     /// insert the points
     inline void push_back(const Base::Vector3d& point) {
         _Points.push_back(transformToInside(point));
+        _KDTree.reset();
     }
 
     class PointsExport const_point_iterator
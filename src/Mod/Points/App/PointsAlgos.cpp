@@ -26,10 +26,18 @@
 #ifdef FC_OS_LINUX
 # include <unistd.h>
 #endif
+# include <algorithm>
+# include <cctype>
+# include <cerrno>
+# include <cmath>
+# include <cstdlib>
+# include <cstring>
 # include <sstream>
 #endif
 
 
+#include <QtConcurrentMap>
+
 #include "PointsAlgos.h"
 #include "Points.h"
 
@@ -39,15 +47,192 @@
 #include <Base/Console.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
 
 #include <boost/shared_ptr.hpp>
-#include <boost/regex.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/math/special_functions/fpclassify.hpp>
 
 using namespace Points;
 
+namespace {
+
+// number of bytes of ASCII point data that are read and parsed at once
+const std::size_t AsciiBlockSize = 16 * 1024 * 1024;
+// number of points or lines that are processed by one task
+const std::size_t PointsPerTask = 16 * 1024;
+// number of binary points that are read and converted at once
+const std::size_t BinaryBlockPoints = 64 * PointsPerTask;
+
+/*!
+ * \brief The AsciiBlockReader class reads a text stream in big blocks that
+ * only contain complete lines. The line breaks are replaced with null
+ * characters so that each line can be parsed independently of the others.
+ */
+class AsciiBlockReader
+{
+public:
+    explicit AsciiBlockReader(std::istream& in) : inp(in)
+    {
+    }
+    /*!
+     * Reads the next block and returns the begin of all non-blank lines.
+     * Returns false if the end of the stream is reached.
+     * The lines are valid until the next call of next().
+     */
+    bool next(std::vector<const char*>& lines)
+    {
+        lines.clear();
+        buffer.swap(rest);
+        rest.clear();
+
+        // gcount() keeps the count of the last read once the stream
+        // failed, so only use it if a read was done here
+        std::size_t offset = buffer.size();
+        std::size_t count = 0;
+        buffer.resize(offset + AsciiBlockSize);
+        if (inp) {
+            inp.read(&buffer[offset], static_cast<std::streamsize>(AsciiBlockSize));
+            count = static_cast<std::size_t>(inp.gcount());
+        }
+        buffer.resize(offset + count);
+        if (buffer.empty())
+            return false;
+
+        if (inp) {
+            // keep the incomplete last line for the next block
+            std::vector<char>::reverse_iterator it = std::find(buffer.rbegin(), buffer.rend(), '\n');
+            std::size_t pos = static_cast<std::size_t>(buffer.rend() - it);
+            rest.assign(buffer.begin() + pos, buffer.end());
+            buffer.resize(pos);
+        }
+
+        buffer.push_back('\n');
+        char* pos = buffer.data();
+        char* end = pos + buffer.size();
+        while (pos < end) {
+            char* eol = static_cast<char*>(std::memchr(pos, '\n', end - pos));
+            *eol = '\0';
+            if (!isBlank(pos))
+                lines.push_back(pos);
+            pos = eol + 1;
+        }
+
+        return true;
+    }
+
+    static bool isBlank(const char* line)
+    {
+        while (std::isspace(static_cast<unsigned char>(*line)))
+            ++line;
+        return *line == '\0';
+    }
+
+private:
+    std::istream& inp;
+    std::vector<char> buffer;
+    std::vector<char> rest;
+};
+
+/*!
+ * \brief The AsciiLineRange struct describes a range of lines that is parsed by one task.
+ */
+struct AsciiLineRange
+{
+    std::size_t index;
+    std::size_t first;
+    std::size_t last;
+
+    static std::vector<AsciiLineRange> split(std::size_t numLines)
+    {
+        std::vector<AsciiLineRange> ranges;
+        for (std::size_t first = 0; first < numLines; first += PointsPerTask) {
+            AsciiLineRange range;
+            range.index = ranges.size();
+            range.first = first;
+            range.last = std::min(first + PointsPerTask, numLines);
+            ranges.push_back(range);
+        }
+        return ranges;
+    }
+};
+
+/*!
+ * Parses up to \a num numbers from the null-terminated \a line into \a values
+ * and returns the number of parsed values. If \a end is given it points to the
+ * first unparsed character afterwards.
+ */
+std::size_t parseNumbers(const char* line, double* values, std::size_t num, const char** end = nullptr)
+{
+    std::size_t count = 0;
+    while (count < num) {
+        char* next = nullptr;
+        errno = 0;
+        double value = std::strtod(line, &next);
+        // no number or one that is out of range
+        if (next == line || (errno == ERANGE && std::fabs(value) == HUGE_VAL))
+            break;
+        values[count++] = value;
+        line = next;
+    }
+
+    if (end)
+        *end = line;
+    return count;
+}
+
+/*!
+ * Reads up to \a data.rows() lines of whitespace separated numbers with \a data.cols()
+ * columns after skipping \a offset non-blank lines. The lines are parsed in parallel.
+ * Lines with too few or unparsable numbers are skipped and \a data is shrunk to the
+ * number of valid lines.
+ */
+void readAsciiMatrix(std::istream& inp, std::size_t offset, Eigen::MatrixXd& data)
+{
+    std::size_t numPoints = static_cast<std::size_t>(data.rows());
+    std::size_t numFields = static_cast<std::size_t>(data.cols());
+
+    std::size_t row = 0;
+    AsciiBlockReader reader(inp);
+    std::vector<const char*> lines;
+    std::vector<char> valid;
+    while (row < numPoints && reader.next(lines)) {
+        std::size_t first = std::min(offset, lines.size());
+        offset -= first;
+        std::size_t count = std::min(lines.size() - first, numPoints - row);
+
+        valid.assign(count, 0);
+        std::vector<AsciiLineRange> ranges = AsciiLineRange::split(count);
+        QtConcurrent::blockingMap(ranges, [&](const AsciiLineRange& range) {
+            std::vector<double> values(numFields);
+            for (std::size_t i = range.first; i < range.last; i++) {
+                if (parseNumbers(lines[first + i], values.data(), numFields) != numFields)
+                    continue;
+                valid[i] = 1;
+                for (std::size_t col = 0; col < numFields; col++)
+                    data(row + i, col) = values[col];
+            }
+        });
+
+        // move the valid lines together
+        std::size_t next = row;
+        for (std::size_t i = 0; i < count; i++) {
+            if (!valid[i])
+                continue;
+            if (next != row + i)
+                data.row(next) = data.row(row + i);
+            ++next;
+        }
+        row = next;
+    }
+
+    if (row < numPoints)
+        data.conservativeResize(static_cast<Eigen::MatrixXd::Index>(row), data.cols());
+}
+
+}
+
 void PointsAlgos::Load(PointKernel &points, const char *FileName)
 {
     Base::FileInfo File(FileName);
@@ -64,45 +249,50 @@ void PointsAlgos::Load(PointKernel &points, const char *FileName)
 
 void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
 {
-    boost::regex rx("^\\s*([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    //boost::regex rx("(\\b[0-9]+\\.([0-9]+\\b)?|\\.[0-9]+\\b)");
-    //boost::regex rx("^\\s*(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s*$");
-    boost::cmatch what;
-
-    Base::Vector3d pt;
-    int LineCnt=0;
-    std::string line;
     Base::FileInfo fi(FileName);
+    Base::ifstream file(fi, std::ios::in | std::ios::binary);
 
-    Base::ifstream tmp_str(fi, std::ios::in);
+    // The file is read only once to support huge point clouds. To avoid frequent
+    // re-allocations the number of points is estimated from the file size.
+    file.seekg(0, std::ios::end);
+    std::streamoff fileSize = file.tellg();
+    file.seekg(0, std::ios::beg);
 
-    // estimating size
-    while (std::getline(tmp_str,line))
-        LineCnt++;
+    // a line with three coordinates has at least 20 characters in practice
+    const std::streamoff bytesPerLine = 20;
 
-    // resize the PointKernel
-    points.resize(LineCnt);
+    points.clear();
+    points.reserve(static_cast<PointKernel::size_type>(fileSize / bytesPerLine));
+    std::vector<PointKernel::value_type>& kernel = points.getBasicPoints();
 
-    Base::SequencerLauncher seq( "Loading points...", LineCnt );
-
-    // again to the beginning
-    Base::ifstream file(fi, std::ios::in);
-    LineCnt = 0;
+    Base::SequencerLauncher seq("Loading points...",
+        static_cast<size_t>(fileSize / static_cast<std::streamoff>(AsciiBlockSize) + 1));
 
     try {
-        // read file
-        while (std::getline(file, line)) {
-            if (boost::regex_match(line.c_str(), what, rx)) {
-                pt.x = std::atof(what[1].first);
-                pt.y = std::atof(what[4].first);
-                pt.z = std::atof(what[7].first);
-
-                points.setPoint(LineCnt,pt);
-                seq.next();
-                LineCnt++;
-            }
+        AsciiBlockReader reader(file);
+        std::vector<const char*> lines;
+        while (reader.next(lines)) {
+            // parse the lines of the block in parallel and append the points in file order
+            std::vector<AsciiLineRange> ranges = AsciiLineRange::split(lines.size());
+            std::vector< std::vector<PointKernel::value_type> > chunks(ranges.size());
+            QtConcurrent::blockingMap(ranges, [&lines, &chunks](const AsciiLineRange& range) {
+                std::vector<PointKernel::value_type>& chunk = chunks[range.index];
+                chunk.reserve(range.last - range.first);
+                double coords[3];
+                for (std::size_t i = range.first; i < range.last; i++) {
+                    const char* end = nullptr;
+                    // a valid line consists of exactly three numbers
+                    if (parseNumbers(lines[i], coords, 3, &end) == 3 && AsciiBlockReader::isBlank(end)) {
+                        chunk.emplace_back(static_cast<float>(coords[0]),
+                                           static_cast<float>(coords[1]),
+                                           static_cast<float>(coords[2]));
+                    }
+                }
+            });
+
+            for (std::vector< std::vector<PointKernel::value_type> >::iterator it = chunks.begin(); it != chunks.end(); ++it)
+                kernel.insert(kernel.end(), it->begin(), it->end());
+            seq.next();
         }
     }
     catch (...) {
@@ -110,11 +300,8 @@ void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
         throw Base::BadFormatError("Reading in points failed.");
     }
 
-    // now remove the last points from the kernel
-    // Note: first we allocate memory corresponding to the number of lines (points and comments)
-    //       and read in the file twice. But then the size of the kernel is too high
-    if (LineCnt < (int)points.size())
-        points.erase(LineCnt, points.size());
+    // release the memory of an overestimated reservation
+    kernel.shrink_to_fit();
 }
 
 // ----------------------------------------------------------------------------
@@ -141,6 +328,11 @@ const PointKernel& Reader::getPoints() const
     return points;
 }
 
+void Reader::swapPoints(PointKernel& kernel)
+{
+    points.swap(kernel);
+}
+
 bool Reader::hasProperties() const
 {
     return (hasIntensities() || hasColors() || hasNormals());
@@ -215,6 +407,7 @@ public:
     }
     virtual std::string toString(float) const = 0;
     virtual double toDouble(Base::InputStream&) const = 0;
+    virtual double toDouble(const char*, bool swapByteOrder) const = 0;
     virtual int getSizeOf() const = 0;
 };
 template <typename T>
@@ -233,6 +426,13 @@ public:
         str >> c;
         return static_cast<double>(c);
     }
+    virtual double toDouble(const char* data, bool swapByteOrder) const {
+        T c;
+        std::memcpy(&c, data, sizeof(T));
+        if (swapByteOrder)
+            Base::SwapEndian<T>(c);
+        return static_cast<double>(c);
+    }
     virtual int getSizeOf() const {
         return sizeof(T);
     }
@@ -240,6 +440,79 @@ public:
 
 typedef boost::shared_ptr<Converter> ConverterPtr;
 
+/// Reads \a size bytes from \a inp into \a raw
+void readRawBlock(std::istream& inp, std::size_t size, std::vector<char>& raw)
+{
+    raw.resize(size);
+    if (size == 0)
+        return;
+    inp.read(raw.data(), static_cast<std::streamsize>(size));
+    if (static_cast<std::size_t>(inp.gcount()) != size)
+        throw Base::BadFormatError("Unexpected end of binary data");
+}
+
+/// Calls \a func for the indices 0 to \a count-1 in parallel
+template <typename Func>
+void convertInParallel(std::size_t count, Func func)
+{
+    std::vector<std::size_t> tasks;
+    for (std::size_t first=0; first<count; first+=PointsPerTask)
+        tasks.push_back(first);
+    QtConcurrent::blockingMap(tasks, [&](std::size_t first) {
+        std::size_t last = std::min(first + PointsPerTask, count);
+        for (std::size_t i=first; i<last; i++)
+            func(i);
+    });
+}
+
+/*!
+ * Reads the binary records of \a data.rows() points from \a inp and converts them in
+ * parallel. The data is read in blocks of BinaryBlockPoints points so that only one
+ * block of raw data is held next to \a data. If \a transpose is true the values are
+ * stored field by field instead of point by point.
+ */
+void readBinaryMatrix(bool transpose, bool swapByteOrder, std::istream& inp,
+                      const std::vector<ConverterPtr>& converters,
+                      Eigen::MatrixXd& data)
+{
+    std::size_t numPoints = static_cast<std::size_t>(data.rows());
+    std::size_t numFields = static_cast<std::size_t>(data.cols());
+
+    std::vector<char> raw;
+    if (transpose) {
+        for (std::size_t j=0; j<numFields; j++) {
+            const Converter& converter = *converters[j];
+            std::size_t size = converter.getSizeOf();
+            for (std::size_t first=0; first<numPoints; first+=BinaryBlockPoints) {
+                std::size_t count = std::min(BinaryBlockPoints, numPoints - first);
+                readRawBlock(inp, count * size, raw);
+                convertInParallel(count, [&](std::size_t i) {
+                    data(first + i, j) = converter.toDouble(&raw[i * size], swapByteOrder);
+                });
+            }
+        }
+        return;
+    }
+
+    // byte offset of each field inside a record
+    std::vector<std::size_t> fieldOffset(numFields);
+    std::size_t recordSize = 0;
+    for (std::size_t j=0; j<numFields; j++) {
+        fieldOffset[j] = recordSize;
+        recordSize += converters[j]->getSizeOf();
+    }
+
+    for (std::size_t first=0; first<numPoints; first+=BinaryBlockPoints) {
+        std::size_t count = std::min(BinaryBlockPoints, numPoints - first);
+        readRawBlock(inp, count * recordSize, raw);
+        convertInParallel(count, [&](std::size_t i) {
+            const char* record = &raw[i * recordSize];
+            for (std::size_t j=0; j<numFields; j++)
+                data(first + i, j) = converters[j]->toDouble(record + fieldOffset[j], swapByteOrder);
+        });
+    }
+}
+
 class DataStreambuf : public std::streambuf
 {
 public:
@@ -520,6 +793,8 @@ void PlyReader::read(const std::string& filename)
     Eigen::MatrixXd data(numPoints, fields.size());
     if (format == "ascii") {
         readAscii(inp, offset, data);
+        // invalid or missing lines are dropped
+        numPoints = static_cast<std::size_t>(data.rows());
     }
     else if (format == "binary_little_endian") {
         readBinary(false, inp, offset, types, sizes, data);
@@ -823,33 +1098,7 @@ std::size_t PlyReader::readHeader(std::istream& in,
 
 void PlyReader::readAscii(std::istream& inp, std::size_t offset, Eigen::MatrixXd& data)
 {
-    std::string line;
-    std::size_t row = 0;
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-    std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
-        if (line.empty())
-            continue;
-
-        if (offset > 0) {
-            offset--;
-            continue;
-        }
-
-        // since the file is loaded in binary mode we may get the CR at the end
-        boost::trim(line);
-        boost::split(list, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-        std::istringstream str(line);
-
-        for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
-            double value = boost::lexical_cast<double>(list[col]);
-            data(row, col) = value;
-        }
-
-        ++row;
-    }
+    readAsciiMatrix(inp, offset, data);
 }
 
 void PlyReader::readBinary(bool swapByteOrder,
@@ -926,14 +1175,7 @@ void PlyReader::readBinary(bool swapByteOrder,
             throw Base::BadFormatError("File expects too many elements");
     }
 
-    Base::InputStream str(inp);
-    str.setByteOrder(swapByteOrder ? Base::Stream::BigEndian : Base::Stream::LittleEndian);
-    for (std::size_t i=0; i<numPoints; i++) {
-        for (std::size_t j=0; j<numFields; j++) {
-            double value = converters[j]->toDouble(str);
-            data(i, j) = value;
-        }
-    }
+    readBinaryMatrix(false, swapByteOrder, inp, converters, data);
 }
 
 // ----------------------------------------------------------------------------
@@ -964,6 +1206,12 @@ void PcdReader::read(const std::string& filename)
     Eigen::MatrixXd data(numPoints, fields.size());
     if (format == "ascii") {
         readAscii(inp, data);
+        // invalid or missing lines are dropped, the cloud isn't organized then any more
+        if (static_cast<std::size_t>(data.rows()) != numPoints) {
+            numPoints = static_cast<std::size_t>(data.rows());
+            this->width = static_cast<int>(numPoints);
+            this->height = 1;
+        }
     }
     else if (format == "binary") {
         readBinary(false, inp, types, sizes, data);
@@ -1185,28 +1433,7 @@ std::size_t PcdReader::readHeader(std::istream& in,
 
 void PcdReader::readAscii(std::istream& inp, Eigen::MatrixXd& data)
 {
-    std::string line;
-    std::size_t row = 0;
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-    std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
-        if (line.empty())
-            continue;
-
-        // since the file is loaded in binary mode we may get the CR at the end
-        boost::trim(line);
-        boost::split(list, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-        std::istringstream str(line);
-
-        for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
-            double value = boost::lexical_cast<double>(list[col]);
-            data(row, col) = value;
-        }
-
-        ++row;
-    }
+    readAsciiMatrix(inp, 0, data);
 }
 
 void PcdReader::readBinary(bool transpose,
@@ -1282,23 +1509,7 @@ void PcdReader::readBinary(bool transpose,
             throw Base::BadFormatError("File expects too many elements");
     }
 
-    Base::InputStream str(inp);
-    if (transpose) {
-        for (std::size_t j=0; j<numFields; j++) {
-            for (std::size_t i=0; i<numPoints; i++) {
-                double value = converters[j]->toDouble(str);
-                data(i, j) = value;
-            }
-        }
-    }
-    else {
-        for (std::size_t i=0; i<numPoints; i++) {
-            for (std::size_t j=0; j<numFields; j++) {
-                double value = converters[j]->toDouble(str);
-                data(i, j) = value;
-            }
-        }
-    }
+    readBinaryMatrix(transpose, false, inp, converters, data);
 }
 
 // ----------------------------------------------------------------------------
@@ -53,6 +53,8 @@ public:
 
     void clear();
     const PointKernel& getPoints() const;
+    /// Swaps the read points with \a kernel to avoid a deep copy of big point clouds
+    void swapPoints(PointKernel& kernel);
     bool hasProperties() const;
     const std::vector<float>& getIntensities() const;
     bool hasIntensities() const;
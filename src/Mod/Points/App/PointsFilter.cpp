@@ -0,0 +1,274 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <unordered_map>
+#endif
+
+#include <QtConcurrentMap>
+
+#include <Base/BoundBox.h>
+#include <Base/Exception.h>
+
+#include "PointsFilter.h"
+
+using namespace Points;
+
+namespace {
+
+// number of points that are handled by one task
+const std::size_t PointsPerTask = 65536;
+// number of bits of a grid index along one axis in a voxel key
+const int VoxelKeyBits = 21;
+
+bool isValid(const Base::Vector3f& p)
+{
+    return !(std::isnan(p.x) || std::isnan(p.y) || std::isnan(p.z));
+}
+
+struct VoxelSum
+{
+    double x = 0, y = 0, z = 0;
+    unsigned long count = 0;
+    long index = -1;
+};
+
+typedef std::unordered_map<uint64_t, VoxelSum> VoxelMap;
+
+// Creates the start indices of the tasks for \a numPoints points
+std::vector<std::size_t> makeTasks(std::size_t numPoints)
+{
+    std::vector<std::size_t> tasks;
+    for (std::size_t i = 0; i < numPoints; i += PointsPerTask)
+        tasks.push_back(i);
+    return tasks;
+}
+
+}
+
+VoxelGridFilter::VoxelGridFilter(double voxelSize)
+  : _voxelSize(voxelSize)
+{
+    if (!(_voxelSize > 0.0))
+        throw Base::ValueError("Voxel size must be positive");
+}
+
+VoxelGridFilter::~VoxelGridFilter()
+{
+}
+
+void VoxelGridFilter::Filter(const std::vector<Base::Vector3f>& points,
+                             std::vector<Base::Vector3f>& result) const
+{
+    std::vector<long> cells;
+    Filter(points, result, cells);
+}
+
+void VoxelGridFilter::Filter(const std::vector<Base::Vector3f>& points,
+                             std::vector<Base::Vector3f>& result,
+                             std::vector<long>& cells) const
+{
+    result.clear();
+    cells.assign(points.size(), -1);
+
+    Base::BoundBox3d box;
+    for (std::vector<Base::Vector3f>::const_iterator it = points.begin(); it != points.end(); ++it) {
+        if (isValid(*it))
+            box.Add(Base::Vector3d(it->x, it->y, it->z));
+    }
+    if (!box.IsValid())
+        return;
+
+    const double scale = 1.0 / _voxelSize;
+    const double maxCells = static_cast<double>(1 << VoxelKeyBits);
+    if (box.LengthX() * scale >= maxCells ||
+        box.LengthY() * scale >= maxCells ||
+        box.LengthZ() * scale >= maxCells)
+        throw Base::ValueError("Voxel size is too small for the extent of the points");
+
+    auto voxelKey = [&box, scale](const Base::Vector3f& p) {
+        uint64_t ix = static_cast<uint64_t>((p.x - box.MinX) * scale);
+        uint64_t iy = static_cast<uint64_t>((p.y - box.MinY) * scale);
+        uint64_t iz = static_cast<uint64_t>((p.z - box.MinZ) * scale);
+        return ix | (iy << VoxelKeyBits) | (iz << (2 * VoxelKeyBits));
+    };
+
+    // Each task sums up the points of its chunk per cell
+    std::vector<std::size_t> tasks = makeTasks(points.size());
+    std::vector<VoxelMap> sums(tasks.size());
+    QtConcurrent::blockingMap(tasks, [&](std::size_t first) {
+        std::size_t last = std::min(first + PointsPerTask, points.size());
+        VoxelMap& voxels = sums[first / PointsPerTask];
+        for (std::size_t i = first; i < last; i++) {
+            const Base::Vector3f& p = points[i];
+            if (!isValid(p))
+                continue;
+            VoxelSum& sum = voxels[voxelKey(p)];
+            sum.x += p.x;
+            sum.y += p.y;
+            sum.z += p.z;
+            sum.count++;
+        }
+    });
+
+    // merge the partial sums
+    if (sums.empty())
+        return;
+    VoxelMap& voxels = sums.front();
+    for (std::vector<VoxelMap>::iterator it = sums.begin() + 1; it != sums.end(); ++it) {
+        for (VoxelMap::iterator jt = it->begin(); jt != it->end(); ++jt) {
+            VoxelSum& sum = voxels[jt->first];
+            sum.x += jt->second.x;
+            sum.y += jt->second.y;
+            sum.z += jt->second.z;
+            sum.count += jt->second.count;
+        }
+        VoxelMap().swap(*it);
+    }
+
+    // sort by cells to get a result that doesn't depend on the hashing
+    std::vector<std::pair<uint64_t, Base::Vector3f> > centroids;
+    centroids.reserve(voxels.size());
+    for (VoxelMap::const_iterator it = voxels.begin(); it != voxels.end(); ++it) {
+        double n = static_cast<double>(it->second.count);
+        centroids.emplace_back(it->first, Base::Vector3f(static_cast<float>(it->second.x / n),
+                                                         static_cast<float>(it->second.y / n),
+                                                         static_cast<float>(it->second.z / n)));
+    }
+    std::sort(centroids.begin(), centroids.end(),
+              [](const std::pair<uint64_t, Base::Vector3f>& a, const std::pair<uint64_t, Base::Vector3f>& b) {
+        return a.first < b.first;
+    });
+
+    result.reserve(centroids.size());
+    for (std::vector<std::pair<uint64_t, Base::Vector3f> >::iterator it = centroids.begin(); it != centroids.end(); ++it) {
+        voxels[it->first].index = static_cast<long>(result.size());
+        result.push_back(it->second);
+    }
+
+    // the lookups don't modify the map and can run concurrently
+    QtConcurrent::blockingMap(tasks, [&](std::size_t first) {
+        std::size_t last = std::min(first + PointsPerTask, points.size());
+        for (std::size_t i = first; i < last; i++) {
+            if (isValid(points[i]))
+                cells[i] = voxels.find(voxelKey(points[i]))->second.index;
+        }
+    });
+}
+
+// ----------------------------------------------------------------------------
+
+OutlierFilter::OutlierFilter(const std::vector<Base::Vector3f>& points)
+  : _tree(points)
+{
+}
+
+OutlierFilter::~OutlierFilter()
+{
+}
+
+void OutlierFilter::StatisticalFilter(unsigned long k, double stdDevMult,
+                                      std::vector<unsigned long>& inliers) const
+{
+    inliers.clear();
+    if (k == 0)
+        throw Base::ValueError("Number of neighbours must be positive");
+
+    // mean distance of each point to its neighbours, NaN for invalid points
+    std::size_t numPoints = _tree.Size();
+    std::vector<double> meanDists(numPoints, std::nan(""));
+    std::vector<std::size_t> tasks = makeTasks(numPoints);
+    QtConcurrent::blockingMap(tasks, [&](std::size_t first) {
+        std::size_t last = std::min(first + PointsPerTask, numPoints);
+        std::vector<unsigned long> indices;
+        std::vector<float> dists;
+        for (std::size_t i = first; i < last; i++) {
+            const Base::Vector3f& p = _tree.GetPoint(i);
+            if (!isValid(p))
+                continue;
+            // the point itself is the first result
+            _tree.FindNearest(p, k + 1, indices, dists);
+            if (dists.size() < 2)
+                continue;
+            double sum = 0.0;
+            for (std::size_t j = 1; j < dists.size(); j++)
+                sum += dists[j];
+            meanDists[i] = sum / static_cast<double>(dists.size() - 1);
+        }
+    });
+
+    double sum = 0.0, sum2 = 0.0;
+    std::size_t count = 0;
+    for (std::vector<double>::iterator it = meanDists.begin(); it != meanDists.end(); ++it) {
+        if (!std::isnan(*it)) {
+            sum += *it;
+            sum2 += *it * *it;
+            count++;
+        }
+    }
+    if (count == 0)
+        return;
+
+    double mean = sum / count;
+    double stdDev = std::sqrt(std::max(0.0, sum2 / count - mean * mean));
+    double limit = mean + stdDevMult * stdDev;
+
+    for (std::size_t i = 0; i < numPoints; i++) {
+        if (meanDists[i] <= limit)
+            inliers.push_back(i);
+    }
+}
+
+void OutlierFilter::RadiusFilter(double radius, unsigned long minNeighbours,
+                                 std::vector<unsigned long>& inliers) const
+{
+    inliers.clear();
+    if (!(radius > 0.0))
+        throw Base::ValueError("Radius must be positive");
+
+    std::size_t numPoints = _tree.Size();
+    std::vector<char> keep(numPoints, 0);
+    std::vector<std::size_t> tasks = makeTasks(numPoints);
+    QtConcurrent::blockingMap(tasks, [&](std::size_t first) {
+        std::size_t last = std::min(first + PointsPerTask, numPoints);
+        std::vector<unsigned long> indices;
+        for (std::size_t i = first; i < last; i++) {
+            const Base::Vector3f& p = _tree.GetPoint(i);
+            if (!isValid(p))
+                continue;
+            // the point itself is part of the result
+            _tree.FindInRange(p, static_cast<float>(radius), indices);
+            if (indices.size() > minNeighbours)
+                keep[i] = 1;
+        }
+    });
+
+    for (std::size_t i = 0; i < numPoints; i++) {
+        if (keep[i])
+            inliers.push_back(i);
+    }
+}
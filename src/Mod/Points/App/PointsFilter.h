@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_FILTER_H
+#define POINTS_FILTER_H
+
+#include <vector>
+
+#include "PointsKDTree.h"
+#include <Base/Vector3D.h>
+
+namespace Points {
+
+/**
+ * The VoxelGridFilter reduces the number of points by replacing all points
+ * inside a cell of a regular grid by their centroid.
+ * The points are processed in chunks on all available cores.
+ */
+class PointsExport VoxelGridFilter
+{
+public:
+    /// Construction, \a voxelSize is the edge length of the grid cells
+    VoxelGridFilter(double voxelSize);
+    ~VoxelGridFilter();
+
+    /** Computes the centroids of all non-empty cells. Points with NaN
+     * coordinates are ignored. The result is ordered by grid cells. */
+    void Filter(const std::vector<Base::Vector3f>& points,
+                std::vector<Base::Vector3f>& result) const;
+    /** Same as above, and additionally returns for each point the index of
+     * the centroid it was merged into, or -1 if it was ignored. This allows
+     * to average per-point data like normals or colors over the cells. */
+    void Filter(const std::vector<Base::Vector3f>& points,
+                std::vector<Base::Vector3f>& result,
+                std::vector<long>& cells) const;
+
+private:
+    double _voxelSize;
+};
+
+/**
+ * The OutlierFilter detects points that are isolated from their neighbours.
+ * Both filters return the indices of the points to keep, so that per-point
+ * data like normals or colors can be filtered the same way.
+ * The neighbour searches are done in chunks on all available cores.
+ */
+class PointsExport OutlierFilter
+{
+public:
+    /// Construction
+    OutlierFilter(const std::vector<Base::Vector3f>& points);
+    ~OutlierFilter();
+
+    /** Keeps the points whose mean distance to their \a k nearest neighbours
+     * exceeds the mean over all points by at most \a stdDevMult times the
+     * standard deviation. */
+    void StatisticalFilter(unsigned long k, double stdDevMult,
+                           std::vector<unsigned long>& inliers) const;
+    /** Keeps the points with at least \a minNeighbours other points within
+     * the distance \a radius. */
+    void RadiusFilter(double radius, unsigned long minNeighbours,
+                      std::vector<unsigned long>& inliers) const;
+
+private:
+    PointsKDTree _tree;
+};
+
+} // namespace Points
+
+#endif // POINTS_FILTER_H
@@ -0,0 +1,348 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <cfloat>
+# include <climits>
+# include <cmath>
+#endif
+
+#include <QtConcurrentMap>
+
+#include <Base/BoundBox.h>
+
+#include "PointsKDTree.h"
+
+using namespace Points;
+
+namespace {
+
+// maximum number of points in a leaf of the tree
+const unsigned long MaxLeafSize = 16;
+// number of queries that are handled by one task of a batch search
+const unsigned long QueriesPerTask = 1024;
+
+/*
+ * Collects the k nearest points of a query point in a max-heap of squared
+ * distances so that the current search radius is always at the front.
+ */
+class NearestVisitor
+{
+public:
+    explicit NearestVisitor(unsigned long k) : k(k)
+    {
+        heap.reserve(k);
+    }
+    float radius2() const
+    {
+        return heap.size() < k ? FLT_MAX : heap.front().first;
+    }
+    void add(float dist2, unsigned long index)
+    {
+        if (heap.size() < k) {
+            heap.emplace_back(dist2, index);
+            std::push_heap(heap.begin(), heap.end());
+        }
+        else if (dist2 < heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = std::make_pair(dist2, index);
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+    void result(std::vector<unsigned long>& indices, std::vector<float>& dists)
+    {
+        std::sort_heap(heap.begin(), heap.end());
+        indices.clear();
+        dists.clear();
+        for (std::vector<std::pair<float, unsigned long> >::iterator it = heap.begin(); it != heap.end(); ++it) {
+            indices.push_back(it->second);
+            dists.push_back(std::sqrt(it->first));
+        }
+    }
+
+private:
+    unsigned long k;
+    std::vector<std::pair<float, unsigned long> > heap;
+};
+
+/*
+ * Collects all points within a fixed radius of a query point.
+ */
+class RangeVisitor
+{
+public:
+    explicit RangeVisitor(float radius) : r2(radius * radius)
+    {
+    }
+    float radius2() const
+    {
+        return r2;
+    }
+    void add(float dist2, unsigned long index)
+    {
+        found.emplace_back(dist2, index);
+    }
+    void result(std::vector<unsigned long>& indices)
+    {
+        std::sort(found.begin(), found.end());
+        indices.clear();
+        indices.reserve(found.size());
+        for (std::vector<std::pair<float, unsigned long> >::iterator it = found.begin(); it != found.end(); ++it)
+            indices.push_back(it->second);
+    }
+
+private:
+    float r2;
+    std::vector<std::pair<float, unsigned long> > found;
+};
+
+}
+
+PointsKDTree::PointsKDTree()
+{
+}
+
+PointsKDTree::PointsKDTree(const PointKernel& kernel)
+{
+    Build(kernel);
+}
+
+PointsKDTree::PointsKDTree(const std::vector<Base::Vector3f>& points)
+{
+    Build(points);
+}
+
+PointsKDTree::~PointsKDTree()
+{
+}
+
+void PointsKDTree::Build(const PointKernel& kernel)
+{
+    std::vector<Base::Vector3f> points;
+    points.reserve(kernel.size());
+    for (PointKernel::const_point_iterator it = kernel.begin(); it != kernel.end(); ++it) {
+        points.emplace_back(static_cast<float>(it->x),
+                            static_cast<float>(it->y),
+                            static_cast<float>(it->z));
+    }
+
+    Build(points);
+}
+
+void PointsKDTree::Build(const std::vector<Base::Vector3f>& points)
+{
+    Clear();
+
+    _points = points;
+    _indices.reserve(_points.size());
+    for (unsigned long i = 0; i < _points.size(); i++) {
+        // points with invalid coordinates cannot be sorted into the tree
+        const Base::Vector3f& p = _points[i];
+        if (!(std::isnan(p.x) || std::isnan(p.y) || std::isnan(p.z)))
+            _indices.push_back(i);
+    }
+
+    if (!_indices.empty()) {
+        _nodes.reserve(2 * (_indices.size() / MaxLeafSize + 1));
+        BuildNode(0, _indices.size());
+    }
+}
+
+unsigned long PointsKDTree::BuildNode(unsigned long begin, unsigned long end)
+{
+    unsigned long index = _nodes.size();
+    _nodes.push_back(Node());
+    Node& node = _nodes.back();
+    node.axis = -1;
+    node.split = 0.0f;
+    node.begin = begin;
+    node.end = end;
+    node.left = node.right = 0;
+
+    if (end - begin <= MaxLeafSize)
+        return index;
+
+    // split along the longest side of the bounding box of the points
+    Base::BoundBox3f bbox;
+    for (unsigned long i = begin; i < end; i++)
+        bbox.Add(_points[_indices[i]]);
+
+    int axis = 0;
+    float len = bbox.LengthX();
+    if (bbox.LengthY() > len) {
+        axis = 1;
+        len = bbox.LengthY();
+    }
+    if (bbox.LengthZ() > len) {
+        axis = 2;
+        len = bbox.LengthZ();
+    }
+
+    // all points are coincident
+    if (len <= 0.0f)
+        return index;
+
+    unsigned long mid = begin + (end - begin) / 2;
+    const std::vector<Base::Vector3f>& points = _points;
+    std::nth_element(_indices.begin() + begin, _indices.begin() + mid, _indices.begin() + end,
+        [&points, axis](unsigned long a, unsigned long b) {
+            return points[a][axis] < points[b][axis];
+        });
+    float split = _points[_indices[mid]][axis];
+
+    // the node reference may be invalidated by the recursion
+    unsigned long left = BuildNode(begin, mid);
+    unsigned long right = BuildNode(mid, end);
+
+    Node& parent = _nodes[index];
+    parent.axis = axis;
+    parent.split = split;
+    parent.left = left;
+    parent.right = right;
+    return index;
+}
+
+void PointsKDTree::Clear()
+{
+    _points.clear();
+    _indices.clear();
+    _nodes.clear();
+}
+
+bool PointsKDTree::IsEmpty() const
+{
+    return _nodes.empty();
+}
+
+std::size_t PointsKDTree::Size() const
+{
+    return _points.size();
+}
+
+const Base::Vector3f& PointsKDTree::GetPoint(unsigned long index) const
+{
+    return _points[index];
+}
+
+template <class Visitor>
+void PointsKDTree::Search(const Base::Vector3f& pnt, Visitor& visitor) const
+{
+    if (_nodes.empty())
+        return;
+
+    // nodes to visit together with the squared distance of the query point to their region
+    std::vector<std::pair<unsigned long, float> > stack;
+    stack.emplace_back(0, 0.0f);
+    while (!stack.empty()) {
+        std::pair<unsigned long, float> top = stack.back();
+        stack.pop_back();
+        if (top.second > visitor.radius2())
+            continue;
+
+        const Node& node = _nodes[top.first];
+        if (node.axis < 0) {
+            for (unsigned long i = node.begin; i < node.end; i++) {
+                unsigned long index = _indices[i];
+                float dist2 = Base::DistanceP2(pnt, _points[index]);
+                if (dist2 <= visitor.radius2())
+                    visitor.add(dist2, index);
+            }
+        }
+        else {
+            float diff = pnt[node.axis] - node.split;
+            unsigned long nearChild = diff < 0.0f ? node.left : node.right;
+            unsigned long farChild = diff < 0.0f ? node.right : node.left;
+            // visit the child containing the query point first
+            stack.emplace_back(farChild, std::max(top.second, diff * diff));
+            stack.emplace_back(nearChild, top.second);
+        }
+    }
+}
+
+unsigned long PointsKDTree::FindNearest(const Base::Vector3f& pnt, float& dist) const
+{
+    std::vector<unsigned long> indices;
+    std::vector<float> dists;
+    FindNearest(pnt, 1, indices, dists);
+    if (indices.empty())
+        return ULONG_MAX;
+
+    dist = dists.front();
+    return indices.front();
+}
+
+void PointsKDTree::FindNearest(const Base::Vector3f& pnt, unsigned long k,
+                               std::vector<unsigned long>& indices,
+                               std::vector<float>& dists) const
+{
+    NearestVisitor visitor(k);
+    if (k > 0)
+        Search(pnt, visitor);
+    visitor.result(indices, dists);
+}
+
+void PointsKDTree::FindInRange(const Base::Vector3f& pnt, float radius,
+                               std::vector<unsigned long>& indices) const
+{
+    RangeVisitor visitor(radius);
+    Search(pnt, visitor);
+    visitor.result(indices);
+}
+
+void PointsKDTree::FindNearest(const std::vector<Base::Vector3f>& pnts, unsigned long k,
+                               std::vector< std::vector<unsigned long> >& indices) const
+{
+    indices.clear();
+    indices.resize(pnts.size());
+
+    std::vector<unsigned long> tasks;
+    for (unsigned long i = 0; i < pnts.size(); i += QueriesPerTask)
+        tasks.push_back(i);
+
+    QtConcurrent::blockingMap(tasks, [this, &pnts, k, &indices](unsigned long first) {
+        unsigned long last = std::min<unsigned long>(first + QueriesPerTask, pnts.size());
+        std::vector<float> dists;
+        for (unsigned long i = first; i < last; i++)
+            FindNearest(pnts[i], k, indices[i], dists);
+    });
+}
+
+void PointsKDTree::FindInRange(const std::vector<Base::Vector3f>& pnts, float radius,
+                               std::vector< std::vector<unsigned long> >& indices) const
+{
+    indices.clear();
+    indices.resize(pnts.size());
+
+    std::vector<unsigned long> tasks;
+    for (unsigned long i = 0; i < pnts.size(); i += QueriesPerTask)
+        tasks.push_back(i);
+
+    QtConcurrent::blockingMap(tasks, [this, &pnts, radius, &indices](unsigned long first) {
+        unsigned long last = std::min<unsigned long>(first + QueriesPerTask, pnts.size());
+        for (unsigned long i = first; i < last; i++)
+            FindInRange(pnts[i], radius, indices[i]);
+    });
+}
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef POINTS_KDTREE_H
+#define POINTS_KDTREE_H
+
+#include <vector>
+
+#include "Points.h"
+#include <Base/Vector3D.h>
+
+namespace Points {
+
+/**
+ * The PointsKDTree is a spatial index for nearest neighbour and radius searches
+ * on a point cloud.
+ *
+ * Unlike the PointsGrid, whose grid elements all have the same size, the tree
+ * splits the space at the median of the points and thus adapts to the local
+ * point density. This keeps the memory consumption and the search times bounded
+ * for scans whose density varies by orders of magnitude.
+ *
+ * All searches are read-only so a built tree can be queried from several threads
+ * at the same time. The batch versions of the searches distribute the queries
+ * over all available cores.
+ */
+class PointsExport PointsKDTree
+{
+public:
+    /// Construction
+    PointsKDTree();
+    /// Construction, the points are taken with the placement of the kernel
+    PointsKDTree(const PointKernel&);
+    /// Construction
+    PointsKDTree(const std::vector<Base::Vector3f>&);
+    /// Destruction
+    ~PointsKDTree();
+
+    /** Rebuilds the tree for the given points, the indices returned by the
+     * searches refer to this list. */
+    void Build(const std::vector<Base::Vector3f>&);
+    /** Rebuilds the tree for the points of the kernel with its placement applied. */
+    void Build(const PointKernel&);
+    void Clear();
+    bool IsEmpty() const;
+    std::size_t Size() const;
+    /** Returns the point with index \a index. */
+    const Base::Vector3f& GetPoint(unsigned long index) const;
+
+    /** @name Search */
+    //@{
+    /** Returns the index of the nearest point to \a pnt and its distance \a dist.
+     * If the tree is empty ULONG_MAX is returned. */
+    unsigned long FindNearest(const Base::Vector3f& pnt, float& dist) const;
+    /** Searches for the \a k nearest points of \a pnt. The indices and distances are
+     * sorted by increasing distance. */
+    void FindNearest(const Base::Vector3f& pnt, unsigned long k,
+                     std::vector<unsigned long>& indices,
+                     std::vector<float>& dists) const;
+    /** Searches for all points with a distance to \a pnt of at most \a radius. The
+     * indices are sorted by increasing distance. */
+    void FindInRange(const Base::Vector3f& pnt, float radius,
+                     std::vector<unsigned long>& indices) const;
+    //@}
+
+    /** @name Batch search */
+    //@{
+    /** Searches for the \a k nearest points of each point in \a pnts in parallel. */
+    void FindNearest(const std::vector<Base::Vector3f>& pnts, unsigned long k,
+                     std::vector< std::vector<unsigned long> >& indices) const;
+    /** Searches for the points within \a radius of each point in \a pnts in parallel. */
+    void FindInRange(const std::vector<Base::Vector3f>& pnts, float radius,
+                     std::vector< std::vector<unsigned long> >& indices) const;
+    //@}
+
+private:
+    struct Node
+    {
+        float split;
+        int axis; // -1 for a leaf
+        unsigned long begin, end; // range in _indices for leaves
+        unsigned long left, right; // child nodes
+    };
+
+    template <class Visitor>
+    void Search(const Base::Vector3f& pnt, Visitor& visitor) const;
+    unsigned long BuildNode(unsigned long begin, unsigned long end);
+
+private:
+    std::vector<Base::Vector3f> _points;
+    std::vector<unsigned long> _indices;
+    std::vector<Node> _nodes;
+
+    PointsKDTree(const PointsKDTree&);
+    void operator= (const PointsKDTree&);
+};
+
+} // namespace Points
+
+#endif // POINTS_KDTREE_H
@@ -24,7 +24,10 @@
 #include "PreCompiled.h"
 
 #include "Mod/Points/App/Points.h"
+#include "Mod/Points/App/PointsFilter.h"
+#include "Mod/Points/App/PointsKDTree.h"
 #include <Base/Builder3D.h>
+#include <Base/Converter.h>
 #include <Base/VectorPy.h>
 #include <Base/GeometryPyCXX.h>
 #include <boost/math/special_functions/fpclassify.hpp>
@@ -227,6 +230,174 @@ PyObject* PointsPy::fromValid(PyObject * args)
     }
 }
 
+namespace {
+// Converts a single vector or a sequence of vectors to a list of query points
+bool getQueryPoints(PyObject* obj, std::vector<Base::Vector3f>& pnts, bool& single)
+{
+    if (PyObject_TypeCheck(obj, &(Base::VectorPy::Type))) {
+        Base::Vector3d v = *static_cast<Base::VectorPy*>(obj)->getVectorPtr();
+        pnts.push_back(Base::convertTo<Base::Vector3f>(v));
+        single = true;
+        return true;
+    }
+
+    try {
+        Py::Sequence list(obj);
+        pnts.reserve(list.size());
+        for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+            Base::Vector3d v = Py::Vector(*it).toVector();
+            pnts.push_back(Base::convertTo<Base::Vector3f>(v));
+        }
+        single = false;
+        return true;
+    }
+    catch (const Py::Exception&) {
+        PyErr_Clear();
+        PyErr_SetString(PyExc_TypeError, "either expect\n"
+            "-- Vector\n"
+            "-- [Vector,...]");
+        return false;
+    }
+}
+
+Py::List toIndexList(const std::vector<unsigned long>& indices)
+{
+    Py::List list;
+    for (std::vector<unsigned long>::const_iterator it = indices.begin(); it != indices.end(); ++it)
+        list.append(Py::Long(*it));
+    return list;
+}
+
+Py::Object toIndexLists(const std::vector< std::vector<unsigned long> >& indices, bool single)
+{
+    if (single)
+        return toIndexList(indices.front());
+
+    Py::List list;
+    for (std::vector< std::vector<unsigned long> >::const_iterator it = indices.begin(); it != indices.end(); ++it)
+        list.append(toIndexList(*it));
+    return list;
+}
+}
+
+PyObject* PointsPy::findNearest(PyObject * args)
+{
+    PyObject *obj;
+    long k = 1;
+    if (!PyArg_ParseTuple(args, "O|l", &obj, &k))
+        return 0;
+
+    if (k < 1) {
+        PyErr_SetString(PyExc_ValueError, "Number of neighbours must be positive");
+        return 0;
+    }
+
+    std::vector<Base::Vector3f> pnts;
+    bool single = false;
+    if (!getQueryPoints(obj, pnts, single))
+        return 0;
+
+    PY_TRY {
+        std::shared_ptr<const PointsKDTree> tree = getPointKernelPtr()->getKDTree();
+        std::vector< std::vector<unsigned long> > indices;
+        tree->FindNearest(pnts, static_cast<unsigned long>(k), indices);
+        return Py::new_reference_to(toIndexLists(indices, single));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::findInRange(PyObject * args)
+{
+    PyObject *obj;
+    double radius;
+    if (!PyArg_ParseTuple(args, "Od", &obj, &radius))
+        return 0;
+
+    std::vector<Base::Vector3f> pnts;
+    bool single = false;
+    if (!getQueryPoints(obj, pnts, single))
+        return 0;
+
+    PY_TRY {
+        std::shared_ptr<const PointsKDTree> tree = getPointKernelPtr()->getKDTree();
+        std::vector< std::vector<unsigned long> > indices;
+        tree->FindInRange(pnts, static_cast<float>(radius), indices);
+        return Py::new_reference_to(toIndexLists(indices, single));
+    } PY_CATCH;
+}
+
+namespace {
+// Creates a new point object from the given points of the kernel
+PointKernel* subsetKernel(const PointKernel& kernel, const std::vector<unsigned long>& indices)
+{
+    std::unique_ptr<PointKernel> pts(new PointKernel());
+    pts->setTransform(kernel.getTransform());
+    std::vector<Base::Vector3f>& points = pts->getBasicPoints();
+    const std::vector<Base::Vector3f>& source = kernel.getBasicPoints();
+    points.reserve(indices.size());
+    for (std::vector<unsigned long>::const_iterator it = indices.begin(); it != indices.end(); ++it)
+        points.push_back(source[*it]);
+    return pts.release();
+}
+}
+
+PyObject* PointsPy::downsample(PyObject * args)
+{
+    double voxelSize;
+    if (!PyArg_ParseTuple(args, "d", &voxelSize))
+        return 0;
+
+    PY_TRY {
+        const PointKernel* kernel = getPointKernelPtr();
+        std::unique_ptr<PointKernel> pts(new PointKernel());
+        pts->setTransform(kernel->getTransform());
+        VoxelGridFilter filter(voxelSize);
+        filter.Filter(kernel->getBasicPoints(), pts->getBasicPoints());
+        return new PointsPy(pts.release());
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::removeOutliers(PyObject * args)
+{
+    long k = 8;
+    double stdDevMult = 1.0;
+    if (!PyArg_ParseTuple(args, "|ld", &k, &stdDevMult))
+        return 0;
+
+    if (k < 1) {
+        PyErr_SetString(PyExc_ValueError, "Number of neighbours must be positive");
+        return 0;
+    }
+
+    PY_TRY {
+        const PointKernel* kernel = getPointKernelPtr();
+        OutlierFilter filter(kernel->getBasicPoints());
+        std::vector<unsigned long> inliers;
+        filter.StatisticalFilter(static_cast<unsigned long>(k), stdDevMult, inliers);
+        return new PointsPy(subsetKernel(*kernel, inliers));
+    } PY_CATCH;
+}
+
+PyObject* PointsPy::removeRadiusOutliers(PyObject * args)
+{
+    double radius;
+    long minNeighbours;
+    if (!PyArg_ParseTuple(args, "dl", &radius, &minNeighbours))
+        return 0;
+
+    if (minNeighbours < 0) {
+        PyErr_SetString(PyExc_ValueError, "Number of neighbours must not be negative");
+        return 0;
+    }
+
+    PY_TRY {
+        const PointKernel* kernel = getPointKernelPtr();
+        OutlierFilter filter(kernel->getBasicPoints());
+        std::vector<unsigned long> inliers;
+        filter.RadiusFilter(radius, static_cast<unsigned long>(minNeighbours), inliers);
+        return new PointsPy(subsetKernel(*kernel, inliers));
+    } PY_CATCH;
+}
+
 Py::Long PointsPy::getCountPoints(void) const
 {
     return Py::Long((long)getPointKernelPtr()->size());
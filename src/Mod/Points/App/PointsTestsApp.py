@@ -0,0 +1,167 @@
+# -*- coding: utf-8 -*-
+
+#  Copyright (c) 2020 FreeCAD developers
+#  LGPL
+
+import FreeCAD, os, random, unittest, tempfile, Points
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD points module
+#---------------------------------------------------------------------------
+
+
+class PointsAsciiTestCases(unittest.TestCase):
+    def setUp(self):
+        self.tempdir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        for name in os.listdir(self.tempdir):
+            os.remove(os.path.join(self.tempdir, name))
+        os.rmdir(self.tempdir)
+
+    def writeFile(self, name, text):
+        path = os.path.join(self.tempdir, name)
+        with open(path, "w") as f:
+            f.write(text)
+        return path
+
+    def testAscRoundTrip(self):
+        pts = [FreeCAD.Vector(i, 0.5 * i, -2.0 * i) for i in range(100)]
+        cloud = Points.Points(pts)
+        path = os.path.join(self.tempdir, "roundtrip.asc")
+        cloud.write(path)
+
+        other = Points.Points()
+        other.read(path)
+        self.assertEqual(other.CountPoints, len(pts))
+        for p, q in zip(pts, other.Points):
+            self.assertAlmostEqual((p - q).Length, 0.0, 5)
+
+    def testAscWithoutLastLineBreak(self):
+        path = self.writeFile("nobreak.asc", "# ASCII\n1 2 3\n\n4 5 6\n7 8 9")
+        cloud = Points.Points()
+        cloud.read(path)
+        self.assertEqual(cloud.CountPoints, 3)
+        self.assertAlmostEqual((cloud.Points[2] - FreeCAD.Vector(7, 8, 9)).Length, 0.0, 5)
+
+    def testAscEmpty(self):
+        path = self.writeFile("empty.asc", "")
+        cloud = Points.Points()
+        cloud.read(path)
+        self.assertEqual(cloud.CountPoints, 0)
+
+    def testPlyWithInvalidLines(self):
+        # unparsable and incomplete lines are skipped
+        path = self.writeFile("invalid.ply",
+            "ply\nformat ascii 1.0\nelement vertex 4\n"
+            "property float x\nproperty float y\nproperty float z\nend_header\n"
+            "1 2 3\na b c\n4 5\n1e999 0 0\n")
+        doc = FreeCAD.newDocument("PointsTest")
+        try:
+            Points.insert(path, doc.Name)
+            self.assertEqual(len(doc.Objects), 1)
+            self.assertEqual(doc.Objects[0].Points.CountPoints, 1)
+        finally:
+            FreeCAD.closeDocument(doc.Name)
+
+    def testPlyWithMissingLines(self):
+        # the header announces more vertices than the file contains
+        path = self.writeFile("short.ply",
+            "ply\nformat ascii 1.0\nelement vertex 4\n"
+            "property float x\nproperty float y\nproperty float z\nend_header\n"
+            "1 2 3\n4 5 6\n")
+        doc = FreeCAD.newDocument("PointsTest")
+        try:
+            Points.insert(path, doc.Name)
+            self.assertEqual(len(doc.Objects), 1)
+            self.assertEqual(doc.Objects[0].Points.CountPoints, 2)
+        finally:
+            FreeCAD.closeDocument(doc.Name)
+
+    def testSaveRestoreRoundTrip(self):
+        # more points than written in one block
+        pts = [FreeCAD.Vector(0.25 * i, -0.5 * i, 1.0 + i) for i in range(70000)]
+        path = os.path.join(self.tempdir, "points.FCStd")
+        doc = FreeCAD.newDocument("PointsSave")
+        try:
+            feature = doc.addObject("Points::Feature", "Points")
+            feature.Points = Points.Points(pts)
+            doc.saveAs(path)
+        finally:
+            FreeCAD.closeDocument(doc.Name)
+
+        doc = FreeCAD.openDocument(path)
+        try:
+            cloud = doc.getObject("Points").Points
+            self.assertEqual(cloud.CountPoints, len(pts))
+            for p, q in zip(pts, cloud.Points):
+                self.assertEqual(p, q)
+        finally:
+            FreeCAD.closeDocument(doc.Name)
+
+
+class PointsSearchTestCases(unittest.TestCase):
+    def setUp(self):
+        rng = random.Random(42)
+        # the z range is much smaller to get a non-uniform density, the points are
+        # taken back from a point object to compare with the stored float coordinates
+        self.pts = Points.Points([FreeCAD.Vector(rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-0.1, 0.1))
+                                  for i in range(2000)]).Points
+        self.queries = [FreeCAD.Vector(rng.uniform(-12, 12), rng.uniform(-12, 12), rng.uniform(-1, 1))
+                        for i in range(20)]
+
+    def sortedByDistance(self, pts, query):
+        return sorted(range(len(pts)), key=lambda i: (pts[i] - query).Length)
+
+    def testFindNearest(self):
+        cloud = Points.Points(self.pts)
+        for query in self.queries:
+            self.assertEqual(cloud.findNearest(query, 5), self.sortedByDistance(self.pts, query)[:5])
+        self.assertEqual(cloud.findNearest(self.queries, 3),
+                         [self.sortedByDistance(self.pts, q)[:3] for q in self.queries])
+        self.assertEqual(len(cloud.findNearest(self.queries[0], len(self.pts) + 10)), len(self.pts))
+
+    def testFindInRange(self):
+        cloud = Points.Points(self.pts)
+        for query in self.queries:
+            expected = [i for i in self.sortedByDistance(self.pts, query)
+                        if (self.pts[i] - query).Length <= 1.5]
+            self.assertEqual(cloud.findInRange(query, 1.5), expected)
+
+    def testSearchAfterModification(self):
+        cloud = Points.Points(self.pts)
+        query = FreeCAD.Vector(20, 20, 0)
+        self.assertNotEqual(cloud.findNearest(query), [len(self.pts)])
+        # the search structure must follow added points and a new placement
+        cloud.addPoints([query])
+        self.assertEqual(cloud.findNearest(query), [len(self.pts)])
+        cloud.Placement = FreeCAD.Placement(FreeCAD.Vector(100, 0, 0), FreeCAD.Rotation())
+        moved = [p + FreeCAD.Vector(100, 0, 0) for p in self.pts + [query]]
+        for q in self.queries:
+            q = q + FreeCAD.Vector(100, 0, 0)
+            self.assertEqual(cloud.findNearest(q, 4), self.sortedByDistance(moved, q)[:4])
+
+    def testRemoveOutliers(self):
+        pts = self.pts[:500]
+        cloud = Points.Points(pts)
+        k = 6
+        means = []
+        for p in pts:
+            dists = sorted((q - p).Length for q in pts)
+            # the first distance is the one to the point itself
+            means.append(sum(dists[1:k + 1]) / k)
+        mean = sum(means) / len(means)
+        stdDev = (sum(m * m for m in means) / len(means) - mean * mean) ** 0.5
+        limit = mean + 0.5 * stdDev
+        expected = [p for p, m in zip(pts, means) if m <= limit]
+        self.assertLess(len(expected), len(pts))
+        self.assertEqual(cloud.removeOutliers(k, 0.5).Points, expected)
+
+    def testRemoveRadiusOutliers(self):
+        pts = self.pts[:500]
+        cloud = Points.Points(pts)
+        # the point itself isn't counted as neighbour
+        expected = [p for p in pts if sum(1 for q in pts if (q - p).Length <= 1.0) > 3]
+        self.assertLess(len(expected), len(pts))
+        self.assertEqual(cloud.removeRadiusOutliers(1.0, 3).Points, expected)
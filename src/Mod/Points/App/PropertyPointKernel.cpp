@@ -58,6 +58,13 @@ void PropertyPointKernel::setValue(const PointKernel& m)
     hasSetValue();
 }
 
+void PropertyPointKernel::swapValue(PointKernel& m)
+{
+    aboutToSetValue();
+    _cPoints->swap(m);
+    hasSetValue();
+}
+
 const PointKernel& PropertyPointKernel::getValue(void) const 
 {
     return *_cPoints;
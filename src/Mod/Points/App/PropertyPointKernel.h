@@ -43,6 +43,8 @@ public:
     //@{
     /// Sets the points to the property
     void setValue( const PointKernel& m);
+    /// Swaps the points with \a m to avoid a deep copy of big point clouds
+    void swapValue(PointKernel& m);
     /// get the points (only const possible!)
     const PointKernel &getValue(void) const;
     const Data::ComplexGeoData* getComplexData() const;
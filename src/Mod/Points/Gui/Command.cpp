@@ -26,6 +26,7 @@
 # include <algorithm>
 # include <QFileInfo>
 # include <QInputDialog>
+# include <QMessageBox>
 # include <Python.h>
 # include <Inventor/events/SoMouseButtonEvent.h>
 #endif
@@ -35,6 +36,7 @@
 #include <Base/Tools.h>
 #include <App/Application.h>
 #include <App/Document.h>
+#include <App/PropertyStandard.h>
 #include <Gui/Application.h>
 #include <Gui/Document.h>
 #include <Gui/MainWindow.h>
@@ -47,6 +49,7 @@
 #include <Gui/WaitCursor.h>
 
 #include "../App/PointsFeature.h"
+#include "../App/PointsFilter.h"
 #include "../App/Structured.h"
 #include "../App/Properties.h"
 #include "DlgPointsReadImp.h"
@@ -462,6 +465,243 @@ bool CmdPointsStructure::isActive(void)
     return getSelection().countObjectsOfType(Points::Feature::getClassTypeId()) == 1;
 }
 
+/*!
+ * Adds a feature with the filtered points \a kernel of \a input and carries
+ * over its intensities, colors and normals. \a mapping gives for each input
+ * point the index of the filtered point it went to, or -1 if it was dropped.
+ * The values of several points going to the same filtered point are averaged.
+ */
+static Points::Feature* addFilteredPoints(Points::Feature* input, const std::string& name,
+                                          Points::PointKernel& kernel, const std::vector<long>& mapping)
+{
+    std::size_t size = kernel.size();
+    std::vector<float> counts(size, 0.0f);
+    for (std::vector<long>::const_iterator it = mapping.begin(); it != mapping.end(); ++it) {
+        if (*it >= 0)
+            counts[*it] += 1.0f;
+    }
+
+    // the properties are only used if they have a value for each point
+    int numPoints = static_cast<int>(mapping.size());
+    Points::PropertyGreyValueList* intensity = Base::freecad_dynamic_cast<Points::PropertyGreyValueList>
+        (input->getPropertyByName("Intensity"));
+    if (intensity && intensity->getSize() != numPoints)
+        intensity = 0;
+    App::PropertyColorList* color = Base::freecad_dynamic_cast<App::PropertyColorList>
+        (input->getPropertyByName("Color"));
+    if (color && color->getSize() != numPoints)
+        color = 0;
+    Points::PropertyNormalList* normal = Base::freecad_dynamic_cast<Points::PropertyNormalList>
+        (input->getPropertyByName("Normal"));
+    if (normal && normal->getSize() != numPoints)
+        normal = 0;
+
+    Points::Feature* output = 0;
+    if (intensity || color || normal)
+        output = new Points::FeatureCustom();
+    else
+        output = new Points::Feature();
+
+    if (intensity) {
+        const std::vector<float>& values = intensity->getValues();
+        std::vector<float> filtered(size, 0.0f);
+        for (std::size_t i = 0; i < mapping.size(); i++) {
+            if (mapping[i] >= 0)
+                filtered[mapping[i]] += values[i];
+        }
+        for (std::size_t i = 0; i < size; i++) {
+            if (counts[i] > 0.0f)
+                filtered[i] /= counts[i];
+        }
+        Points::PropertyGreyValueList* prop = static_cast<Points::PropertyGreyValueList*>
+            (output->addDynamicProperty("Points::PropertyGreyValueList", "Intensity"));
+        if (prop)
+            prop->setValues(filtered);
+    }
+
+    if (color) {
+        const std::vector<App::Color>& values = color->getValues();
+        std::vector<App::Color> filtered(size, App::Color(0.0f, 0.0f, 0.0f, 0.0f));
+        for (std::size_t i = 0; i < mapping.size(); i++) {
+            if (mapping[i] >= 0) {
+                App::Color& c = filtered[mapping[i]];
+                c.r += values[i].r;
+                c.g += values[i].g;
+                c.b += values[i].b;
+                c.a += values[i].a;
+            }
+        }
+        for (std::size_t i = 0; i < size; i++) {
+            if (counts[i] > 0.0f) {
+                App::Color& c = filtered[i];
+                c.set(c.r / counts[i], c.g / counts[i], c.b / counts[i], c.a / counts[i]);
+            }
+        }
+        App::PropertyColorList* prop = static_cast<App::PropertyColorList*>
+            (output->addDynamicProperty("App::PropertyColorList", "Color"));
+        if (prop)
+            prop->setValues(filtered);
+    }
+
+    if (normal) {
+        const std::vector<Base::Vector3f>& values = normal->getValues();
+        std::vector<Base::Vector3f> filtered(size);
+        for (std::size_t i = 0; i < mapping.size(); i++) {
+            if (mapping[i] >= 0)
+                filtered[mapping[i]] += values[i];
+        }
+        for (std::vector<Base::Vector3f>::iterator it = filtered.begin(); it != filtered.end(); ++it) {
+            if (it->Length() > 0.0f)
+                it->Normalize();
+        }
+        Points::PropertyNormalList* prop = static_cast<Points::PropertyNormalList*>
+            (output->addDynamicProperty("Points::PropertyNormalList", "Normal"));
+        if (prop)
+            prop->setValues(filtered);
+    }
+
+    output->Points.swapValue(kernel);
+    output->Placement.setValue(input->Placement.getValue());
+    input->getDocument()->addObject(output, name.c_str());
+    output->Label.setValue(name);
+    output->purgeTouched();
+    return output;
+}
+
+DEF_STD_CMD_A(CmdPointsDownsample)
+
+CmdPointsDownsample::CmdPointsDownsample()
+  :Command("Points_Downsample")
+{
+    sAppModule    = "Points";
+    sGroup        = QT_TR_NOOP("Points");
+    sMenuText     = QT_TR_NOOP("Downsample...");
+    sToolTipText  = QT_TR_NOOP("Replace the points inside each cell of a voxel grid by their centroid");
+    sWhatsThis    = "Points_Downsample";
+    sStatusTip    = QT_TR_NOOP("Replace the points inside each cell of a voxel grid by their centroid");
+}
+
+void CmdPointsDownsample::activated(int iMsg)
+{
+    Q_UNUSED(iMsg);
+
+    std::vector<App::DocumentObject*> docObj = getSelection().getObjectsOfType(Points::Feature::getClassTypeId());
+
+    // suggest a cell size of a hundredth of the biggest cloud
+    double size = 0.0;
+    for (std::vector<App::DocumentObject*>::iterator it = docObj.begin(); it != docObj.end(); ++it) {
+        Base::BoundBox3d bbox = static_cast<Points::Feature*>(*it)->Points.getBoundingBox();
+        if (bbox.IsValid())
+            size = std::max(size, bbox.CalcDiagonalLength() / 100.0);
+    }
+
+    bool ok;
+    double voxelSize = QInputDialog::getDouble(Gui::getMainWindow(), QObject::tr("Voxel size"),
+        QObject::tr("Enter the edge length of the grid cells:"), size > 0.0 ? size : 1.0, 0.001, 1.0e6, 3, &ok, Qt::MSWindowsFixedSizeDialogHint);
+    if (!ok)
+        return;
+
+    Gui::WaitCursor wc;
+    openCommand(QT_TRANSLATE_NOOP("Command", "Downsample points"));
+
+    try {
+        Points::VoxelGridFilter filter(voxelSize);
+        for (std::vector<App::DocumentObject*>::iterator it = docObj.begin(); it != docObj.end(); ++it) {
+            Points::Feature* input = static_cast<Points::Feature*>(*it);
+            std::string name = input->Label.getValue();
+            name += " (Downsampled)";
+
+            Points::PointKernel kernel;
+            std::vector<long> cells;
+            filter.Filter(input->Points.getValue().getBasicPoints(), kernel.getBasicPoints(), cells);
+            addFilteredPoints(input, name, kernel, cells);
+        }
+    }
+    catch (const Base::Exception& e) {
+        abortCommand();
+        wc.restoreCursor();
+        QMessageBox::warning(Gui::getMainWindow(), QObject::tr("Downsample"), QString::fromLatin1(e.what()));
+        return;
+    }
+
+    commitCommand();
+    updateActive();
+}
+
+bool CmdPointsDownsample::isActive(void)
+{
+    return getSelection().countObjectsOfType(Points::Feature::getClassTypeId()) > 0;
+}
+
+DEF_STD_CMD_A(CmdPointsRemoveOutliers)
+
+CmdPointsRemoveOutliers::CmdPointsRemoveOutliers()
+  :Command("Points_RemoveOutliers")
+{
+    sAppModule    = "Points";
+    sGroup        = QT_TR_NOOP("Points");
+    sMenuText     = QT_TR_NOOP("Remove outliers...");
+    sToolTipText  = QT_TR_NOOP("Remove points that are far away from their neighbours");
+    sWhatsThis    = "Points_RemoveOutliers";
+    sStatusTip    = QT_TR_NOOP("Remove points that are far away from their neighbours");
+}
+
+void CmdPointsRemoveOutliers::activated(int iMsg)
+{
+    Q_UNUSED(iMsg);
+
+    bool ok;
+    int numNeighbours = QInputDialog::getInt(Gui::getMainWindow(), QObject::tr("Remove outliers"),
+        QObject::tr("Enter the number of neighbours:"), 8, 1, 1000, 1, &ok, Qt::MSWindowsFixedSizeDialogHint);
+    if (!ok)
+        return;
+    double stdDevMult = QInputDialog::getDouble(Gui::getMainWindow(), QObject::tr("Remove outliers"),
+        QObject::tr("Enter the standard deviation multiplier:"), 1.0, 0.0, 100.0, 2, &ok, Qt::MSWindowsFixedSizeDialogHint);
+    if (!ok)
+        return;
+
+    Gui::WaitCursor wc;
+    openCommand(QT_TRANSLATE_NOOP("Command", "Remove outliers"));
+
+    std::vector<App::DocumentObject*> docObj = getSelection().getObjectsOfType(Points::Feature::getClassTypeId());
+    try {
+        for (std::vector<App::DocumentObject*>::iterator it = docObj.begin(); it != docObj.end(); ++it) {
+            Points::Feature* input = static_cast<Points::Feature*>(*it);
+            std::string name = input->Label.getValue();
+            name += " (Filtered)";
+
+            const std::vector<Base::Vector3f>& points = input->Points.getValue().getBasicPoints();
+            Points::OutlierFilter filter(points);
+            std::vector<unsigned long> inliers;
+            filter.StatisticalFilter(static_cast<unsigned long>(numNeighbours), stdDevMult, inliers);
+
+            Points::PointKernel kernel;
+            kernel.reserve(inliers.size());
+            std::vector<Base::Vector3f>& basic = kernel.getBasicPoints();
+            std::vector<long> mapping(points.size(), -1);
+            for (std::vector<unsigned long>::iterator jt = inliers.begin(); jt != inliers.end(); ++jt) {
+                mapping[*jt] = static_cast<long>(basic.size());
+                basic.push_back(points[*jt]);
+            }
+            addFilteredPoints(input, name, kernel, mapping);
+        }
+    }
+    catch (const Base::Exception& e) {
+        abortCommand();
+        wc.restoreCursor();
+        QMessageBox::warning(Gui::getMainWindow(), QObject::tr("Remove outliers"), QString::fromLatin1(e.what()));
+        return;
+    }
+
+    commitCommand();
+    updateActive();
+}
+
+bool CmdPointsRemoveOutliers::isActive(void)
+{
+    return getSelection().countObjectsOfType(Points::Feature::getClassTypeId()) > 0;
+}
+
 void CreatePointsCommands(void)
 {
     Gui::CommandManager &rcCmdMgr = Gui::Application::Instance->commandManager();
@@ -472,4 +712,6 @@ void CreatePointsCommands(void)
     rcCmdMgr.addCommand(new CmdPointsPolyCut());
     rcCmdMgr.addCommand(new CmdPointsMerge());
     rcCmdMgr.addCommand(new CmdPointsStructure());
+    rcCmdMgr.addCommand(new CmdPointsDownsample());
+    rcCmdMgr.addCommand(new CmdPointsRemoveOutliers());
 }
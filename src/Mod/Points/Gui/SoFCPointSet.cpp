@@ -0,0 +1,84 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <climits>
+# include <Inventor/actions/SoGLRenderAction.h>
+# include <Inventor/elements/SoCoordinateElement.h>
+#endif
+
+#include <Gui/SoFCInteractiveElement.h>
+#include "SoFCPointSet.h"
+
+using namespace PointsGui;
+
+
+SO_NODE_SOURCE(SoFCPointSet)
+
+void SoFCPointSet::initClass()
+{
+    SO_NODE_INIT_CLASS(SoFCPointSet, SoPointSet, "PointSet");
+}
+
+SoFCPointSet::SoFCPointSet()
+  : renderPointLimit(UINT_MAX)
+{
+    SO_NODE_CONSTRUCTOR(SoFCPointSet);
+    setName(SoFCPointSet::getClassTypeId().getName());
+}
+
+/**
+ * Either renders all points or only the first \a renderPointLimit points.
+ */
+void SoFCPointSet::GLRender(SoGLRenderAction *action)
+{
+    SoState * state = action->getState();
+
+    const int32_t oldNum = this->numPoints.getValue();
+    int32_t num = oldNum;
+    if (num < 0)
+        num = SoCoordinateElement::getInstance(state)->getNum() - this->startIndex.getValue();
+    if (num <= 0 || static_cast<unsigned int>(num) <= this->renderPointLimit) {
+        inherited::GLRender(action);
+        return;
+    }
+
+    // Reading the interaction mode makes the render cache of a parent node
+    // depend on it, so the cache is only rebuilt when the rendered subset
+    // changes, see SoFCInteractiveElement::matches()
+    SbBool mode = Gui::SoFCInteractiveElement::get(state);
+    if (mode == false) {
+        inherited::GLRender(action);
+        return;
+    }
+
+    // temporarily reduce the number of points without triggering a notification
+    SbBool notify = this->numPoints.enableNotify(false);
+    this->numPoints.setValue(static_cast<int32_t>(this->renderPointLimit));
+    inherited::GLRender(action);
+    this->numPoints.setValue(oldNum);
+    this->numPoints.enableNotify(notify);
+}
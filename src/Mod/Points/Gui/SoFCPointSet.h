@@ -0,0 +1,60 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTSGUI_SOFCPOINTSET_H
+#define POINTSGUI_SOFCPOINTSET_H
+
+#include <Inventor/nodes/SoPointSet.h>
+
+namespace PointsGui {
+
+/**
+ * class SoFCPointSet
+ * \brief The SoFCPointSet class is designed to keep redrawing large point clouds
+ * responsive during user interaction.
+ *
+ * While the user interacts with the view only the first \a renderPointLimit points
+ * are drawn, afterwards the complete set is drawn again. The points are expected to
+ * be ordered so that each prefix of the list is a spatially uniform subset of the cloud.
+ */
+class PointsGuiExport SoFCPointSet : public SoPointSet {
+    typedef SoPointSet inherited;
+
+    SO_NODE_HEADER(SoFCPointSet);
+
+public:
+    static void initClass();
+    SoFCPointSet();
+
+    unsigned int renderPointLimit;
+
+protected:
+    // Force using the reference count mechanism.
+    virtual ~SoFCPointSet() {}
+    virtual void GLRender(SoGLRenderAction *action);
+};
+
+} // namespace PointsGui
+
+
+#endif // POINTSGUI_SOFCPOINTSET_H
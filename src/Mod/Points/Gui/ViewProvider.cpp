@@ -25,6 +25,9 @@
 
 #ifndef _PreComp_
 # include <Python.h>
+# include <algorithm>
+# include <cmath>
+# include <random>
 # include <Inventor/nodes/SoCamera.h>
 # include <Inventor/nodes/SoCoordinate3.h>
 # include <Inventor/nodes/SoDrawStyle.h>
@@ -41,6 +44,7 @@
 #include <limits>
 
 /// Here the FreeCAD includes sorted by Base,App,Gui,...
+#include <Base/BoundBox.h>
 #include <Base/Console.h>
 #include <Base/Parameter.h>
 #include <Base/Exception.h>
@@ -58,6 +62,7 @@
 #include <Mod/Points/App/PointsFeature.h>
 
 #include "ViewProvider.h"
+#include "SoFCPointSet.h"
 #include "../App/Properties.h"
 
 
@@ -129,9 +134,17 @@ void ViewProviderPoints::setVertexColorMode(App::PropertyColorList* pcProperty)
     pcColorMat->diffuseColor.setNum(val.size());
     SbColor* col = pcColorMat->diffuseColor.startEditing();
 
-    std::size_t i=0;
-    for (std::vector<App::Color>::const_iterator it = val.begin(); it != val.end(); ++it) {
-        col[i++].setValue(it->r, it->g, it->b);
+    if (renderOrder.size() == val.size()) {
+        for (std::size_t i=0; i<renderOrder.size(); i++) {
+            const App::Color& c = val[renderOrder[i]];
+            col[i].setValue(c.r, c.g, c.b);
+        }
+    }
+    else {
+        std::size_t i=0;
+        for (std::vector<App::Color>::const_iterator it = val.begin(); it != val.end(); ++it) {
+            col[i++].setValue(it->r, it->g, it->b);
+        }
     }
 
     pcColorMat->diffuseColor.finishEditing();
@@ -144,9 +157,17 @@ void ViewProviderPoints::setVertexGreyvalueMode(Points::PropertyGreyValueList* p
     pcColorMat->diffuseColor.setNum(val.size());
     SbColor* col = pcColorMat->diffuseColor.startEditing();
 
-    std::size_t i=0;
-    for (std::vector<float>::const_iterator it = val.begin(); it != val.end(); ++it) {
-        col[i++].setValue(*it, *it, *it);
+    if (renderOrder.size() == val.size()) {
+        for (std::size_t i=0; i<renderOrder.size(); i++) {
+            float g = val[renderOrder[i]];
+            col[i].setValue(g, g, g);
+        }
+    }
+    else {
+        std::size_t i=0;
+        for (std::vector<float>::const_iterator it = val.begin(); it != val.end(); ++it) {
+            col[i++].setValue(*it, *it, *it);
+        }
     }
 
     pcColorMat->diffuseColor.finishEditing();
@@ -159,9 +180,17 @@ void ViewProviderPoints::setVertexNormalMode(Points::PropertyNormalList* pcPrope
     pcPointsNormal->vector.setNum(val.size());
     SbVec3f* norm = pcPointsNormal->vector.startEditing();
 
-    std::size_t i=0;
-    for (std::vector<Base::Vector3f>::const_iterator it = val.begin(); it != val.end(); ++it) {
-        norm[i++].setValue(it->x, it->y, it->z);
+    if (renderOrder.size() == val.size()) {
+        for (std::size_t i=0; i<renderOrder.size(); i++) {
+            const Base::Vector3f& n = val[renderOrder[i]];
+            norm[i].setValue(n.x, n.y, n.z);
+        }
+    }
+    else {
+        std::size_t i=0;
+        for (std::vector<Base::Vector3f>::const_iterator it = val.begin(); it != val.end(); ++it) {
+            norm[i++].setValue(it->x, it->y, it->z);
+        }
     }
 
     pcPointsNormal->vector.finishEditing();
@@ -352,11 +381,94 @@ void ViewProviderPoints::clipPointsCallback(void *, SoEventCallback * n)
 
 // -------------------------------------------------
 
+namespace {
+
+// Spreads the lower 10 bits of v so that two zero bits are between each of them
+uint32_t spreadBits(uint32_t v)
+{
+    v &= 0x000003ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v <<  8)) & 0x0300f00f;
+    v = (v | (v <<  4)) & 0x030c30c3;
+    v = (v | (v <<  2)) & 0x09249249;
+    return v;
+}
+
+/*
+ * Computes an order of the points so that each prefix of the ordered list is a
+ * spatially uniform subset of the whole cloud.
+ * The points are sorted along a Morton curve and each point gets the level of the
+ * coarsest octree cell that it doesn't share with its predecessor. Listing the
+ * points level by level then gives one point of each occupied cell of a level
+ * before going down to the next finer level. Invalid points are moved to the end.
+ */
+void computeRenderOrder(const std::vector<Base::Vector3f>& points, std::vector<int32_t>& order)
+{
+    const int numBits = 10; // per axis
+    const int numLevels = numBits + 2; // first point, octree levels, duplicates
+
+    Base::BoundBox3f box;
+    std::vector<int32_t> invalid;
+    for (std::vector<Base::Vector3f>::const_iterator it = points.begin(); it != points.end(); ++it) {
+        if (boost::math::isnan(it->x) || boost::math::isnan(it->y) || boost::math::isnan(it->z))
+            invalid.push_back(static_cast<int32_t>(it - points.begin()));
+        else
+            box.Add(*it);
+    }
+
+    float length = std::max(box.LengthX(), std::max(box.LengthY(), box.LengthZ()));
+    float scale = length > 0.0f ? static_cast<float>((1 << numBits) - 1) / length : 0.0f;
+
+    std::vector<std::pair<uint32_t, int32_t> > codes;
+    codes.reserve(points.size() - invalid.size());
+    for (std::vector<Base::Vector3f>::const_iterator it = points.begin(); it != points.end(); ++it) {
+        if (boost::math::isnan(it->x) || boost::math::isnan(it->y) || boost::math::isnan(it->z))
+            continue;
+        uint32_t x = static_cast<uint32_t>((it->x - box.MinX) * scale);
+        uint32_t y = static_cast<uint32_t>((it->y - box.MinY) * scale);
+        uint32_t z = static_cast<uint32_t>((it->z - box.MinZ) * scale);
+        uint32_t code = spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2);
+        codes.push_back(std::make_pair(code, static_cast<int32_t>(it - points.begin())));
+    }
+    std::sort(codes.begin(), codes.end());
+
+    std::vector< std::vector<int32_t> > levels(numLevels);
+    for (std::size_t i=0; i<codes.size(); i++) {
+        int level = 0;
+        if (i > 0) {
+            uint32_t diff = codes[i].first ^ codes[i-1].first;
+            if (diff == 0) {
+                level = numLevels - 1;
+            }
+            else {
+                int bit = 0;
+                while (diff >>= 1)
+                    bit++;
+                level = numBits - bit / 3;
+            }
+        }
+        levels[level].push_back(codes[i].second);
+    }
+
+    // Within a level the points are shuffled, otherwise a prefix that ends inside
+    // a level would only refine the part of the cloud along the start of the curve
+    std::mt19937 gen;
+    order.clear();
+    order.reserve(points.size());
+    for (std::vector< std::vector<int32_t> >::iterator it = levels.begin(); it != levels.end(); ++it) {
+        std::shuffle(it->begin(), it->end(), gen);
+        order.insert(order.end(), it->begin(), it->end());
+    }
+    order.insert(order.end(), invalid.begin(), invalid.end());
+}
+
+}
+
 PROPERTY_SOURCE(PointsGui::ViewProviderScattered, PointsGui::ViewProviderPoints)
 
 ViewProviderScattered::ViewProviderScattered()
 {
-    pcPoints = new SoPointSet();
+    pcPoints = new SoFCPointSet();
     pcPoints->ref();
 }
 
@@ -378,6 +490,13 @@ void ViewProviderScattered::attach(App::DocumentObject* pcObj)
     pcHighlight->addChild(pcPointsCoord);
     pcHighlight->addChild(pcPoints);
 
+    // read the threshold from the preferences
+    Base::Reference<ParameterGrp> hGrp = Gui::WindowParameter::getDefaultParameter()->GetGroup("Mod/Points");
+    int size = hGrp->GetInt("RenderPointLimit", 6);
+    // 10^9 is the largest power of ten an unsigned int can hold
+    if (size > 0)
+        pcPoints->renderPointLimit = static_cast<unsigned int>(std::pow(10.0, std::min(size, 9)));
+
     std::vector<std::string> modes = getDisplayModes();
 
     // points part ---------------------------------------------
@@ -415,8 +534,15 @@ void ViewProviderScattered::updateData(const App::Property* prop)
 {
     ViewProviderPoints::updateData(prop);
     if (prop->getTypeId() == Points::PropertyPointKernel::getClassTypeId()) {
+        // If the cloud is too big to be drawn completely during interaction then
+        // reorder the points so that the drawn subset covers the whole cloud
+        const Points::PointKernel& kernel = static_cast<const Points::PropertyPointKernel*>(prop)->getValue();
+        renderOrder.clear();
+        if (kernel.size() > pcPoints->renderPointLimit)
+            computeRenderOrder(kernel.getBasicPoints(), renderOrder);
+
         ViewProviderPointsBuilder builder;
-        builder.createPoints(prop, pcPointsCoord, pcPoints);
+        builder.createPoints(prop, pcPointsCoord, pcPoints, renderOrder);
 
         // The number of points might have changed, so force also a resize of the Inventor internals
         setActiveMode();
@@ -689,6 +815,30 @@ void ViewProviderPointsBuilder::createPoints(const App::Property* prop, SoCoordi
     coords->point.finishEditing();
 }
 
+void ViewProviderPointsBuilder::createPoints(const App::Property* prop, SoCoordinate3* coords, SoPointSet* points,
+                                             const std::vector<int32_t>& order) const
+{
+    const Points::PropertyPointKernel* prop_points = static_cast<const Points::PropertyPointKernel*>(prop);
+    const Points::PointKernel& cPts = prop_points->getValue();
+    const std::vector<Points::PointKernel::value_type>& kernel = cPts.getBasicPoints();
+    if (order.size() != kernel.size()) {
+        createPoints(prop, coords, points);
+        return;
+    }
+
+    coords->point.setNum(cPts.size());
+    SbVec3f* vec = coords->point.startEditing();
+
+    // get all points in the given order
+    for (std::size_t idx=0; idx<order.size(); idx++) {
+        const Points::PointKernel::value_type& pnt = kernel[order[idx]];
+        vec[idx].setValue(pnt.x, pnt.y, pnt.z);
+    }
+
+    points->numPoints = cPts.size();
+    coords->point.finishEditing();
+}
+
 void ViewProviderPointsBuilder::createPoints(const App::Property* prop, SoCoordinate3* coords, SoIndexedPointSet* points) const
 {
     const Points::PropertyPointKernel* prop_points = static_cast<const Points::PropertyPointKernel*>(prop);
@@ -55,6 +55,8 @@ namespace Points {
 
 namespace PointsGui {
 
+class SoFCPointSet;
+
 class ViewProviderPointsBuilder : public Gui::ViewProviderBuilder
 {
 public:
@@ -62,6 +64,7 @@ public:
     ~ViewProviderPointsBuilder(){}
     virtual void buildNodes(const App::Property*, std::vector<SoNode*>&) const;
     void createPoints(const App::Property*, SoCoordinate3*, SoPointSet*) const;
+    void createPoints(const App::Property*, SoCoordinate3*, SoPointSet*, const std::vector<int32_t>& order) const;
     void createPoints(const App::Property*, SoCoordinate3*, SoIndexedPointSet*) const;
 };
 
@@ -107,6 +110,8 @@ protected:
     SoMaterial          * pcColorMat;
     SoNormal            * pcPointsNormal;
     SoDrawStyle         * pcPointStyle;
+    /// The order in which the points are passed to Inventor, empty if unchanged
+    std::vector<int32_t>  renderOrder;
 
 private:
     static App::PropertyFloatConstraint::Constraints floatRange;
@@ -137,7 +142,7 @@ protected:
     virtual void cut(const std::vector<SbVec2f>& picked, Gui::View3DInventorViewer &Viewer);
 
 protected:
-    SoPointSet          * pcPoints;
+    SoFCPointSet        * pcPoints;
 };
 
 /**
@@ -93,6 +93,9 @@ Gui::MenuItem* Workbench::setupMenuBar() const
           << "Points_Export"
           << "Separator"
           << "Points_PolyCut"
-          << "Points_Merge";
+          << "Points_Merge"
+          << "Separator"
+          << "Points_Downsample"
+          << "Points_RemoveOutliers";
     return root;
 }
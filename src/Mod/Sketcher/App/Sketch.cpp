@@ -123,11 +123,17 @@ void Sketch::clear(void)
     Constrs.clear();
 
     GCSsys.clear();
+    GCSsys.solveTemporaryComponentsOnly = false;
     isInitMove = false;
+    MovedGeometry.clear();
     ConstraintsCounter = 0;
     Conflicting.clear();
     Redundant.clear();
     MalformedConstraints.clear();
+
+    for (std::vector<Constraint *>::iterator it = SetUpConstraints.begin(); it != SetUpConstraints.end(); ++it)
+        delete *it;
+    SetUpConstraints.clear();
 }
 
 bool Sketch::analyseBlockedGeometry( const std::vector<Part::Geometry *> &internalGeoList,
@@ -333,6 +339,8 @@ int Sketch::setUpSketch(const std::vector<Part::Geometry *> &GeoList,
 
     calculateDependentParametersElements();
 
+    storeSetUpConstraints(ConstraintList);
+
     if (debugMode==GCS::Minimal || debugMode==GCS::IterationLevel) {
         Base::TimeInfo end_time;
 
@@ -342,6 +350,122 @@ int Sketch::setUpSketch(const std::vector<Part::Geometry *> &GeoList,
     return GCSsys.dofsNumber();
 }
 
+void Sketch::storeSetUpConstraints(const std::vector<Constraint *> &ConstraintList)
+{
+    for (std::vector<Constraint *>::iterator it = SetUpConstraints.begin(); it != SetUpConstraints.end(); ++it)
+        delete *it;
+    SetUpConstraints.clear();
+
+    SetUpConstraints.reserve(ConstraintList.size());
+    for (std::vector<Constraint *>::const_iterator it = ConstraintList.begin(); it != ConstraintList.end(); ++it)
+        SetUpConstraints.push_back((*it)->clone());
+}
+
+// the solver constraints created for both constraints are the same, except possibly their datum value
+static bool isSameSolverConstraint(const Constraint *a, const Constraint *b)
+{
+    return a->Type == b->Type && a->AlignmentType == b->AlignmentType
+        && a->First == b->First && a->FirstPos == b->FirstPos
+        && a->Second == b->Second && a->SecondPos == b->SecondPos
+        && a->Third == b->Third && a->ThirdPos == b->ThirdPos
+        && a->isDriving == b->isDriving && a->isActive == b->isActive
+        && a->InternalAlignmentIndex == b->InternalAlignmentIndex;
+}
+
+// the datum value is passed unchanged to the solver, so it can be updated in place
+static bool hasPlainSolverValue(const Constraint *constr)
+{
+    switch (constr->Type) {
+    case DistanceX:
+    case DistanceY:
+    case Distance:
+    case Angle:
+    case Radius:
+    case Diameter:
+    case Weight:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool Sketch::updateSketch(const std::vector<Constraint *> &ConstraintList, int &dofs)
+{
+    if (Geoms.empty() || !MalformedConstraints.empty() || ConstraintList.size() < SetUpConstraints.size())
+        return false;
+
+    // check the changes can be applied on the current model. Block constraints need a
+    // new analysis of the blocked geometry (see setUpSketch) whenever anything changes.
+    bool valuesChanged = false;
+    std::size_t constrsCount = 0;
+    for (std::size_t i = 0; i < ConstraintList.size(); ++i) {
+        const Constraint *constr = ConstraintList[i];
+
+        if (constr->Type == Block && constr->isDriving)
+            return false;
+
+        if (i >= SetUpConstraints.size())
+            continue;
+
+        if (!isSameSolverConstraint(SetUpConstraints[i], constr))
+            return false;
+
+        if (constr->Type != Block && constr->isActive)
+            ++constrsCount;
+
+        // the value of a driven constraint is a result of the solver, not an input
+        if (constr->isDriving && constr->getValue() != SetUpConstraints[i]->getValue()) {
+            if (!hasPlainSolverValue(constr))
+                return false;
+            valuesChanged = true;
+        }
+    }
+    if (constrsCount != Constrs.size())
+        return false;
+
+    // update the kept constraints, that are in the same order in Constrs (see addConstraints)
+    std::size_t cid = 0;
+    for (std::size_t i = 0; i < SetUpConstraints.size(); ++i) {
+        Constraint *constr = ConstraintList[i];
+        if (constr->Type == Block || !constr->isActive) // not in Constrs
+            continue;
+
+        ConstrDef &c = Constrs[cid++];
+        c.constr = constr;
+        if (c.driving && c.value && constr->getValue() != SetUpConstraints[i]->getValue())
+            *c.value = constr->getValue();
+    }
+
+    // datum values do not change the rank of the system. However, with redundant constraints
+    // they decide which of them are redundant and which conflicting, so that diagnosis goes.
+    // New constraints change the Jacobian, so the diagnosis has to be redone as well.
+    if ((valuesChanged && (!Conflicting.empty() || !Redundant.empty()))
+        || ConstraintList.size() > SetUpConstraints.size())
+        GCSsys.invalidatedDiagnosis();
+
+    // append the new constraints
+    for (std::size_t i = SetUpConstraints.size(); i < ConstraintList.size(); ++i) {
+        if (ConstraintList[i]->Type != Block && ConstraintList[i]->isActive) {
+            if (addConstraint(ConstraintList[i]) == -1) {
+                int humanconstraintid = i + 1;
+                Base::Console().Error("Sketcher constraint number %d is malformed!\n",humanconstraintid);
+                MalformedConstraints.push_back(humanconstraintid);
+            }
+        }
+        else {
+            ++ConstraintsCounter; // For correct solver redundant reporting
+        }
+    }
+
+    resetInitMove();
+    pDependencyGroups.clear();
+    dofs = resetSolver();
+
+    storeSetUpConstraints(ConstraintList);
+
+    return true;
+}
+
 void Sketch::fixParametersAndDiagnose(std::vector<double *> &params_to_block)
 {
     if(params_to_block.size() > 0) { // only there are parameters to fix
@@ -578,6 +702,12 @@ int Sketch::resetSolver()
     return GCSsys.dofsNumber();
 }
 
+int Sketch::rediagnose()
+{
+    GCSsys.invalidatedDiagnosis();
+    return resetSolver();
+}
+
 const char* nameByType(Sketch::GeoType type)
 {
     switch (type) {
@@ -3316,6 +3446,9 @@ bool Sketch::updateGeometry()
 {
     int i=0;
     for (std::vector<GeoDef>::const_iterator it=Geoms.begin(); it != Geoms.end(); ++it, i++) {
+        // while dragging the geometries outside the moved components keep their values
+        if (isInitMove && i < int(MovedGeometry.size()) && !MovedGeometry[i])
+            continue;
         try {
             if (it->type == Point) {
                 GeomPoint *point = static_cast<GeomPoint*>(it->geo);
@@ -3526,6 +3659,7 @@ int Sketch::solve(void)
     Base::TimeInfo start_time;
     if (!isInitMove) { // make sure we are in single subsystem mode
         clearTemporaryConstraints();
+        GCSsys.solveTemporaryComponentsOnly = false;
         isFine = true;
     }
 
@@ -3569,6 +3703,9 @@ int Sketch::solve(void)
         }
         else {
             updateNonDrivingConstraints();
+            // the next drag step starts from this solution instead of the initial state
+            if (isInitMove)
+                GCSsys.updateReference();
         }
     }
     else {
@@ -3675,7 +3812,7 @@ int Sketch::initMove(int geoId, PointPos pos, bool fine)
 
     // don't try to move sketches that contain conflicting constraints
     if (hasConflicts()) {
-        isInitMove = false;
+        resetInitMove();
         return -1;
     }
 
@@ -3941,7 +4078,19 @@ int Sketch::initMove(int geoId, PointPos pos, bool fine)
     }
     InitParameters = MoveParameters;
 
+    GCSsys.solveTemporaryComponentsOnly = true;
     GCSsys.initSolution();
+
+    // the temporary constraints only reach the components of the moved geometry
+    std::vector<double *> solvedParams;
+    GCSsys.getSolvedParams(solvedParams);
+    MovedGeometry.assign(Geoms.size(), false);
+    for (std::vector<double *>::const_iterator it = solvedParams.begin(); it != solvedParams.end(); ++it) {
+        auto element = param2geoelement.find(*it);
+        if (element != param2geoelement.end() && element->second.first < int(Geoms.size()))
+            MovedGeometry[element->second.first] = true;
+    }
+
     isInitMove = true;
     return 0;
 }
@@ -3949,6 +4098,8 @@ int Sketch::initMove(int geoId, PointPos pos, bool fine)
 void Sketch::resetInitMove()
 {
     isInitMove = false;
+    GCSsys.solveTemporaryComponentsOnly = false;
+    MovedGeometry.clear();
 }
 
 int Sketch::movePoint(int geoId, PointPos pos, Base::Vector3d toPoint, bool relative)
@@ -53,6 +53,8 @@ public:
     int solve(void);
     /// resets the solver
     int resetSolver();
+    /// discards the diagnosis of the set up sketch and diagnoses it again, returns the degrees of freedom
+    int rediagnose();
     /// get standard (aka fine) solver precision
     double getSolverPrecision(){ return GCSsys.getFinePrecision(); }
     /// delete all geometry and constraints, leave an empty sketch
@@ -72,6 +74,18 @@ public:
       */
     int setUpSketch(const std::vector<Part::Geometry *> &GeoList, const std::vector<Constraint *> &ConstraintList,
                     int extGeoCount=0);
+    /** update an already set up sketch to a new constraint list, without rebuilding the solver model
+      *
+      * This is only possible if ConstraintList is the list the sketch was set up with, with
+      * changed datum values and/or further constraints appended at the end, and if the solver
+      * geometry is still the one of the sketch object (i.e. the one last set up or solved).
+      * Changed datum values alone keep a clean diagnosis, as they do not affect the rank of
+      * the system.
+      *
+      * returns false, leaving the sketch untouched, if setUpSketch is needed instead. Otherwise
+      * dofs is set to the degrees of freedom of the sketch, as returned by setUpSketch.
+      */
+    bool updateSketch(const std::vector<Constraint *> &ConstraintList, int &dofs);
     /// return the actual geometry of the sketch a TopoShape
     Part::TopoShape toShape(void) const;
     /// add unspecified geometry
@@ -81,6 +95,8 @@ public:
     /// add unspecified geometry, where each element's "fixed" status is given by the blockedGeometry array
     int addGeometry(const std::vector<Part::Geometry *> &geo,
                     const std::vector<bool> &blockedGeometry);
+    /// keeps copies of the constraint list the solver model corresponds to, for updateSketch
+    void storeSetUpConstraints(const std::vector<Constraint *> &ConstraintList);
     /// get boolean list indicating whether the geometry is to be blocked or not
     void getBlockedGeometry(std::vector<bool> & blockedGeometry,
                             std::vector<bool> & unenforceableConstraints,
@@ -105,6 +121,8 @@ public:
     inline const std::vector<int> &getRedundant(void) const { return Redundant; }
 
     inline float getSolveTime() const { return SolveTime; }
+    /// status of each decoupled component in the last solver run
+    void getSubSystemsStatus(std::vector<int> &statusOut) const { GCSsys.getSubSystemsStatus(statusOut); }
 
     inline bool hasMalformedConstraints(void) const { return !MalformedConstraints.empty(); }
     inline const std::vector<int> &getMalformedConstraints(void) const { return MalformedConstraints; }
@@ -427,6 +445,7 @@ protected:
     std::vector<int> Conflicting;
     std::vector<int> Redundant;
     std::vector<int> MalformedConstraints;
+    std::vector<Constraint *> SetUpConstraints; // copies of the constraints the solver model was built from
 
     std::vector<double *> pDependentParametersList;
 
@@ -452,6 +471,9 @@ protected:
 
     bool isInitMove;
     bool isFine;
+    // geometries of the solver components reached by the current move, only these
+    // are solved and written back while dragging
+    std::vector<bool> MovedGeometry;
     Base::Vector3d initToPoint;
     double moveStep;
 
@@ -470,6 +492,8 @@ public:
     inline void setQRAlgorithm(GCS::QRAlgorithm alg){GCSsys.qrAlgorithm=alg;}
     inline GCS::QRAlgorithm getQRAlgorithm(){return GCSsys.qrAlgorithm;}
     inline void setQRPivotThreshold(double val){GCSsys.qrpivotThreshold=val;}
+    inline void setSparseSolverThreshold(int val){GCSsys.sparseSolverThreshold=val;}
+    inline void clearDiagnosisCache(){GCSsys.clearDiagnosisCache();}
     inline void setLM_eps(double val){GCSsys.LM_eps=val;}
     inline void setLM_eps1(double val){GCSsys.LM_eps1=val;}
     inline void setLM_tau(double val){GCSsys.LM_tau=val;}
@@ -139,6 +139,7 @@ SketchObject::SketchObject()
     lastSolveTime=0;
 
     solverNeedsUpdate=false;
+    solverGeometryInSync=false;
 
     noRecomputes=false;
 
@@ -265,9 +266,11 @@ int SketchObject::solve(bool updateGeoAfterSolving/*=true*/)
     // We should have an updated Sketcher (sketchobject) geometry or this solve() should not have happened
     // therefore we update our sketch solver geometry with the SketchObject one.
     //
-    // set up a sketch (including dofs counting and diagnosing of conflicts)
-    lastDoF = solvedSketch.setUpSketch(getCompleteGeometry(), Constraints.getValues(),
-                                  getExternalGeometryCount());
+    // set up a sketch (including dofs counting and diagnosing of conflicts). If only datum values
+    // changed or constraints were added since the last solve, the solver model is updated instead.
+    if (!solverGeometryInSync || !solvedSketch.updateSketch(Constraints.getValues(), lastDoF))
+        lastDoF = solvedSketch.setUpSketch(getCompleteGeometry(), Constraints.getValues(),
+                                      getExternalGeometryCount());
 
     FullyConstrained.setValue(lastDoF == 0);
     // At this point we have the solver information about conflicting/redundant/over-constrained, but the sketch is NOT solved.
@@ -283,6 +286,7 @@ int SketchObject::solve(bool updateGeoAfterSolving/*=true*/)
     lastSolveTime=0.0;
 
     lastSolverStatus=GCS::Failed; // Failure is default for notifying the user unless otherwise proven
+    lastSubSystemsStatus.clear();
 
     int err=0;
 
@@ -305,6 +309,7 @@ int SketchObject::solve(bool updateGeoAfterSolving/*=true*/)
     }
     else {
         lastSolverStatus=solvedSketch.solve();
+        solvedSketch.getSubSystemsStatus(lastSubSystemsStatus);
         if (lastSolverStatus != 0){ // solving
             err = -1;
         }
@@ -329,6 +334,9 @@ int SketchObject::solve(bool updateGeoAfterSolving/*=true*/)
         this->Constraints.touch();
     }
 
+    // the solver geometry moved away from the properties only if it was solved and not written back
+    solverGeometryInSync = (lastSolverStatus != GCS::Success || (err == 0 && updateGeoAfterSolving));
+
     return err;
 }
 
@@ -654,6 +662,8 @@ int SketchObject::setUpSketch()
     lastDoF = solvedSketch.setUpSketch(getCompleteGeometry(), Constraints.getValues(),
                                        getExternalGeometryCount());
 
+    solverGeometryInSync = true;
+
     retrieveSolverDiagnostics();
 
     if(lastHasRedundancies || lastDoF < 0 || lastHasConflict || lastHasMalformedConstraints)
@@ -674,6 +684,8 @@ int SketchObject::movePoint(int GeoId, PointPos PosId, const Base::Vector3d& toP
     // example. This is why exceptionally, it may be required to update the sketch geometry to that of
     // of SketchObject upon moving. => use updateGeometry parameter = true then
 
+    solverGeometryInSync = false;
+
 
     if(updateGeoBeforeMoving || solverNeedsUpdate) {
         lastDoF = solvedSketch.setUpSketch(getCompleteGeometry(), Constraints.getValues(),
@@ -6184,6 +6196,10 @@ void SketchObject::validateExternalLinks(void)
 
 void SketchObject::rebuildExternalGeometry(void)
 {
+    // without external references only the constant H and V axes are rebuilt
+    if (ExternalGeometry.getSize() > 0)
+        solverGeometryInSync = false;
+
     // get the actual lists of the externals
     std::vector<DocumentObject*> Objects     = ExternalGeometry.getValues();
     std::vector<std::string>     SubElements = ExternalGeometry.getSubValues();
@@ -7410,6 +7426,9 @@ void SketchObject::onChanged(const App::Property* prop)
 
     if (prop == &Geometry || prop == &Constraints) {
 
+        if (prop == &Geometry)
+            solverGeometryInSync = false;
+
         auto doc = getDocument();
 
         if(doc && doc->isPerformingTransaction()) { // undo/redo
@@ -7459,6 +7478,8 @@ void SketchObject::onChanged(const App::Property* prop)
         }
     }
     else if (prop == &ExternalGeometry) {
+        solverGeometryInSync = false;
+
         // make sure not to change anything while restoring this object
         if (!isRestoring()) {
             // external geometry was cleared
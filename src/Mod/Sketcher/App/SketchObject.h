@@ -356,6 +356,8 @@ public:
     inline int getLastSolverStatus() const {return lastSolverStatus;}
     /// gets solver SolveTime of last solver execution
     inline float getLastSolveTime() const {return lastSolveTime;}
+    /// gets the solver status of each decoupled component of the last solver execution
+    inline const std::vector<int> &getLastSubSystemsStatus(void) const { return lastSubSystemsStatus; }
     /// gets the conflicting constraints of the last solver execution
     inline const std::vector<int> &getLastConflicting(void) const { return lastConflicting; }
     /// gets the redundant constraints of last solver execution
@@ -511,6 +513,11 @@ private:
     */
     bool solverNeedsUpdate;
 
+    /** this internal flag indicates that the geometry of the solver is the one of the Geometry and
+        ExternalGeometry properties, so that solve() may update the solver model instead of setting it up again.
+    */
+    bool solverGeometryInSync;
+
     int lastDoF;
     bool lastHasConflict;
     bool lastHasRedundancies;
@@ -521,6 +528,7 @@ private:
     std::vector<int> lastConflicting;
     std::vector<int> lastRedundant;
     std::vector<int> lastMalformedConstraints;
+    std::vector<int> lastSubSystemsStatus;
 
     boost::signals2::scoped_connection constraintsRenamedConn;
     boost::signals2::scoped_connection constraintsRemovedConn;
@@ -557,6 +565,7 @@ inline int SketchObject::initTemporaryMove(int geoId, PointPos pos, bool fine/*=
     if(solverNeedsUpdate)
         solve();
 
+    solverGeometryInSync = false; // temporary moves leave the solver geometry moved
     return solvedSketch.initMove(geoId,pos,fine);
 }
 
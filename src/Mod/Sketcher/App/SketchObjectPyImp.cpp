@@ -1817,6 +1817,20 @@ Py::Long SketchObjectPy::getAxisCount(void) const
     return Py::Long(this->getSketchObjectPtr()->getAxisCount());
 }
 
+Py::Long SketchObjectPy::getDoF(void) const
+{
+    return Py::Long(this->getSketchObjectPtr()->getLastDoF());
+}
+
+Py::List SketchObjectPy::getSubSystemsStatus(void) const
+{
+    const std::vector<int> &status = this->getSketchObjectPtr()->getLastSubSystemsStatus();
+    Py::List list;
+    for (std::vector<int>::const_iterator it = status.begin(); it != status.end(); ++it)
+        list.append(Py::Long(*it));
+    return list;
+}
+
 
 Py::List SketchObjectPy::getGeometryFacadeList(void) const
 {
@@ -55,9 +55,13 @@
 #include <limits>
 #include <future>
 
+#include <QtConcurrentMap>
+
 #include "GCS.h"
 #include "qp_eq.h"
 
+#include <Eigen/SparseCholesky>
+
 // NOTE: In CMakeList.txt -DEIGEN_NO_DEBUG is set (it does not work with a define here), to solve this:
 // this is needed to fix this SparseQR crash http://forum.freecadweb.org/viewtopic.php?f=10&t=11341&p=92146#p92146,
 // until Eigen library fixes its own problem with the assertion (definitely not solved in 3.2.0 branch)
@@ -446,6 +450,8 @@ System::System()
   , dogLegGaussStep(FullPivLU)
   , qrpivotThreshold(1E-13)
   , debugMode(Minimal)
+  , parallelComponents(true)
+  , solveTemporaryComponentsOnly(false)
   , LM_eps(1E-10)
   , LM_eps1(1E-80)
   , LM_tau(1E-3)
@@ -458,6 +464,7 @@ System::System()
   , DL_tolgRedundant(1E-80)
   , DL_tolxRedundant(1E-80)
   , DL_tolfRedundant(1E-10)
+  , sparseSolverThreshold(10000)
 {
     // currently Eigen only supports multithreading for multiplications
     // There is no appreciable gain from using more threads
@@ -1545,22 +1552,45 @@ int System::solve(bool isFine, Algorithm alg, bool isRedundantsolving)
     if (!isInit)
         return Failed;
 
-    bool isReset = false;
     // return success by default in order to permit coincidence constraints to be applied
     // even if no other system has to be solved
     int res = Success;
-    for (int cid=0; cid < int(subSystems.size()); cid++) {
-        if ((subSystems[cid] || subSystemsAux[cid]) && !isReset) {
-             resetToReference();
-             isReset = true;
-        }
+    subSystemsStatus.assign(subSystems.size(), Success);
+
+    VEC_I cids, active;
+    getSolvedComponents(cids);
+    for (VEC_I::const_iterator cid=cids.begin(); cid != cids.end(); ++cid) {
+        if (subSystems[*cid] || subSystemsAux[*cid])
+            active.push_back(*cid);
+    }
+    if (!active.empty())
+        resetToReference();
+
+    // the components share neither parameters nor constraints, so they can be solved
+    // independently; iteration level debugging logs from the solvers and stays sequential
+    auto solveComponent = [&](int i) {
+        int cid = active[i];
         if (subSystems[cid] && subSystemsAux[cid])
-            res = std::max(res, solve(subSystems[cid], subSystemsAux[cid], isFine, isRedundantsolving));
+            subSystemsStatus[cid] = solve(subSystems[cid], subSystemsAux[cid], isFine, isRedundantsolving);
         else if (subSystems[cid])
-            res = std::max(res, solve(subSystems[cid], isFine, alg, isRedundantsolving));
-        else if (subSystemsAux[cid])
-            res = std::max(res, solve(subSystemsAux[cid], isFine, alg, isRedundantsolving));
+            subSystemsStatus[cid] = solve(subSystems[cid], isFine, alg, isRedundantsolving);
+        else
+            subSystemsStatus[cid] = solve(subSystemsAux[cid], isFine, alg, isRedundantsolving);
+    };
+
+    if (parallelComponents && debugMode != IterationLevel && active.size() > 1) {
+        VEC_I indices(active.size());
+        for (int i=0; i < int(indices.size()); i++)
+            indices[i] = i;
+        QtConcurrent::blockingMap(indices, solveComponent);
+    }
+    else {
+        for (int i=0; i < int(active.size()); i++)
+            solveComponent(i);
     }
+
+    for (VEC_I::const_iterator it=subSystemsStatus.begin(); it != subSystemsStatus.end(); ++it)
+        res = std::max(res, *it);
     if (res == Success) {
         for (std::set<Constraint *>::const_iterator constr=redundant.begin();
              constr != redundant.end(); ++constr){
@@ -1724,11 +1754,20 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
     if (xsize == 0)
         return Success;
 
+    // large subsystems are usually very sparse, each constraint only touching a handful of
+    // parameters, so J^T J is assembled and factorized as a sparse matrix for them
+    bool sparse = sparseSolverThreshold > 0 && double(csize)*xsize > sparseSolverThreshold;
+
     Eigen::VectorXd e(csize), e_new(csize); // vector of all function errors (every constraint is one function)
-    Eigen::MatrixXd J(csize, xsize);        // Jacobi of the subsystem
-    Eigen::MatrixXd A(xsize, xsize);
+    Eigen::MatrixXd J, A;                   // Jacobi of the subsystem and J^T J, dense path
+    Eigen::SparseMatrix<double> sJ, sA, sI; // the same for the sparse path
     Eigen::VectorXd x(xsize), h(xsize), x_new(xsize), g(xsize), diag_A(xsize);
 
+    if (sparse) {
+        sI.resize(xsize, xsize);
+        sI.setIdentity();
+    }
+
     subsys->redirectParams();
 
     subsys->getParams(x);
@@ -1752,6 +1791,7 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
                 << ", tau: "            << tau
                 << ", convergence: "    << (isRedundantsolving?convergenceRedundant:convergence)
                 << ", xsize: "          << xsize
+                << ", sparse: "         << (sparse?"yes":"no")
                 << ", maxIter: "        << maxIterNumber  << "\n";
 
         const std::string tmp = stream.str();
@@ -1774,14 +1814,23 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
         }
 
         // J^T J, J^T e
-        subsys->calcJacobi(J);;
+        if (sparse) {
+            subsys->calcJacobi(sJ);
+
+            sA = sJ.transpose()*sJ;
+            g = sJ.transpose()*e;
+            diag_A = sA.diagonal();
+        }
+        else {
+            subsys->calcJacobi(J);
 
-        A = J.transpose()*J;
-        g = J.transpose()*e;
+            A = J.transpose()*J;
+            g = J.transpose()*e;
+            diag_A = A.diagonal(); // save diagonal entries so that augmentation can be later canceled
+        }
 
         // Compute ||J^T e||_inf
         double g_inf = g.lpNorm<Eigen::Infinity>();
-        diag_A = A.diagonal(); // save diagonal entries so that augmentation can be later canceled
 
         // check for convergence
         if (g_inf <= eps1) {
@@ -1797,13 +1846,29 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
         // determine increment using adaptive damping
         int k=0;
         while (k < 50) {
-            // augment normal equations A = A+uI
-            for (int i=0; i < xsize; ++i)
-                A(i,i) += mu;
+            double rel_error;
+            if (sparse) {
+                // augment normal equations A = A+uI, which makes them positive definite
+                Eigen::SparseMatrix<double> sA_aug = sA + mu*sI;
+
+                //solve augmented functions A*h=-g
+                Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldlt(sA_aug);
+                if (ldlt.info() == Eigen::Success) {
+                    h = ldlt.solve(g);
+                    rel_error = (sA_aug*h - g).norm() / g.norm();
+                }
+                else
+                    rel_error = std::numeric_limits<double>::infinity();
+            }
+            else {
+                // augment normal equations A = A+uI
+                for (int i=0; i < xsize; ++i)
+                    A(i,i) += mu;
 
-            //solve augmented functions A*h=-g
-            h = A.fullPivLu().solve(g);
-            double rel_error = (A*h - g).norm() / g.norm();
+                //solve augmented functions A*h=-g
+                h = A.fullPivLu().solve(g);
+                rel_error = (A*h - g).norm() / g.norm();
+            }
 
             // check if solving works
             if (rel_error < 1e-5) {
@@ -1850,8 +1915,10 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
 
             mu*=nu;
             nu*=2.0;
-            for (int i=0; i < xsize; ++i) // restore diagonal J^T J entries
-                A(i,i) = diag_A(i);
+            if (!sparse) {
+                for (int i=0; i < xsize; ++i) // restore diagonal J^T J entries
+                    A(i,i) = diag_A(i);
+            }
 
             k++;
         }
@@ -1902,6 +1969,11 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
         (sketchSizeMultiplierRedundant?maxIterRedundant * xsize:maxIterRedundant):
         (sketchSizeMultiplier?maxIter * xsize:maxIter));
 
+    // the sparse path computes the least norm gauss-newton step with a sparse LDLT
+    // factorization of J J^T, so it is only taken if that step was chosen
+    bool sparse = dogLegGaussStep == LeastNormLdlt &&
+                  sparseSolverThreshold > 0 && double(csize)*xsize > sparseSolverThreshold;
+
     if(debugMode==IterationLevel) {
         std::stringstream stream;
         stream  << "DL: tolg: "         << tolg
@@ -1911,6 +1983,7 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
                 << ", dogLegGaussStep: " << (dogLegGaussStep==FullPivLU?"FullPivLU":(dogLegGaussStep==LeastNormFullPivLU?"LeastNormFullPivLU":"LeastNormLdlt"))
                 << ", xsize: "          << xsize
                 << ", csize: "          << csize
+                << ", sparse: "         << (sparse?"yes":"no")
                 << ", maxIter: "        << maxIterNumber  << "\n";
 
         const std::string tmp = stream.str();
@@ -1919,7 +1992,8 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
 
     Eigen::VectorXd x(xsize), x_new(xsize);
     Eigen::VectorXd fx(csize), fx_new(csize);
-    Eigen::MatrixXd Jx(csize, xsize), Jx_new(csize, xsize);
+    Eigen::MatrixXd Jx, Jx_new;
+    Eigen::SparseMatrix<double> sJx, sJx_new;
     Eigen::VectorXd g(xsize), h_sd(xsize), h_gn(xsize), h_dl(xsize);
 
     subsys->redirectParams();
@@ -1927,9 +2001,14 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
     double err;
     subsys->getParams(x);
     subsys->calcResidual(fx, err);
-    subsys->calcJacobi(Jx);
-
-    g = Jx.transpose()*(-fx);
+    if (sparse) {
+        subsys->calcJacobi(sJx);
+        g = sJx.transpose()*(-fx);
+    }
+    else {
+        subsys->calcJacobi(Jx);
+        g = Jx.transpose()*(-fx);
+    }
 
     // get the infinity norm fx_inf and g_inf
     double g_inf = g.lpNorm<Eigen::Infinity>();
@@ -1957,25 +2036,37 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
         }
         else {
             // get the steepest descent direction
-            alpha = g.squaredNorm()/(Jx*g).squaredNorm();
+            alpha = g.squaredNorm()/(sparse?(sJx*g).squaredNorm():(Jx*g).squaredNorm());
             h_sd  = alpha*g;
 
             // get the gauss-newton step
             // http://forum.freecadweb.org/viewtopic.php?f=10&t=12769&start=50#p106220
             // https://forum.kde.org/viewtopic.php?f=74&t=129439#p346104
-            switch (dogLegGaussStep){
-                case FullPivLU:
-                    h_gn = Jx.fullPivLu().solve(-fx);
-                    break;
-                case LeastNormFullPivLU:
-                    h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).fullPivLu().solve(-fx);
-                    break;
-                case LeastNormLdlt:
-                    h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).ldlt().solve(-fx);
-                    break;
+            if (sparse) {
+                Eigen::SparseMatrix<double> JJt = sJx*sJx.transpose();
+                Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldlt(JJt);
+                if (ldlt.info() == Eigen::Success)
+                    h_gn = sJx.transpose()*ldlt.solve(-fx);
+                else { // exactly singular J J^T, fall back to the rank revealing dense solver
+                    Eigen::MatrixXd J = sJx;
+                    h_gn = J.adjoint()*(J*J.adjoint()).fullPivLu().solve(-fx);
+                }
+            }
+            else {
+                switch (dogLegGaussStep){
+                    case FullPivLU:
+                        h_gn = Jx.fullPivLu().solve(-fx);
+                        break;
+                    case LeastNormFullPivLU:
+                        h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).fullPivLu().solve(-fx);
+                        break;
+                    case LeastNormLdlt:
+                        h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).ldlt().solve(-fx);
+                        break;
+                }
             }
 
-            double rel_error = (Jx*h_gn + fx).norm() / fx.norm();
+            double rel_error = ((sparse?Eigen::VectorXd(sJx*h_gn):Eigen::VectorXd(Jx*h_gn)) + fx).norm() / fx.norm();
             if (rel_error > 1e15)
                 break;
 
@@ -2023,20 +2114,29 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
         x_new = x + h_dl;
         subsys->setParams(x_new);
         subsys->calcResidual(fx_new, err_new);
-        subsys->calcJacobi(Jx_new);
+        if (sparse)
+            subsys->calcJacobi(sJx_new);
+        else
+            subsys->calcJacobi(Jx_new);
 
         // calculate the linear model and the update ratio
-        double dL = err - 0.5*(fx + Jx*h_dl).squaredNorm();
+        double dL = err - 0.5*(fx + (sparse?Eigen::VectorXd(sJx*h_dl):Eigen::VectorXd(Jx*h_dl))).squaredNorm();
         double dF = err - err_new;
         double rho = dL/dF;
 
         if (dF > 0 && dL > 0) {
             x  = x_new;
-            Jx = Jx_new;
             fx = fx_new;
             err = err_new;
 
-            g = Jx.transpose()*(-fx);
+            if (sparse) {
+                sJx = sJx_new;
+                g = sJx.transpose()*(-fx);
+            }
+            else {
+                Jx = Jx_new;
+                g = Jx.transpose()*(-fx);
+            }
 
             // get infinity norms
             g_inf = g.lpNorm<Eigen::Infinity>();
@@ -3785,9 +3885,43 @@ int System::solve(SubSystem *subsysA, SubSystem *subsysB, bool /*isFine*/, bool
 
 }
 
+void System::getSolvedComponents(VEC_I &cids) const
+{
+    cids.clear();
+    if (solveTemporaryComponentsOnly) {
+        for (int cid=0; cid < int(subSystemsAux.size()); cid++) {
+            if (subSystemsAux[cid])
+                cids.push_back(cid);
+        }
+        if (!cids.empty())
+            return;
+    }
+    for (int cid=0; cid < int(subSystems.size()); cid++)
+        cids.push_back(cid);
+}
+
+void System::getSolvedParams(VEC_pD &params) const
+{
+    params.clear();
+    if (!isInit)
+        return;
+
+    VEC_I cids;
+    getSolvedComponents(cids);
+    for (VEC_I::const_iterator cid=cids.begin(); cid != cids.end(); ++cid) {
+        params.insert(params.end(), plists[*cid].begin(), plists[*cid].end());
+        for (MAP_pD_pD::const_iterator it=reductionmaps[*cid].begin();
+             it != reductionmaps[*cid].end(); ++it)
+            params.push_back(it->first);
+    }
+}
+
 void System::applySolution()
 {
-    for (int cid=0; cid < int(subSystems.size()); cid++) {
+    VEC_I cids;
+    getSolvedComponents(cids);
+    for (VEC_I::const_iterator c=cids.begin(); c != cids.end(); ++c) {
+        int cid = *c;
         if (subSystemsAux[cid])
             subSystemsAux[cid]->applySolution();
         if (subSystems[cid])
@@ -3960,6 +4094,13 @@ SolverReportingManager::Manager().LogToFile("GCS::System::diagnose()\n");
     }
 #endif
 
+    // Sketches made of many unconnected clusters give a block diagonal jacobian, whose rank
+    // and dependent parameters are those of its blocks. These are much cheaper to decompose,
+    // can be decomposed concurrently and are not decomposed again while they are unchanged.
+    if (J.rows() > 0 && parallelComponents && debugMode != IterationLevel &&
+        diagnoseComponents(J, jacobianconstraintmap, pdiagnoselist))
+        return dofs;
+
     if(qrAlgorithm==EigenDenseQR){
     #ifdef PROFILE_DIAGNOSE
         Base::TimeInfo DenseQR_start_time;
@@ -4240,7 +4381,8 @@ void System::identifyDependentParametersDenseQR( const Eigen::MatrixXd &J,
 
     makeDenseQRDecomposition( J, jacobianconstraintmap, qrJ, rank, Rparams, false, true);
 
-    identifyDependentParameters(qrJ, Rparams, rank, pdiagnoselist, silent);
+    identifyDependentParameters(qrJ, Rparams, rank, pdiagnoselist,
+                                pDependentParametersGroups, pDependentParameters, silent);
 }
 
 #ifdef EIGEN_SPARSEQR_COMPATIBLE
@@ -4256,7 +4398,8 @@ void System::identifyDependentParametersSparseQR( const Eigen::MatrixXd &J,
 
     makeSparseQRDecomposition( J, jacobianconstraintmap, SqrJ, nontransprank, Rparams, false, true); // do not transpose allow to diagnose parameters
 
-    identifyDependentParameters(SqrJ, Rparams, nontransprank, pdiagnoselist, silent);
+    identifyDependentParameters(SqrJ, Rparams, nontransprank, pdiagnoselist,
+                                pDependentParametersGroups, pDependentParameters, silent);
 }
 #endif
 
@@ -4265,6 +4408,8 @@ void System::identifyDependentParameters(   T & qrJ,
                                             Eigen::MatrixXd &Rparams,
                                             int rank,
                                             const GCS::VEC_pD &pdiagnoselist,
+                                            std::vector< std::vector<double *> > &dependentParametersGroups,
+                                            VEC_pD &dependentParameters,
                                             bool silent)
 {
     (void) silent; // silent is only used in debug code, but it is important as Base::Console is not thread-safe. Removes warning in non Debug mode.
@@ -4279,32 +4424,193 @@ void System::identifyDependentParameters(   T & qrJ,
         SolverReportingManager::Manager().LogMatrix("Rparams_nonzeros_over_pilot", Rparams);
 #endif
 
-    pDependentParametersGroups.resize(qrJ.cols()-rank);
+    dependentParametersGroups.resize(qrJ.cols()-rank);
     for (int j=rank; j < qrJ.cols(); j++) {
         for (int row=0; row < rank; row++) {
             if (fabs(Rparams(row,j)) > 1e-10) {
                 int origCol = qrJ.colsPermutation().indices()[row];
 
-                pDependentParametersGroups[j-rank].push_back(pdiagnoselist[origCol]);
-                pDependentParameters.push_back(pdiagnoselist[origCol]);
+                dependentParametersGroups[j-rank].push_back(pdiagnoselist[origCol]);
+                dependentParameters.push_back(pdiagnoselist[origCol]);
             }
         }
         int origCol = qrJ.colsPermutation().indices()[j];
 
-        pDependentParametersGroups[j-rank].push_back(pdiagnoselist[origCol]);
-        pDependentParameters.push_back(pdiagnoselist[origCol]);
+        dependentParametersGroups[j-rank].push_back(pdiagnoselist[origCol]);
+        dependentParameters.push_back(pdiagnoselist[origCol]);
     }
 
 #ifdef _GCS_DEBUG
     if(!silent) {
         SolverReportingManager::Manager().LogMatrix("PermMatrix", (Eigen::MatrixXd)qrJ.colsPermutation());
 
-        SolverReportingManager::Manager().LogGroupOfParameters("ParameterGroups",pDependentParametersGroups);
+        SolverReportingManager::Manager().LogGroupOfParameters("ParameterGroups",dependentParametersGroups);
     }
 
 #endif
 }
 
+bool System::diagnoseComponents(const Eigen::MatrixXd &J,
+                                const std::map<int,int> &jacobianconstraintmap,
+                                const GCS::VEC_pD &pdiagnoselist)
+{
+    int rowsNum = int(jacobianconstraintmap.size());
+    int colsNum = int(pdiagnoselist.size());
+
+    // union-find over the rows (constraints) and columns (parameters) coupled by a non zero entry
+    std::vector<int> parent(rowsNum + colsNum);
+    for (int i=0; i < int(parent.size()); i++)
+        parent[i] = i;
+    auto findRoot = [&parent](int i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+    for (int i=0; i < rowsNum; i++) {
+        for (int j=0; j < colsNum; j++) {
+            if (J(i,j) != 0.) {
+                int ri = findRoot(i), rj = findRoot(rowsNum + j);
+                if (ri != rj)
+                    parent[rj] = ri;
+            }
+        }
+    }
+
+    std::map<int,int> blockIndex; // root to block
+    std::vector<VEC_I> blockRows, blockCols;
+    VEC_I freeCols; // parameters not touched by any driving constraint
+    for (int i=0; i < rowsNum; i++) {
+        int root = findRoot(i);
+        auto it = blockIndex.find(root);
+        if (it == blockIndex.end()) {
+            it = blockIndex.insert(std::make_pair(root, int(blockRows.size()))).first;
+            blockRows.push_back(VEC_I());
+            blockCols.push_back(VEC_I());
+        }
+        blockRows[it->second].push_back(i);
+    }
+    if (blockRows.empty())
+        return false;
+
+    for (int j=0; j < colsNum; j++) {
+        auto it = blockIndex.find(findRoot(rowsNum + j));
+        if (it != blockIndex.end())
+            blockCols[it->second].push_back(j);
+        else
+            freeCols.push_back(j);
+    }
+
+    std::vector<BlockDiagnosis> blocks(blockRows.size());
+    VEC_I changed; // blocks not found unchanged in the cache
+
+    for (int b=0; b < int(blocks.size()); b++) {
+        const VEC_I &rows = blockRows[b];
+        BlockDiagnosis &block = blocks[b];
+        block.cols = blockCols[b];
+        block.algorithm = qrAlgorithm;
+        block.pivotThreshold = qrpivotThreshold;
+        block.J.resize(rows.size(), block.cols.size());
+        for (int r=0; r < int(rows.size()); r++) {
+            for (int c=0; c < int(block.cols.size()); c++)
+                block.J(r,c) = J(rows[r], block.cols[c]);
+        }
+
+        auto cached = block.cols.empty() ? blockDiagnosisCache.end()
+                                         : blockDiagnosisCache.find(block.cols.front());
+        if (cached != blockDiagnosisCache.end() && cached->second.cols == block.cols &&
+            cached->second.algorithm == block.algorithm &&
+            cached->second.pivotThreshold == block.pivotThreshold &&
+            cached->second.J.rows() == block.J.rows() && cached->second.J == block.J)
+            block = cached->second;
+        else
+            changed.push_back(b);
+    }
+
+    VEC_I indices(changed.size());
+    for (int i=0; i < int(indices.size()); i++)
+        indices[i] = i;
+    QtConcurrent::blockingMap(indices, [&](int i) {
+        BlockDiagnosis &block = blocks[changed[i]];
+        const Eigen::MatrixXd &Jb = block.J;
+
+        std::map<int,int> rowmap;
+        for (int r=0; r < int(Jb.rows()); r++)
+            rowmap[r] = r;
+        GCS::VEC_pD params(block.cols.size());
+        std::map<double *,int> paramcols;
+        for (int c=0; c < int(block.cols.size()); c++) {
+            params[c] = pdiagnoselist[block.cols[c]];
+            paramcols[params[c]] = block.cols[c];
+        }
+
+        std::vector< std::vector<double *> > groups;
+        VEC_pD parameters;
+        Eigen::MatrixXd R, Rparams;
+        int paramsrank = 0;
+#ifdef EIGEN_SPARSEQR_COMPATIBLE
+        if (qrAlgorithm == EigenSparseQR) {
+            Eigen::SparseQR<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > SqrJT, SqrJ;
+            makeSparseQRDecomposition(Jb, rowmap, SqrJT, block.rank, R, /*transposed=*/true, /*silent=*/true);
+            if (int(Jb.rows()) > block.rank) {
+                block.dependentConstraints = true;
+                return;
+            }
+            makeSparseQRDecomposition(Jb, rowmap, SqrJ, paramsrank, Rparams, /*transposed=*/false, /*silent=*/true);
+            identifyDependentParameters(SqrJ, Rparams, paramsrank, params, groups, parameters, true);
+        }
+        else
+#endif
+        {
+            Eigen::FullPivHouseholderQR<Eigen::MatrixXd> qrJT, qrJ;
+            makeDenseQRDecomposition(Jb, rowmap, qrJT, block.rank, R, /*transposed=*/true, /*silent=*/true);
+            if (int(Jb.rows()) > block.rank) {
+                block.dependentConstraints = true;
+                return;
+            }
+            makeDenseQRDecomposition(Jb, rowmap, qrJ, paramsrank, Rparams, /*transposed=*/false, /*silent=*/true);
+            identifyDependentParameters(qrJ, Rparams, paramsrank, params, groups, parameters, true);
+        }
+
+        for (const std::vector<double *> &group : groups) {
+            block.groups.push_back(VEC_I());
+            for (double *param : group)
+                block.groups.back().push_back(paramcols[param]);
+        }
+        for (double *param : parameters)
+            block.parameters.push_back(paramcols[param]);
+    });
+
+    blockDiagnosisCache.clear();
+    for (const BlockDiagnosis &block : blocks) {
+        if (!block.cols.empty())
+            blockDiagnosisCache[block.cols.front()] = block;
+    }
+
+    int rank = 0;
+    for (const BlockDiagnosis &block : blocks) {
+        if (block.dependentConstraints)
+            return false;
+        rank += block.rank;
+    }
+
+    for (const BlockDiagnosis &block : blocks) {
+        for (const VEC_I &group : block.groups) {
+            pDependentParametersGroups.push_back(std::vector<double *>());
+            for (int j : group)
+                pDependentParametersGroups.back().push_back(pdiagnoselist[j]);
+        }
+        for (int j : block.parameters)
+            pDependentParameters.push_back(pdiagnoselist[j]);
+    }
+    for (int j : freeCols) {
+        pDependentParametersGroups.push_back(std::vector<double *>(1, pdiagnoselist[j]));
+        pDependentParameters.push_back(pdiagnoselist[j]);
+    }
+
+    dofs = colsNum - rank;
+    return true;
+}
+
 void System::identifyDependentGeometryParametersInTransposedJacobianDenseQRDecomposition(
                         const Eigen::FullPivHouseholderQR<Eigen::MatrixXd>& qrJT,
                         const GCS::VEC_pD &pdiagnoselist,
@@ -113,11 +113,14 @@ namespace GCS
         std::map<double *,std::vector<Constraint *> > p2c; // parameter to constraint adjacency list
 
         std::vector<SubSystem *> subSystems, subSystemsAux;
+        VEC_I subSystemsStatus; // result of the last solve of each decoupled component
         void clearSubSystems();
 
         VEC_D reference;
         void setReference();     // copies the current parameter values to reference
         void resetToReference(); // reverts all parameter values to the stored reference
+        // indices of the decoupled components solve() and applySolution() work on
+        void getSolvedComponents(VEC_I &cids) const;
 
         std::vector< VEC_pD > plists;                    // partitioned plist except equality constraints
         std::vector< std::vector<Constraint *> > clists; // partitioned clist except equality constraints
@@ -133,6 +136,23 @@ namespace GCS
 
         bool emptyDiagnoseMatrix; // false only if there is at least one driving constraint.
 
+        // Diagnosis of a decoupled block of the reduced jacobian. The parameters are stored as
+        // columns of pdiagnoselist, which is stable across setUp of an unchanged geometry.
+        struct BlockDiagnosis {
+            VEC_I cols;
+            Eigen::MatrixXd J;
+            QRAlgorithm algorithm = EigenDenseQR;
+            double pivotThreshold = 0.;
+            int rank = 0;
+            bool dependentConstraints = false;
+            std::vector<VEC_I> groups;
+            VEC_I parameters;
+        };
+        // blocks of the last diagnosis, keyed by their first column. The system is cleared
+        // on every setUp, but this cache is kept so that blocks untouched by an edit are
+        // not decomposed again.
+        std::map<int, BlockDiagnosis> blockDiagnosisCache;
+
         int solve_BFGS(SubSystem *subsys, bool isFine=true, bool isRedundantsolving=false);
         int solve_LM(SubSystem *subsys, bool isRedundantsolving=false);
         int solve_DL(SubSystem *subsys, bool isRedundantsolving=false);
@@ -189,8 +209,17 @@ namespace GCS
                                             Eigen::MatrixXd &Rparams,
                                             int rank,
                                             const GCS::VEC_pD &pdiagnoselist,
+                                            std::vector< std::vector<double *> > &dependentParametersGroups,
+                                            VEC_pD &dependentParameters,
                                             bool silent=true);
 
+        // Diagnoses the decoupled blocks of the reduced jacobian concurrently, reusing the cached
+        // diagnosis of unchanged blocks. Returns false without touching the diagnosis if any block
+        // has redundant or conflicting constraints, which have to be identified on the whole system.
+        bool diagnoseComponents(const Eigen::MatrixXd &J,
+                                const std::map<int,int> &jacobianconstraintmap,
+                                const GCS::VEC_pD &pdiagnoselist);
+
         #ifdef _GCS_EXTRACT_SOLVER_SUBSYSTEM_
         void extractSubsystem(SubSystem *subsys, bool isRedundantsolving);
         #endif
@@ -205,6 +234,10 @@ namespace GCS
         DogLegGaussStep dogLegGaussStep;
         double qrpivotThreshold;
         DebugMode debugMode;
+        bool parallelComponents; // solve and diagnose decoupled components concurrently
+        // while dragging, solve and apply only the components holding temporary
+        // constraints; the other components are left untouched at their reference values
+        bool solveTemporaryComponentsOnly;
         double LM_eps;
         double LM_eps1;
         double LM_tau;
@@ -217,6 +250,11 @@ namespace GCS
         double DL_tolgRedundant;
         double DL_tolxRedundant;
         double DL_tolfRedundant;
+        // LM and DL assemble a sparse jacobian and factorize the sparse normal
+        // equations once the subsystem jacobian has more than this many entries
+        // (constraints times parameters); 0 disables the sparse path. DL only
+        // does so with the LeastNormLdlt gauss step.
+        int sparseSolverThreshold;
 
     public:
         System();
@@ -349,11 +387,18 @@ namespace GCS
 
         void applySolution();
         void undoSolution();
+        // makes the current parameter values the starting point of the next solve
+        void updateReference() { setReference(); }
+        // unknown parameters of the components solve() works on (including reduced ones)
+        void getSolvedParams(VEC_pD &params) const;
         //FIXME: looks like XconvergenceFine is not the solver precision, at least in DogLeg solver.
         // Note: Yes, every solver has a different way of interpreting precision
         // but one has to study what is this needed for in order to decide
         // what to return (this is unchanged from previous versions)
         double getFinePrecision(){ return convergence;}
+        // status of each decoupled component in the last solve, in the order of the partition
+        void getSubSystemsStatus(VEC_I &statusOut) const
+          { statusOut = subSystemsStatus; }
 
         int diagnose(Algorithm alg=DogLeg);
         int dofsNumber() const { return hasDiagnosis ? dofs : -1; }
@@ -367,6 +412,8 @@ namespace GCS
           { pdependentparametergroups = pDependentParametersGroups;}
         bool isEmptyDiagnoseMatrix() const {return emptyDiagnoseMatrix;}
         void invalidatedDiagnosis();
+        // drops the decompositions kept for unchanged blocks, the next diagnosis starts from scratch
+        void clearDiagnosisCache() { blockDiagnosisCache.clear(); }
     };
 
 
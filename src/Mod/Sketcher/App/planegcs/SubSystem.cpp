@@ -258,15 +258,35 @@ void SubSystem::calcJacobi()
 }
 */
 
-void SubSystem::calcJacobi(VEC_pD &params, Eigen::MatrixXd &jacobi)
+void SubSystem::getJacobiColumns(VEC_pD &params, std::vector<std::vector<int> > &cols)
 {
-    jacobi.setZero(csize, params.size());
+    cols.assign(psize, std::vector<int>());
     for (int j=0; j < int(params.size()); j++) {
         MAP_pD_pD::const_iterator
           pmapfind = pmap.find(params[j]);
         if (pmapfind != pmap.end())
-            for (int i=0; i < csize; i++)
-                jacobi(i,j) = clist[i]->grad(pmapfind->second);
+            cols[pmapfind->second - &pvals[0]].push_back(j);
+    }
+}
+
+// Only the parameters a constraint actually depends on (c2p) can have a
+// non zero derivative, so the jacobian is filled row by row from the
+// adjacency list instead of querying every constraint for every parameter.
+void SubSystem::calcJacobi(VEC_pD &params, Eigen::MatrixXd &jacobi)
+{
+    jacobi.setZero(csize, params.size());
+    std::vector<std::vector<int> > cols;
+    getJacobiColumns(params, cols);
+    for (int i=0; i < csize; i++) {
+        const VEC_pD &cparams = c2p[clist[i]];
+        for (VEC_pD::const_iterator p=cparams.begin(); p != cparams.end(); ++p) {
+            const std::vector<int> &pcols = cols[*p - &pvals[0]];
+            if (pcols.empty())
+                continue;
+            double value = clist[i]->grad(*p);
+            for (std::vector<int>::const_iterator j=pcols.begin(); j != pcols.end(); ++j)
+                jacobi(i,*j) = value;
+        }
     }
 }
 
@@ -275,6 +295,35 @@ void SubSystem::calcJacobi(Eigen::MatrixXd &jacobi)
     calcJacobi(plist, jacobi);
 }
 
+void SubSystem::calcJacobi(VEC_pD &params, Eigen::SparseMatrix<double> &jacobi)
+{
+    std::vector<std::vector<int> > cols;
+    getJacobiColumns(params, cols);
+
+    std::vector<Eigen::Triplet<double> > triplets;
+    for (int i=0; i < csize; i++) {
+        const VEC_pD &cparams = c2p[clist[i]];
+        for (VEC_pD::const_iterator p=cparams.begin(); p != cparams.end(); ++p) {
+            const std::vector<int> &pcols = cols[*p - &pvals[0]];
+            if (pcols.empty())
+                continue;
+            double value = clist[i]->grad(*p);
+            if (value == 0.)
+                continue;
+            for (std::vector<int>::const_iterator j=pcols.begin(); j != pcols.end(); ++j)
+                triplets.push_back(Eigen::Triplet<double>(i, *j, value));
+        }
+    }
+
+    jacobi.resize(csize, params.size());
+    jacobi.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+void SubSystem::calcJacobi(Eigen::SparseMatrix<double> &jacobi)
+{
+    calcJacobi(plist, jacobi);
+}
+
 void SubSystem::calcGrad(VEC_pD &params, Eigen::VectorXd &grad)
 {
     assert(grad.size() == int(params.size()));
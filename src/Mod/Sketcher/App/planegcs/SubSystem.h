@@ -27,6 +27,7 @@
 #undef max
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 #include "Constraints.h"
 
 namespace GCS
@@ -44,6 +45,8 @@ namespace GCS
         std::map<Constraint *,VEC_pD > c2p; // constraint to parameter adjacency list
         std::map<double *,std::vector<Constraint *> > p2c; // parameter to constraint adjacency list
         void initialize(VEC_pD &params, MAP_pD_pD &reductionmap); // called by the constructors
+        // for each entry of pvals, the columns of params that are redirected to it
+        void getJacobiColumns(VEC_pD &params, std::vector<std::vector<int> > &cols);
     public:
         SubSystem(std::vector<Constraint *> &clist_, VEC_pD &params);
         SubSystem(std::vector<Constraint *> &clist_, VEC_pD &params,
@@ -71,6 +74,8 @@ namespace GCS
         void calcResidual(Eigen::VectorXd &r, double &err);
         void calcJacobi(VEC_pD &params, Eigen::MatrixXd &jacobi);
         void calcJacobi(Eigen::MatrixXd &jacobi);
+        void calcJacobi(VEC_pD &params, Eigen::SparseMatrix<double> &jacobi);
+        void calcJacobi(Eigen::SparseMatrix<double> &jacobi);
         void calcGrad(VEC_pD &params, Eigen::VectorXd &grad);
         void calcGrad(Eigen::VectorXd &grad);
 
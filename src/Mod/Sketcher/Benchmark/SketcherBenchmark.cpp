@@ -0,0 +1,537 @@
+/***************************************************************************
+ *   Copyright (c) 2020                                                    *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Times the sketch solver on generated sketches.
+ *
+ * Every sketch family is generated from a size and a seed only, so a run can be repeated on
+ * another machine or FreeCAD version and compared line by line. The geometry is slightly
+ * perturbed from a solution of the constraints, so that solving has actual work to do.
+ *
+ * Usage: SketcherBenchmark [--family all|rectangles|bsplines|ellipses|profile]
+ *                          [--size N] [--repeat N] [--seed N] [--json]
+ *
+ * The results are written to stdout, as CSV with a header line or with --json as one JSON
+ * object per line. Times are in seconds, the minimum and the median over the repetitions.
+ *
+ * The diagnosis of an unchanged sketch is timed twice: "diagnose-cold" drops the decompositions
+ * the solver keeps for unchanged blocks before every repetition, "diagnose-warm" reuses them as
+ * after an edit that doesn't touch most of the sketch. The solve phase is timed with the dense
+ * and the sparse linear algebra of LevenbergMarquardt and DogLeg, the latter with the
+ * LeastNormLdlt gauss step for both as the sparse path requires it.
+ */
+
+#include <FCConfig.h>
+
+#include <algorithm>
+#include <chrono>
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <Base/Console.h>
+#include <Base/Exception.h>
+#include <Base/Interpreter.h>
+#include <App/Application.h>
+#include <Mod/Part/App/Geometry.h>
+#include <Mod/Sketcher/App/Constraint.h>
+#include <Mod/Sketcher/App/GeometryFacade.h>
+#include <Mod/Sketcher/App/Sketch.h>
+
+using namespace Sketcher;
+
+namespace {
+
+/// Portable pseudo random numbers, std distributions differ between standard libraries
+class Random
+{
+public:
+    explicit Random(std::uint64_t seed) : state(seed) {}
+
+    /// uniform in [-amplitude, amplitude)
+    double jitter(double amplitude)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return amplitude * (2. * double(state >> 11) / 9007199254740992. - 1.);
+    }
+
+    Base::Vector3d jitter(const Base::Vector3d &point, double amplitude)
+    {
+        double dx = jitter(amplitude);
+        double dy = jitter(amplitude);
+        return Base::Vector3d(point.x + dx, point.y + dy, 0.);
+    }
+
+private:
+    std::uint64_t state;
+};
+
+/// A sketch as SketchObject hands it to the solver: internal geometry followed by the axes
+class GeneratedSketch
+{
+public:
+    GeneratedSketch() = default;
+    GeneratedSketch(const GeneratedSketch&) = delete;
+    GeneratedSketch& operator=(const GeneratedSketch&) = delete;
+
+    ~GeneratedSketch()
+    {
+        for (Part::Geometry *geo : geometry)
+            delete geo;
+        for (Constraint *constr : constraints)
+            delete constr;
+    }
+
+    int addGeometry(Part::Geometry *geo)
+    {
+        GeometryFacade::ensureSketchGeometryExtension(geo);
+        geometry.push_back(geo);
+        return int(geometry.size()) - 1;
+    }
+
+    void addConstraint(ConstraintType type, int first, PointPos firstPos,
+                       int second = Constraint::GeoUndef, PointPos secondPos = none,
+                       double value = 0.)
+    {
+        Constraint *constr = new Constraint();
+        constr->Type = type;
+        constr->First = first;
+        constr->FirstPos = firstPos;
+        constr->Second = second;
+        constr->SecondPos = secondPos;
+        constr->setValue(value);
+        constraints.push_back(constr);
+    }
+
+    /// the external geometry of every sketch, in the order of SketchObject::getCompleteGeometry
+    void addAxes()
+    {
+        Part::GeomLineSegment *vline = new Part::GeomLineSegment();
+        vline->setPoints(Base::Vector3d(0,0,0), Base::Vector3d(0,1,0));
+        Part::GeomLineSegment *hline = new Part::GeomLineSegment();
+        hline->setPoints(Base::Vector3d(0,0,0), Base::Vector3d(1,0,0));
+        addGeometry(vline);
+        addGeometry(hline);
+        GeometryFacade::setConstruction(vline, true);
+        GeometryFacade::setConstruction(hline, true);
+    }
+
+    static const int extGeoCount = 2;
+
+    std::vector<Part::Geometry *> geometry;
+    std::vector<Constraint *> constraints;
+};
+
+Part::GeomLineSegment *makeLine(const Base::Vector3d &start, const Base::Vector3d &end)
+{
+    Part::GeomLineSegment *line = new Part::GeomLineSegment();
+    line->setPoints(start, end);
+    return line;
+}
+
+/// size x size fully constrained rectangles, each one a decoupled component
+void makeRectangles(GeneratedSketch &sketch, int size, Random &random)
+{
+    const double width = 8., height = 5., pitch = 10., noise = 0.3;
+
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            Base::Vector3d corner[4] = {
+                Base::Vector3d(i * pitch, j * pitch, 0),
+                Base::Vector3d(i * pitch + width, j * pitch, 0),
+                Base::Vector3d(i * pitch + width, j * pitch + height, 0),
+                Base::Vector3d(i * pitch, j * pitch + height, 0)
+            };
+            int side[4];
+            for (int k = 0; k < 4; k++)
+                side[k] = sketch.addGeometry(makeLine(random.jitter(corner[k], noise),
+                                                      random.jitter(corner[(k + 1) % 4], noise)));
+
+            for (int k = 0; k < 4; k++)
+                sketch.addConstraint(Coincident, side[k], end, side[(k + 1) % 4], start);
+            sketch.addConstraint(Horizontal, side[0], none);
+            sketch.addConstraint(Horizontal, side[2], none);
+            sketch.addConstraint(Vertical, side[1], none);
+            sketch.addConstraint(Vertical, side[3], none);
+            sketch.addConstraint(DistanceX, side[0], start, side[0], end, width);
+            sketch.addConstraint(DistanceY, side[1], start, side[1], end, height);
+            sketch.addConstraint(DistanceX, side[0], start, Constraint::GeoUndef, none, corner[0].x);
+            sketch.addConstraint(DistanceY, side[0], start, Constraint::GeoUndef, none, corner[0].y);
+        }
+    }
+}
+
+/// a chain of size * size cubic B-splines joined end to start
+void makeBSplines(GeneratedSketch &sketch, int size, Random &random)
+{
+    const int count = size * size;
+    const double span = 3., amplitude = 1., noise = 0.2;
+
+    int previous = Constraint::GeoUndef;
+    for (int i = 0; i < count; i++) {
+        std::vector<Base::Vector3d> poles;
+        for (int k = 0; k < 4; k++) {
+            double x = i * span + k * span / 3.;
+            poles.push_back(random.jitter(Base::Vector3d(x, amplitude * std::sin(x), 0), noise));
+        }
+        std::vector<double> weights(4, 1.);
+        std::vector<double> knots = {0., 1.};
+        std::vector<int> multiplicities = {4, 4};
+
+        int spline = sketch.addGeometry(new Part::GeomBSplineCurve(poles, weights, knots, multiplicities, 3));
+        if (previous == Constraint::GeoUndef) {
+            sketch.addConstraint(DistanceX, spline, start, Constraint::GeoUndef, none, 0.);
+            sketch.addConstraint(DistanceY, spline, start, Constraint::GeoUndef, none, 0.);
+        }
+        else {
+            sketch.addConstraint(Coincident, previous, end, spline, start);
+        }
+        previous = spline;
+    }
+}
+
+/// a row of size * size equal ellipses whose centers are linked by lines
+void makeEllipses(GeneratedSketch &sketch, int size, Random &random)
+{
+    const int count = size * size;
+    const double pitch = 8., noise = 0.2;
+
+    std::vector<int> ellipses;
+    std::vector<Base::Vector3d> centers;
+    for (int i = 0; i < count; i++) {
+        Base::Vector3d center(i * pitch, (i % 2) * pitch / 2, 0);
+        double angle = random.jitter(M_PI);
+
+        Part::GeomEllipse *ellipse = new Part::GeomEllipse();
+        ellipse->setCenter(random.jitter(center, noise));
+        ellipse->setMajorRadius(3. + random.jitter(noise));
+        ellipse->setMinorRadius(1.5 + random.jitter(noise));
+        ellipse->setMajorAxisDir(Base::Vector3d(std::cos(angle), std::sin(angle), 0));
+
+        ellipses.push_back(sketch.addGeometry(ellipse));
+        centers.push_back(center);
+    }
+
+    for (int i = 0; i < count; i++) {
+        sketch.addConstraint(DistanceX, ellipses[i], mid, Constraint::GeoUndef, none, centers[i].x);
+        sketch.addConstraint(DistanceY, ellipses[i], mid, Constraint::GeoUndef, none, centers[i].y);
+        if (i + 1 < count) {
+            int link = sketch.addGeometry(makeLine(random.jitter(centers[i], noise),
+                                                   random.jitter(centers[i + 1], noise)));
+            sketch.addConstraint(Coincident, link, start, ellipses[i], mid);
+            sketch.addConstraint(Coincident, link, end, ellipses[i + 1], mid);
+            sketch.addConstraint(Equal, ellipses[i], none, ellipses[i + 1], none);
+        }
+    }
+}
+
+/// a closed profile of size * size edges, lines and outward arcs, dimensioned like an
+/// imported drawing: lengths and radii, but no angles, so it is not fully constrained
+void makeProfile(GeneratedSketch &sketch, int size, Random &random)
+{
+    const int count = std::max(3, size * size);
+    const double radius = count, noise = 0.2;
+
+    std::vector<Base::Vector3d> vertices;
+    for (int k = 0; k < count; k++) {
+        double angle = 2 * M_PI * k / count;
+        vertices.emplace_back(radius * std::cos(angle), radius * std::sin(angle), 0);
+    }
+
+    std::vector<int> edges;
+    for (int k = 0; k < count; k++) {
+        const Base::Vector3d &a = vertices[k];
+        const Base::Vector3d &b = vertices[(k + 1) % count];
+
+        if (k % 4 == 3) {
+            // the center lies inside the profile, so the arc bulges outwards and runs
+            // counterclockwise from a to b like the profile itself
+            Base::Vector3d middle = (a + b) / 2;
+            Base::Vector3d center = middle - middle / middle.Length() * (b - a).Length();
+            double arcRadius = (a - center).Length();
+
+            Part::GeomArcOfCircle *arc = new Part::GeomArcOfCircle();
+            arc->setCenter(random.jitter(center, noise));
+            arc->setRadius(arcRadius + random.jitter(noise));
+            arc->setRange(std::atan2(a.y - center.y, a.x - center.x),
+                          std::atan2(b.y - center.y, b.x - center.x), /*emulateCCWXY=*/true);
+            edges.push_back(sketch.addGeometry(arc));
+            sketch.addConstraint(Radius, edges.back(), none, Constraint::GeoUndef, none, arcRadius);
+        }
+        else {
+            edges.push_back(sketch.addGeometry(makeLine(random.jitter(a, noise), random.jitter(b, noise))));
+            sketch.addConstraint(Distance, edges.back(), none, Constraint::GeoUndef, none, (b - a).Length());
+        }
+    }
+
+    for (int k = 0; k < count; k++)
+        sketch.addConstraint(Coincident, edges[k], end, edges[(k + 1) % count], start);
+    sketch.addConstraint(DistanceX, edges[0], start, Constraint::GeoUndef, none, vertices[0].x);
+    sketch.addConstraint(DistanceY, edges[0], start, Constraint::GeoUndef, none, vertices[0].y);
+}
+
+struct Family {
+    const char *name;
+    void (*generate)(GeneratedSketch &, int, Random &);
+};
+
+const Family families[] = {
+    {"rectangles", makeRectangles},
+    {"bsplines", makeBSplines},
+    {"ellipses", makeEllipses},
+    {"profile", makeProfile},
+};
+
+struct Options {
+    std::string family = "all";
+    int size = 10;
+    int repeat = 5;
+    std::uint64_t seed = 1;
+    bool json = false;
+};
+
+struct Result {
+    std::string family;
+    int size;
+    std::size_t geometries;
+    std::size_t constraints;
+    std::string phase;
+    std::string solver;
+    std::string qr;
+    std::string linear; // dense or sparse linear algebra of the solve phase
+    std::vector<double> times;
+    int dofs;
+    std::size_t conflicting;
+    std::size_t redundant;
+    int status; // return value of Sketch::solve, 0 for the other phases
+};
+
+double elapsed(const std::function<void()> &func)
+{
+    auto begin = std::chrono::steady_clock::now();
+    func();
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - begin;
+    return time.count();
+}
+
+void report(const Result &result, bool json, bool header)
+{
+    std::vector<double> times = result.times;
+    std::sort(times.begin(), times.end());
+    double min = times.front();
+    double median = times[times.size() / 2];
+
+    if (json) {
+        std::cout << "{\"family\":\"" << result.family << "\",\"size\":" << result.size
+                  << ",\"geometries\":" << result.geometries << ",\"constraints\":" << result.constraints
+                  << ",\"phase\":\"" << result.phase << "\",\"solver\":\"" << result.solver
+                  << "\",\"qr\":\"" << result.qr << "\",\"linear\":\"" << result.linear
+                  << "\",\"repeats\":" << times.size()
+                  << ",\"min_s\":" << min << ",\"median_s\":" << median
+                  << ",\"dofs\":" << result.dofs << ",\"conflicting\":" << result.conflicting
+                  << ",\"redundant\":" << result.redundant << ",\"status\":" << result.status << "}\n";
+        return;
+    }
+
+    if (header)
+        std::cout << "family,size,geometries,constraints,phase,solver,qr,linear,repeats,min_s,"
+                     "median_s,dofs,conflicting,redundant,status\n";
+    std::cout << result.family << ',' << result.size << ',' << result.geometries << ','
+              << result.constraints << ',' << result.phase << ',' << result.solver << ','
+              << result.qr << ',' << result.linear << ',' << times.size() << ',' << min << ',' << median << ','
+              << result.dofs << ',' << result.conflicting << ',' << result.redundant << ','
+              << result.status << '\n';
+}
+
+void runFamily(const Family &family, const Options &options, bool &header)
+{
+    Random random(options.seed);
+    GeneratedSketch generated;
+    family.generate(generated, options.size, random);
+    generated.addAxes();
+
+    const struct { GCS::QRAlgorithm algorithm; const char *name; } qrAlgorithms[] = {
+        {GCS::EigenDenseQR, "dense"},
+        {GCS::EigenSparseQR, "sparse"},
+    };
+    const struct { GCS::Algorithm algorithm; const char *name; bool sparse; } solvers[] = {
+        {GCS::DogLeg, "DogLeg", true},
+        {GCS::LevenbergMarquardt, "LevenbergMarquardt", true},
+        {GCS::BFGS, "BFGS", false},
+    };
+    // the sparse path is taken above the threshold, 0 disables it
+    const struct { int threshold; const char *name; } linearAlgebra[] = {
+        {0, "dense"},
+        {1, "sparse"},
+    };
+
+    auto newResult = [&](const char *phase, const char *solver, const char *qr) {
+        Result result;
+        result.family = family.name;
+        result.size = options.size;
+        result.geometries = generated.geometry.size() - GeneratedSketch::extGeoCount;
+        result.constraints = generated.constraints.size();
+        result.phase = phase;
+        result.solver = solver;
+        result.qr = qr;
+        result.dofs = 0;
+        result.conflicting = 0;
+        result.redundant = 0;
+        result.status = 0;
+        return result;
+    };
+    auto setUp = [&](Sketch &sketch) {
+        return sketch.setUpSketch(generated.geometry, generated.constraints, GeneratedSketch::extGeoCount);
+    };
+
+    for (const auto &qr : qrAlgorithms) {
+        // set up, including the diagnosis, of a new sketch as on every recompute
+        Result result = newResult("setup", "", qr.name);
+        for (int i = 0; i < options.repeat; i++) {
+            Sketch sketch;
+            sketch.setQRAlgorithm(qr.algorithm);
+            result.times.push_back(elapsed([&]() { result.dofs = setUp(sketch); }));
+            result.conflicting = sketch.getConflicting().size();
+            result.redundant = sketch.getRedundant().size();
+        }
+        report(result, options.json, header);
+        header = false;
+
+        // diagnosis of an already set up sketch, as after adding a constraint, without and
+        // with the decompositions kept from the previous diagnosis
+        for (bool warm : {false, true}) {
+            result = newResult(warm ? "diagnose-warm" : "diagnose-cold", "", qr.name);
+            Sketch diagnosed;
+            diagnosed.setQRAlgorithm(qr.algorithm);
+            setUp(diagnosed);
+            for (int i = 0; i < options.repeat; i++) {
+                if (!warm)
+                    diagnosed.clearDiagnosisCache();
+                result.times.push_back(elapsed([&]() { result.dofs = diagnosed.rediagnose(); }));
+            }
+            result.conflicting = diagnosed.getConflicting().size();
+            result.redundant = diagnosed.getRedundant().size();
+            report(result, options.json, header);
+        }
+
+        for (const auto &solver : solvers) {
+            for (const auto &linear : linearAlgebra) {
+                if (linear.threshold > 0 && !solver.sparse)
+                    continue;
+                result = newResult("solve", solver.name, qr.name);
+                if (solver.sparse)
+                    result.linear = linear.name;
+                for (int i = 0; i < options.repeat; i++) {
+                    Sketch sketch;
+                    sketch.setQRAlgorithm(qr.algorithm);
+                    sketch.setSparseSolverThreshold(linear.threshold);
+                    if (solver.algorithm == GCS::DogLeg)
+                        sketch.setDogLegGaussStep(GCS::LeastNormLdlt);
+                    sketch.defaultSolver = solver.algorithm;
+                    result.dofs = setUp(sketch);
+                    result.times.push_back(elapsed([&]() { result.status = sketch.solve(); }));
+                    result.conflicting = sketch.getConflicting().size();
+                    result.redundant = sketch.getRedundant().size();
+                }
+                report(result, options.json, header);
+            }
+        }
+    }
+}
+
+bool parseOptions(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--family" && hasValue)
+            options.family = argv[++i];
+        else if (arg == "--size" && hasValue)
+            options.size = std::atoi(argv[++i]);
+        else if (arg == "--repeat" && hasValue)
+            options.repeat = std::atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue)
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--json")
+            options.json = true;
+        else
+            return false;
+    }
+
+    if (options.size < 1 || options.repeat < 1)
+        return false;
+    if (options.family == "all")
+        return true;
+    for (const Family &family : families) {
+        if (options.family == family.name)
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    // Make sure that we use '.' as decimal point
+    setlocale(LC_ALL, "");
+    setlocale(LC_NUMERIC, "C");
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--family all|rectangles|bsplines|ellipses|profile]"
+                     " [--size N] [--repeat N] [--seed N] [--json]\n";
+        return 2;
+    }
+
+    App::Application::Config()["ExeName"] = "FreeCAD";
+    App::Application::Config()["ExeVendor"] = "FreeCAD";
+    App::Application::Config()["AppDataSkipVendor"] = "true";
+    App::Application::Config()["RunMode"] = "Exit";
+
+    try {
+        // the benchmark options are not FreeCAD options
+        int appArgc = 1;
+        App::Application::init(appArgc, argv);
+        // registers the types of the Part and Sketcher geometries and constraints
+        Base::Interpreter().loadModule("Sketcher");
+
+        bool header = true;
+        for (const Family &family : families) {
+            if (options.family == "all" || options.family == family.name)
+                runFamily(family, options, header);
+        }
+    }
+    catch (const Base::Exception &e) {
+        std::cerr << "SketcherBenchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+
+    App::Application::destruct();
+    return 0;
+}
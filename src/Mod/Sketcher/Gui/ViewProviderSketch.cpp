@@ -176,6 +176,13 @@ SbVec2s ViewProviderSketch::newCursorPos;
 //**************************************************************************
 // Edit data structure
 
+/// A constraint icon as rendered by renderConstrIcon()
+struct RenderedConstrIcon {
+    QImage image;
+    std::vector<QRect> boundingBoxes;
+    int vPad;
+};
+
 /// Data structure while editing the sketch
 struct EditData {
     EditData():
@@ -263,6 +270,11 @@ struct EditData {
     // constraint IDs.
     std::map<QString, ViewProviderSketch::ConstrIconBBVec> combinedConstrBoxes;
 
+    // Constraint icons rendered during this edit session, keyed by everything that goes into
+    // the image. Most icons look the same from one redraw to the next, so the svg rasterization
+    // and label painting are only done when an icon changes.
+    std::map<QString, RenderedConstrIcon> renderedConstrIcons;
+
     // nodes for the visuals
     SoSeparator   *EditRoot;
     SoMaterial    *PointsMaterials;
@@ -3260,7 +3272,18 @@ void ViewProviderSketch::sendConstraintIconToCoin(const QImage &icon, SoImage *s
     SbVec2s iconSize(icon.width(), icon.height());
 
     int four = 4;
-    soImagePtr->image.setValue(iconSize, 4, icondata.getValue(iconSize, four));
+    const unsigned char *bytes = icondata.getValue(iconSize, four);
+
+    // do not touch the node if it already shows this icon, as every change of the image
+    // makes Coin upload a new texture on the next redraw
+    SbVec2s currentSize;
+    int currentComponents = 0;
+    const unsigned char *currentBytes = soImagePtr->image.getValue(currentSize, currentComponents);
+    if (currentSize == iconSize && currentComponents == 4 && currentBytes && bytes &&
+        memcmp(currentBytes, bytes, size_t(iconSize[0]) * iconSize[1] * 4) == 0)
+        return;
+
+    soImagePtr->image.setValue(iconSize, 4, bytes);
 
     //Set Image Alignment to Center
     soImagePtr->vertAlignment = SoImage::HALF;
@@ -3526,12 +3549,15 @@ void ViewProviderSketch::combineConstraintIcons(IconQueue iconQueue)
 
 void ViewProviderSketch::drawMergedConstraintIcons(IconQueue iconQueue)
 {
+    SoImage *thisDest = iconQueue[0].destination;
+    // the composite icon is sent to the first destination, which is not cleared so
+    // that it can be left untouched if the composite did not change
     for(IconQueue::iterator i = iconQueue.begin(); i != iconQueue.end(); ++i) {
-        clearCoinImage(i->destination);
+        if (i->destination != thisDest)
+            clearCoinImage(i->destination);
     }
 
     QImage compositeIcon;
-    SoImage *thisDest = iconQueue[0].destination;
     SoInfo *thisInfo = iconQueue[0].infoPtr;
 
     // Tracks all constraint IDs that are combined into this icon
@@ -3678,17 +3704,42 @@ QImage ViewProviderSketch::renderConstrIcon(const QString &type,
     // Constants to help create constraint icons
     QString joinStr = QString::fromLatin1(", ");
 
-    QImage icon = Gui::BitmapFactory().pixmapFromSvg(type.toLatin1().data(),QSizeF(edit->constraintIconSize,edit->constraintIconSize)).toImage();
-
     QFont font = QApplication::font();
     font.setPixelSize(static_cast<int>(0.8 * edit->constraintIconSize));
     font.setBold(true);
+
+    QString key = QString::fromLatin1("%1\n%2\n%3\n%4\n%5").arg(type)
+                                                            .arg(iconColor.rgba())
+                                                            .arg(iconRotation)
+                                                            .arg(edit->constraintIconSize)
+                                                            .arg(font.key());
+    for (int i = 0; i < labels.size() && i < labelColors.size(); i++)
+        key += QString::fromLatin1("\n%1\n%2").arg(labels[i]).arg(labelColors[i].rgba());
+
+    auto rendered = edit->renderedConstrIcons.find(key);
+    if (rendered != edit->renderedConstrIcons.end()) {
+        if(boundingBoxes)
+            boundingBoxes->insert(boundingBoxes->end(), rendered->second.boundingBoxes.begin(),
+                                                        rendered->second.boundingBoxes.end());
+        if(vPad)
+            *vPad = rendered->second.vPad;
+        return rendered->second.image;
+    }
+
+    QImage icon = Gui::BitmapFactory().pixmapFromSvg(type.toLatin1().data(),QSizeF(edit->constraintIconSize,edit->constraintIconSize)).toImage();
+
     QFontMetrics qfm = QFontMetrics(font);
 
+    // icons keyed by their labels accumulate while editing, keep the cache bounded
+    if (edit->renderedConstrIcons.size() > 2000)
+        edit->renderedConstrIcons.clear();
+    RenderedConstrIcon &cached = edit->renderedConstrIcons[key];
+
     int labelWidth = qfm.boundingRect(labels.join(joinStr)).width();
     // See Qt docs on qRect::bottom() for explanation of the +1
     int pxBelowBase = qfm.boundingRect(labels.join(joinStr)).bottom() + 1;
 
+    cached.vPad = pxBelowBase;
     if(vPad)
         *vPad = pxBelowBase;
 
@@ -3700,8 +3751,7 @@ QImage ViewProviderSketch::renderConstrIcon(const QString &type,
                                                         roticon.height() + pxBelowBase);
 
     // Make a bounding box for the icon
-    if(boundingBoxes)
-        boundingBoxes->push_back(QRect(0, 0, roticon.width(), roticon.height()));
+    cached.boundingBoxes.push_back(QRect(0, 0, roticon.width(), roticon.height()));
 
     // Render the Icons
     QPainter qp(&image);
@@ -3737,17 +3787,20 @@ QImage ViewProviderSketch::renderConstrIcon(const QString &type,
             //       icon.width() is ever very small (or removed).
             qp.drawText(icon.width() + cursorOffset, icon.height(), labelStr);
 
-            if(boundingBoxes) {
-                labelBB = qfm.boundingRect(labelStr);
-                labelBB.moveTo(icon.width() + cursorOffset,
-                               icon.height() - qfm.height() + pxBelowBase);
-                boundingBoxes->push_back(labelBB);
-            }
+            labelBB = qfm.boundingRect(labelStr);
+            labelBB.moveTo(icon.width() + cursorOffset,
+                           icon.height() - qfm.height() + pxBelowBase);
+            cached.boundingBoxes.push_back(labelBB);
 
             cursorOffset += Gui::QtTools::horizontalAdvance(qfm, labelStr);
         }
     }
 
+    qp.end();
+    cached.image = image;
+    if(boundingBoxes)
+        boundingBoxes->insert(boundingBoxes->end(), cached.boundingBoxes.begin(), cached.boundingBoxes.end());
+
     return image;
 }
 
@@ -3858,6 +3911,20 @@ void ViewProviderSketch::initItemsSizes()
     }
 }
 
+// Sets the values of a multiple-value field unless it already holds them. Every change
+// notifies the scene graph, which then rebuilds the render caches of the node.
+template <typename Field, typename Value>
+static void setFieldValues(Field &field, const std::vector<Value> &values)
+{
+    if (field.getNum() == int(values.size()) &&
+        std::equal(values.begin(), values.end(), field.getValues(0)))
+        return;
+
+    field.setNum(values.size());
+    if (!values.empty())
+        field.setValues(0, values.size(), &values[0]);
+}
+
 void ViewProviderSketch::draw(bool temp /*=false*/, bool rebuildinformationlayer /*=true*/)
 {
     assert(edit);
@@ -4750,15 +4817,14 @@ void ViewProviderSketch::draw(bool temp /*=false*/, bool rebuildinformationlayer
 
     visibleInformationChanged=false; // whatever that changed in Information layer is already updated
 
-    edit->CurvesCoordinate->point.setNum(Coords.size());
-    edit->CurveSet->numVertices.setNum(Index.size());
     edit->CurvesMaterials->diffuseColor.setNum(Index.size());
-    edit->PointsCoordinate->point.setNum(Points.size());
     edit->PointsMaterials->diffuseColor.setNum(Points.size());
 
-    SbVec3f *verts = edit->CurvesCoordinate->point.startEditing();
-    int32_t *index = edit->CurveSet->numVertices.startEditing();
-    SbVec3f *pverts = edit->PointsCoordinate->point.startEditing();
+    // the nodes are only updated if their content changed, redraws after selection,
+    // constraint or datum edits often leave the geometry as it was
+    std::vector<SbVec3f> verts(Coords.size());
+    std::vector<int32_t> index(Index.size());
+    std::vector<SbVec3f> pverts(Points.size());
 
     float dMg = 100;
 
@@ -4780,9 +4846,9 @@ void ViewProviderSketch::draw(bool temp /*=false*/, bool rebuildinformationlayer
         pverts[i].setValue(it->x,it->y,zLowPoints);
     }
 
-    edit->CurvesCoordinate->point.finishEditing();
-    edit->CurveSet->numVertices.finishEditing();
-    edit->PointsCoordinate->point.finishEditing();
+    setFieldValues(edit->CurvesCoordinate->point, verts);
+    setFieldValues(edit->CurveSet->numVertices, index);
+    setFieldValues(edit->PointsCoordinate->point, pverts);
 
     // set cross coordinates
     edit->RootCrossSet->numVertices.set1Value(0,2);
@@ -122,6 +122,40 @@ def CreateSlotPlateInnerSet(SketchFeature):
 	
 
 
+def CreateOpenRectangleSketch(SketchFeature):
+	# a rectangle with free position and size
+	SketchFeature.addGeometry(Part.LineSegment(FreeCAD.Vector(0,20,0),FreeCAD.Vector(30,20,0)))
+	SketchFeature.addGeometry(Part.LineSegment(FreeCAD.Vector(30,20,0),FreeCAD.Vector(30,0,0)))
+	SketchFeature.addGeometry(Part.LineSegment(FreeCAD.Vector(30,0,0),FreeCAD.Vector(0,0,0)))
+	SketchFeature.addGeometry(Part.LineSegment(FreeCAD.Vector(0,0,0),FreeCAD.Vector(0,20,0)))
+	conList = []
+	conList.append(Sketcher.Constraint('Coincident',0,2,1,1))
+	conList.append(Sketcher.Constraint('Coincident',1,2,2,1))
+	conList.append(Sketcher.Constraint('Coincident',2,2,3,1))
+	conList.append(Sketcher.Constraint('Coincident',3,2,0,1))
+	conList.append(Sketcher.Constraint('Horizontal',0))
+	conList.append(Sketcher.Constraint('Horizontal',2))
+	conList.append(Sketcher.Constraint('Vertical',1))
+	conList.append(Sketcher.Constraint('Vertical',3))
+	SketchFeature.addConstraint(conList)
+
+def CompareWithRebuiltSketch(TestCase, Doc, SketchFeature):
+	# a sketch set up from scratch must give the same solver results as the
+	# one that got updated in place
+	Rebuilt = Doc.addObject('Sketcher::SketchObject','Rebuilt')
+	Rebuilt.addGeometry(SketchFeature.Geometry,False)
+	Rebuilt.addConstraint(SketchFeature.Constraints)
+	TestCase.assertEqual(SketchFeature.DoF, Rebuilt.DoF)
+	TestCase.assertEqual(SketchFeature.FullyConstrained, Rebuilt.FullyConstrained)
+	TestCase.assertEqual(sorted(SketchFeature.getGeometryWithDependentParameters()),
+	                     sorted(Rebuilt.getGeometryWithDependentParameters()))
+	for i in range(SketchFeature.GeometryCount):
+		for pos in (1, 2):
+			p1 = SketchFeature.getPoint(i,pos)
+			p2 = Rebuilt.getPoint(i,pos)
+			TestCase.assertAlmostEqual((p1 - p2).Length, 0.0, 6)
+	Doc.removeObject(Rebuilt.Name)
+
 #---------------------------------------------------------------------------
 # define the test cases to test the FreeCAD Sketcher module
 #---------------------------------------------------------------------------
@@ -210,6 +244,43 @@ class SketcherSolverTestCases(unittest.TestCase):
 		self.failUnless(len(values) == 0)
 		FreeCAD.closeDocument("Issue3245")
 	
+	def testAppendConstraint(self):
+		ActiveSketch = self.Doc.addObject('Sketcher::SketchObject','SketchAppend')
+		CreateOpenRectangleSketch(ActiveSketch)
+		self.Doc.recompute()
+		self.assertEqual(ActiveSketch.DoF, 4)
+		self.assertTrue(len(ActiveSketch.SubSystemsStatus) > 0)
+		self.assertEqual(set(ActiveSketch.SubSystemsStatus), {0})
+		CompareWithRebuiltSketch(self, self.Doc, ActiveSketch)
+		# appended constraints are added to the existing solver model
+		ActiveSketch.addConstraint(Sketcher.Constraint('DistanceX',2,2,5.0))
+		ActiveSketch.addConstraint(Sketcher.Constraint('DistanceY',2,2,5.0))
+		self.assertEqual(ActiveSketch.DoF, 2)
+		CompareWithRebuiltSketch(self, self.Doc, ActiveSketch)
+		ActiveSketch.addConstraint(Sketcher.Constraint('DistanceX',0,1,0,2,40.0))
+		self.assertEqual(ActiveSketch.DoF, 1)
+		CompareWithRebuiltSketch(self, self.Doc, ActiveSketch)
+		ActiveSketch.addConstraint(Sketcher.Constraint('DistanceY',3,1,3,2,25.0))
+		self.assertEqual(ActiveSketch.DoF, 0)
+		CompareWithRebuiltSketch(self, self.Doc, ActiveSketch)
+
+	def testChangeDatum(self):
+		ActiveSketch = self.Doc.addObject('Sketcher::SketchObject','SketchDatum')
+		CreateOpenRectangleSketch(ActiveSketch)
+		ActiveSketch.addConstraint(Sketcher.Constraint('DistanceX',2,2,5.0))
+		ActiveSketch.addConstraint(Sketcher.Constraint('DistanceY',2,2,5.0))
+		ActiveSketch.addConstraint(Sketcher.Constraint('DistanceX',0,1,0,2,40.0))
+		self.Doc.recompute()
+		self.assertEqual(ActiveSketch.DoF, 1)
+		# datum values are written into the existing solver model
+		ActiveSketch.setDatum(8,App.Units.Quantity('10.000000 mm'))
+		ActiveSketch.setDatum(10,App.Units.Quantity('60.000000 mm'))
+		self.Doc.recompute()
+		self.assertAlmostEqual(ActiveSketch.getPoint(2,2).x, 10.0, 6)
+		self.assertAlmostEqual(ActiveSketch.getPoint(0,2).x - ActiveSketch.getPoint(0,1).x, 60.0, 6)
+		self.assertEqual(ActiveSketch.DoF, 1)
+		CompareWithRebuiltSketch(self, self.Doc, ActiveSketch)
+
 	def tearDown(self):
 		#closing doc
 		FreeCAD.closeDocument("SketchSolverTest")